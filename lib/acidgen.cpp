@@ -0,0 +1,549 @@
+//-----------------------------------------------------------------------------
+// libacidgen - C API over the Rack-free generator and step engine
+//-----------------------------------------------------------------------------
+// A thin wrapper: each call maps onto what AcidSeq::process() does with the
+// same engine headers, minus Rack ports, MIDI, the recorder, layering and the
+// voice.
+// Nothing here throws across the C boundary; allocation uses nothrow new.
+
+#include "acidgen.h"
+
+#include "../src/Sequencer.hpp"
+#include "../src/Chance.hpp"
+#ifdef ACIDSEQ_FIXED_POINT
+#include "../src/FixedSequencer.hpp"
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <new>
+
+using namespace AcidGenerator;
+
+namespace {
+
+// Same switch as AcidSeq::StepEngine
+#ifdef ACIDSEQ_FIXED_POINT
+using StepEngine = FixedSequencer;
+#else
+using StepEngine = Sequencer;
+#endif
+
+struct Event {
+    acidgen_event_type type;
+    int offset;
+    uint32_t value;
+};
+
+bool validSize(const acidgen_params* p) {
+    return p && p->struct_size >= ACIDGEN_PARAMS_SIZE_V1 && p->struct_size <= sizeof(acidgen_params);
+}
+
+// Knob defaults in the library's own layout
+acidgen_params defaultParams() {
+    SequencerParams sp;
+    acidgen_params p = {};
+    p.struct_size = sizeof(acidgen_params);
+    p.pattern_length = sp.patternLength;
+    p.scale = static_cast<int>(sp.scale);
+    p.root_note = sp.rootNote;
+    p.octave = sp.octaveOffset;
+    p.density = sp.density;
+    p.spread = sp.spread;
+    p.accent = sp.accentDensity;
+    p.slide = sp.slideDensity;
+    p.chance = sp.chanceAmount;
+    return p;
+}
+
+// The caller's struct_size bytes of p, in the library's layout; fields past
+// them keep their defaults
+acidgen_params fromCaller(const acidgen_params* p) {
+    acidgen_params full = defaultParams();
+    std::memcpy(&full, p, p->struct_size);
+    full.struct_size = sizeof(acidgen_params);
+    return full;
+}
+
+// The library's params into the caller's struct_size bytes
+void toCaller(const acidgen_params& full, acidgen_params* p) {
+    size_t size = p->struct_size;
+    std::memcpy(p, &full, size);
+    p->struct_size = size;
+}
+
+bool validParams(const acidgen_params& p) {
+    return !std::isnan(p.density) && !std::isnan(p.spread) && !std::isnan(p.accent) && !std::isnan(p.slide) &&
+           !std::isnan(p.chance);
+}
+
+// Knob ranges as configParam() sets them in AcidSeq
+SequencerParams toSequencerParams(const acidgen_params& p) {
+    SequencerParams sp;
+    sp.patternLength = std::max(1, std::min(MAX_STEPS, p.pattern_length));
+    sp.scale = static_cast<Scale>(std::max(0, std::min(NUM_SCALES - 1, p.scale)));
+    sp.rootNote = std::max(0, std::min(11, p.root_note));
+    sp.octaveOffset = std::max(-2, std::min(2, p.octave));
+    sp.density = std::fmax(0.f, std::fmin(100.f, p.density));
+    sp.spread = std::fmax(0.f, std::fmin(100.f, p.spread));
+    sp.accentDensity = std::fmax(0.f, std::fmin(100.f, p.accent));
+    sp.slideDensity = std::fmax(0.f, std::fmin(100.f, p.slide));
+    sp.chanceAmount = std::fmax(0.f, std::fmin(100.f, p.chance));
+    return sp;
+}
+
+//-----------------------------------------------------------------------------
+// Serialized state: little-endian, fixed layout (see STATE_VERSION)
+//-----------------------------------------------------------------------------
+
+constexpr uint8_t STATE_MAGIC[4] = {'A', 'C', 'G', 'S'};
+// Version 2 added the CHANCE amount, the chance lane and its loop count;
+// version 1 state is still read
+constexpr uint32_t STATE_VERSION = 2;
+
+// Counts bytes always, stores them only when given a buffer
+struct Writer {
+    uint8_t* out;
+    size_t size = 0;
+
+    void u8(uint8_t v) {
+        if (out) {
+            out[size] = v;
+        }
+        size++;
+    }
+
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            u8(static_cast<uint8_t>(v >> (8 * i)));
+        }
+    }
+
+    void i32(int32_t v) {
+        u32(static_cast<uint32_t>(v));
+    }
+
+    void f32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+};
+
+// Reads fail soft: past the end, ok goes false and values read as 0
+struct Reader {
+    const uint8_t* in;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint8_t u8() {
+        if (pos >= size) {
+            ok = false;
+            return 0;
+        }
+        return in[pos++];
+    }
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) {
+            v |= static_cast<uint32_t>(u8()) << (8 * i);
+        }
+        return v;
+    }
+
+    int32_t i32() {
+        return static_cast<int32_t>(u32());
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    // Integer in [lo, hi], else the state is rejected
+    int range(int lo, int hi) {
+        int32_t v = i32();
+        if (v < lo || v > hi) {
+            ok = false;
+        }
+        return v;
+    }
+
+    float finite() {
+        float v = f32();
+        if (!std::isfinite(v)) {
+            ok = false;
+        }
+        return v;
+    }
+};
+
+} // namespace
+
+struct acidgen_engine {
+    MasterPattern pattern;
+    ChanceLane chance;
+    StepEngine seq;
+    acidgen_params knobs;
+    SequencerParams params;
+    float sampleRate = 48000.f;
+    uint32_t seed = 0;
+    Event events[ACIDGEN_MAX_EVENTS];
+    int eventCount = 0;
+
+    void setSampleRate(float sr) {
+        sampleRate = sr;
+        seq.setSampleRate(sr);
+    }
+
+    void generate(uint32_t s) {
+        seed = s;
+        generateMaster(seed, pattern);
+        generateChance(seed, chance);
+        pattern.clearMutes();
+    }
+
+    // Both passes of acidgen_serialize, and nothing else, define the layout
+    void write(Writer& w) const {
+        for (uint8_t c : STATE_MAGIC) {
+            w.u8(c);
+        }
+        w.u32(STATE_VERSION);
+        w.u32(seed);
+        w.i32(seq.currentStep);
+
+        w.i32(knobs.pattern_length);
+        w.i32(knobs.scale);
+        w.i32(knobs.root_note);
+        w.i32(knobs.octave);
+        w.f32(knobs.density);
+        w.f32(knobs.spread);
+        w.f32(knobs.accent);
+        w.f32(knobs.slide);
+        w.f32(knobs.chance);
+
+        for (int i = 0; i < BAR_LEN; i++) {
+            w.i32(pattern.barActivationOrder[i]);
+        }
+        for (int i = 0; i < SCALE_SIZE; i++) {
+            w.i32(pattern.scalePriorityOrder[i]);
+        }
+        for (int i = 0; i < MAX_STEPS; i++) {
+            const MasterStep& ms = pattern.steps[i];
+            w.i32(ms.notePoolIndex);
+            w.i32(ms.octave);
+            w.f32(ms.accentProb);
+            w.f32(ms.slideProb);
+        }
+        for (int i = 0; i < MAX_STEPS; i++) {
+            w.u8(pattern.muted[i] ? 1 : 0);
+        }
+
+        SlideState slide = seq.slideState();
+        w.u8(slide.active ? 1 : 0);
+        w.f32(slide.pitch);
+        w.f32(slide.target);
+        w.f32(slide.rate);
+
+        for (int i = 0; i < MAX_STEPS; i++) {
+            w.u8(chance.percent[i]);
+        }
+        w.u32(seq.loop);
+    }
+
+    // Everything is validated before anything is applied
+    bool read(Reader& r) {
+        for (uint8_t c : STATE_MAGIC) {
+            if (r.u8() != c) {
+                return false;
+            }
+        }
+        uint32_t version = r.u32();
+        if (version < 1 || version > STATE_VERSION) {
+            return false;
+        }
+        uint32_t newSeed = r.u32();
+        int step = r.range(-1, MAX_STEPS - 1);
+
+        acidgen_params k = defaultParams();
+        k.pattern_length = r.range(1, MAX_STEPS);
+        k.scale = r.range(0, NUM_SCALES - 1);
+        k.root_note = r.range(0, 11);
+        k.octave = r.range(-2, 2);
+        k.density = r.finite();
+        k.spread = r.finite();
+        k.accent = r.finite();
+        k.slide = r.finite();
+        if (version >= 2) {
+            k.chance = r.finite();
+        }
+
+        MasterPattern p;
+        for (int i = 0; i < BAR_LEN; i++) {
+            p.barActivationOrder[i] = r.range(0, BAR_LEN - 1);
+        }
+        for (int i = 0; i < SCALE_SIZE; i++) {
+            p.scalePriorityOrder[i] = r.range(0, SCALE_SIZE - 1);
+        }
+        for (int i = 0; i < MAX_STEPS; i++) {
+            MasterStep& ms = p.steps[i];
+            ms.notePoolIndex = r.range(0, SCALE_SIZE - 1);
+            ms.octave = r.range(-1, 1);
+            ms.accentProb = r.finite();
+            ms.slideProb = r.finite();
+        }
+        for (int i = 0; i < MAX_STEPS; i++) {
+            uint8_t m = r.u8();
+            r.ok = r.ok && m <= 1;
+            p.muted[i] = m != 0;
+        }
+
+        SlideState slide;
+        uint8_t active = r.u8();
+        r.ok = r.ok && active <= 1;
+        slide.active = active != 0;
+        slide.pitch = r.finite();
+        slide.target = r.finite();
+        slide.rate = r.finite();
+
+        ChanceLane lane;
+        generateChance(newSeed, lane);
+        uint32_t loop = 0;
+        if (version >= 2) {
+            for (int i = 0; i < MAX_STEPS; i++) {
+                uint8_t c = r.u8();
+                r.ok = r.ok && c >= 1 && c <= 100;
+                lane.percent[i] = c;
+            }
+            loop = r.u32();
+        }
+
+        if (!r.ok || r.pos != r.size) {
+            return false;
+        }
+        seed = newSeed;
+        knobs = k;
+        params = toSequencerParams(k);
+        pattern = p;
+        chance = lane;
+        seq.reset();
+        seq.currentStep = step;
+        seq.loop = loop;
+        seq.setSlideState(slide);
+        eventCount = 0;
+        return true;
+    }
+};
+
+extern "C" {
+
+int acidgen_api_version(void) {
+    return ACIDGEN_API_VERSION;
+}
+
+int acidgen_num_scales(void) {
+    return NUM_SCALES;
+}
+
+const char* acidgen_scale_name(int scale) {
+    if (scale < 0 || scale >= NUM_SCALES) {
+        return nullptr;
+    }
+    return getScaleName(static_cast<Scale>(scale));
+}
+
+int acidgen_default_params(acidgen_params* params) {
+    if (!validSize(params)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    toCaller(defaultParams(), params);
+    return ACIDGEN_OK;
+}
+
+acidgen_engine* acidgen_create(float sample_rate, uint32_t seed) {
+    if (!(sample_rate > 0.f)) {
+        return nullptr;
+    }
+    acidgen_engine* engine = new (std::nothrow) acidgen_engine;
+    if (!engine) {
+        return nullptr;
+    }
+    engine->knobs = defaultParams();
+    engine->params = toSequencerParams(engine->knobs);
+    engine->setSampleRate(sample_rate);
+    engine->generate(seed);
+    return engine;
+}
+
+void acidgen_destroy(acidgen_engine* engine) {
+    delete engine;
+}
+
+int acidgen_set_sample_rate(acidgen_engine* engine, float sample_rate) {
+    if (!engine || !(sample_rate > 0.f)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    engine->setSampleRate(sample_rate);
+    return ACIDGEN_OK;
+}
+
+int acidgen_set_params(acidgen_engine* engine, const acidgen_params* params) {
+    if (!engine || !validSize(params)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    acidgen_params p = fromCaller(params);
+    if (!validParams(p)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    engine->params = toSequencerParams(p);
+    const SequencerParams& sp = engine->params;
+    engine->knobs = {sizeof(acidgen_params), sp.patternLength, static_cast<int>(sp.scale), sp.rootNote,
+                     sp.octaveOffset, sp.density, sp.spread, sp.accentDensity, sp.slideDensity, sp.chanceAmount};
+    return ACIDGEN_OK;
+}
+
+int acidgen_get_params(const acidgen_engine* engine, acidgen_params* params) {
+    if (!engine || !validSize(params)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    toCaller(engine->knobs, params);
+    return ACIDGEN_OK;
+}
+
+int acidgen_push_event(acidgen_engine* engine, acidgen_event_type type, int offset, uint32_t value) {
+    if (!engine || offset < 0 || type < ACIDGEN_EVENT_CLOCK || type > ACIDGEN_EVENT_GENERATE) {
+        return ACIDGEN_ERR_ARG;
+    }
+    if (engine->eventCount >= ACIDGEN_MAX_EVENTS) {
+        return ACIDGEN_ERR_FULL;
+    }
+    // Keep the queue ordered by frame, then by push order
+    int i = engine->eventCount++;
+    for (; i > 0 && engine->events[i - 1].offset > offset; i--) {
+        engine->events[i] = engine->events[i - 1];
+    }
+    engine->events[i] = {type, offset, value};
+    return ACIDGEN_OK;
+}
+
+int acidgen_process(acidgen_engine* engine, float* out, int frames) {
+    if (!engine || frames < 0 || (frames > 0 && !out)) {
+        return ACIDGEN_ERR_ARG;
+    }
+    const float sampleTime = 1.f / engine->sampleRate;
+    const SequencerParams& sp = engine->params;
+    int next = 0;
+
+    for (int f = 0; f < frames; f++) {
+        // This frame's events, in the order AcidSeq::process() handles its inputs
+        bool generate = false, reset = false, clock = false;
+        uint32_t seed = 0;
+        for (; next < engine->eventCount && engine->events[next].offset == f; next++) {
+            const Event& ev = engine->events[next];
+            switch (ev.type) {
+                case ACIDGEN_EVENT_CLOCK: clock = true; break;
+                case ACIDGEN_EVENT_RESET: reset = true; break;
+                case ACIDGEN_EVENT_GENERATE: generate = true; seed = ev.value; break;
+            }
+        }
+        if (generate) {
+            engine->generate(seed);
+        }
+        if (reset) {
+            engine->seq.reset();
+        }
+        if (clock) {
+            engine->seq.advance(sp.patternLength);
+            engine->seq.playStep(engine->pattern, sp, engine->sampleRate, &engine->chance);
+        }
+
+        SequencerOutputs o = engine->seq.process(sampleTime, engine->pattern, sp);
+        float* frame = out + f * ACIDGEN_OUTPUTS;
+        frame[ACIDGEN_OUT_PITCH] = o.pitch;
+        frame[ACIDGEN_OUT_GATE] = o.gate ? 10.f : 0.f;
+        frame[ACIDGEN_OUT_ACCENT] = o.accent ? 10.f : 0.f;
+        frame[ACIDGEN_OUT_SLIDE] = o.slide ? 10.f : 0.f;
+        frame[ACIDGEN_OUT_ACCENT_CV] = o.accentSweep * 10.f;
+    }
+
+    // Later events move into the next block
+    int kept = 0;
+    for (int i = next; i < engine->eventCount; i++) {
+        engine->events[kept] = engine->events[i];
+        engine->events[kept].offset -= frames;
+        kept++;
+    }
+    engine->eventCount = kept;
+    return ACIDGEN_OK;
+}
+
+int acidgen_generate(acidgen_engine* engine, uint32_t seed) {
+    if (!engine) {
+        return ACIDGEN_ERR_ARG;
+    }
+    engine->generate(seed);
+    return ACIDGEN_OK;
+}
+
+uint32_t acidgen_seed(const acidgen_engine* engine) {
+    return engine ? engine->seed : 0;
+}
+
+int acidgen_current_step(const acidgen_engine* engine) {
+    return engine ? engine->seq.currentStep : -1;
+}
+
+int acidgen_resolve_step(const acidgen_engine* engine, int step, acidgen_step* out) {
+    if (!engine || !out || step < 0 || step >= MAX_STEPS) {
+        return ACIDGEN_ERR_ARG;
+    }
+    const SequencerParams& sp = engine->params;
+    SequenceStep s = engine->pattern.getStep(step, sp.density, sp.spread, sp.accentDensity, sp.slideDensity);
+    *out = {};
+    out->rest = s.isRest() ? 1 : 0;
+    if (!s.isRest()) {
+        out->degree = s.note;
+        out->octave = s.octave;
+        out->accent = s.accent ? 1 : 0;
+        out->slide = s.slide ? 1 : 0;
+        // Same conversion as Sequencer::playStep()
+        out->midi_note = getNoteInScale(s.note, sp.scale, sp.rootNote, s.octave + sp.octaveOffset);
+        out->pitch = out->midi_note / 12.0f;
+    }
+    return ACIDGEN_OK;
+}
+
+int acidgen_set_mute(acidgen_engine* engine, int step, int muted) {
+    if (!engine || step < 0 || step >= MAX_STEPS) {
+        return ACIDGEN_ERR_ARG;
+    }
+    engine->pattern.muted[step] = muted != 0;
+    return ACIDGEN_OK;
+}
+
+size_t acidgen_serialize(const acidgen_engine* engine, void* buffer, size_t size) {
+    if (!engine) {
+        return 0;
+    }
+    Writer count{nullptr};
+    engine->write(count);
+    if (buffer && size >= count.size) {
+        Writer w{static_cast<uint8_t*>(buffer)};
+        engine->write(w);
+    }
+    return count.size;
+}
+
+int acidgen_deserialize(acidgen_engine* engine, const void* buffer, size_t size) {
+    if (!engine || !buffer) {
+        return ACIDGEN_ERR_ARG;
+    }
+    Reader r{static_cast<const uint8_t*>(buffer), size};
+    return engine->read(r) ? ACIDGEN_OK : ACIDGEN_ERR_FORMAT;
+}
+
+} // extern "C"
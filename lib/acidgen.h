@@ -0,0 +1,159 @@
+/*-----------------------------------------------------------------------------
+ * libacidgen - C API for the Acid Generator Mini generator and step engine
+ *-----------------------------------------------------------------------------
+ * The same MasterPattern generator and per-sample step engine the module runs
+ * (src/Generator.hpp, src/Sequencer.hpp, or src/FixedSequencer.hpp when built
+ * with FIXED=1), without Rack or jansson. Build with `make -C lib` and link
+ * lib/build/libacidgen.a plus the C++ runtime (-lstdc++ -lm).
+ *
+ *   acidgen_engine* e = acidgen_create(48000.f, 42);
+ *   acidgen_params p;
+ *   p.struct_size = sizeof(p);
+ *   acidgen_default_params(&p);
+ *   p.density = 80.f;
+ *   acidgen_set_params(e, &p);
+ *   acidgen_push_event(e, ACIDGEN_EVENT_CLOCK, 0, 0);   // edge on frame 0
+ *   acidgen_process(e, out, 256);                       // 256 x 5 floats
+ *   acidgen_destroy(e);
+ *
+ * Outputs are interleaved per frame in ACIDGEN_OUT_* order, in the module's
+ * voltages: PITCH 1V/oct (0V = C4), GATE/ACCENT/SLIDE 0 or 10V, ACC CV 0-10V.
+ *
+ * Events are queued against frame offsets in the next acidgen_process()
+ * block. Events at the same frame apply as the module applies its inputs:
+ * generate, then reset, then clock. Events past the end of a block carry over
+ * to the next one. An engine is not thread-safe; use one per thread.
+ *---------------------------------------------------------------------------*/
+
+#ifndef ACIDGEN_H
+#define ACIDGEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACIDGEN_API_VERSION 1
+
+/* Status codes (0 or negative) */
+#define ACIDGEN_OK 0
+#define ACIDGEN_ERR_ARG -1     /* NULL engine/buffer or value out of range */
+#define ACIDGEN_ERR_FULL -2    /* Event queue full; process a block first */
+#define ACIDGEN_ERR_FORMAT -3  /* Serialized state is truncated, corrupt or another version */
+
+#define ACIDGEN_MAX_STEPS 64
+#define ACIDGEN_MAX_EVENTS 256
+
+/* Output channels, interleaved per frame */
+enum {
+    ACIDGEN_OUT_PITCH,
+    ACIDGEN_OUT_GATE,
+    ACIDGEN_OUT_ACCENT,
+    ACIDGEN_OUT_SLIDE,
+    ACIDGEN_OUT_ACCENT_CV,
+    ACIDGEN_OUTPUTS
+};
+
+typedef enum {
+    ACIDGEN_EVENT_CLOCK,     /* Advance one step (CLK rising edge) */
+    ACIDGEN_EVENT_RESET,     /* Next clock plays step 0 (RST) */
+    ACIDGEN_EVENT_GENERATE   /* New master pattern from the event's seed (GEN) */
+} acidgen_event_type;
+
+/* Knob values, in the module's parameter units. Values are clamped to the
+ * knob ranges; NaN is rejected.
+ *
+ * Set struct_size to sizeof(acidgen_params) before passing the struct to any
+ * call. Later versions only add fields at the end, and the library reads and
+ * writes just the first struct_size bytes, so code built against an older
+ * header keeps working: fields it doesn't know get their defaults. Calls
+ * refuse a struct_size below ACIDGEN_PARAMS_SIZE_V1 or above the library's
+ * own sizeof(acidgen_params) with ACIDGEN_ERR_ARG. */
+typedef struct {
+    size_t struct_size;  /* sizeof(acidgen_params) as the caller compiled it */
+    int pattern_length;  /* 1-64 */
+    int scale;           /* 0 to acidgen_num_scales() - 1 */
+    int root_note;       /* 0-11 (C-B) */
+    int octave;          /* -2 to 2 */
+    float density;       /* 0-100 */
+    float spread;        /* 0-100 */
+    float accent;        /* 0-100 */
+    float slide;         /* 0-100 */
+    float chance;        /* 0-100, CHANCE amount: how far the chance lane applies */
+} acidgen_params;
+
+/* struct_size of the first version of acidgen_params, the smallest accepted */
+#define ACIDGEN_PARAMS_SIZE_V1 (offsetof(acidgen_params, slide) + sizeof(float))
+
+/* One resolved step, as the engine would play it with the current params */
+typedef struct {
+    int rest;        /* 1 when the step is a rest (nothing else is meaningful) */
+    int degree;      /* Scale degree */
+    int octave;      /* Pattern octave (-1 to 1), before the octave offset */
+    int accent;
+    int slide;
+    int midi_note;   /* Semitones from C4 (0 = C4 = MIDI note 60) */
+    float pitch;     /* PITCH output in volts */
+} acidgen_step;
+
+typedef struct acidgen_engine acidgen_engine;
+
+int acidgen_api_version(void);
+int acidgen_num_scales(void);
+const char* acidgen_scale_name(int scale);  /* NULL when out of range */
+
+/* The module's knob defaults, for the struct_size the caller set */
+int acidgen_default_params(acidgen_params* params);
+
+/* Engine at default params with the pattern for seed. NULL if the sample
+ * rate is not positive or allocation fails. */
+acidgen_engine* acidgen_create(float sample_rate, uint32_t seed);
+void acidgen_destroy(acidgen_engine* engine);
+
+int acidgen_set_sample_rate(acidgen_engine* engine, float sample_rate);
+int acidgen_set_params(acidgen_engine* engine, const acidgen_params* params);
+int acidgen_get_params(const acidgen_engine* engine, acidgen_params* params);
+
+/* Queue an event at frame offset (>= 0) into the next block. value is the
+ * seed for ACIDGEN_EVENT_GENERATE and ignored otherwise. */
+int acidgen_push_event(acidgen_engine* engine, acidgen_event_type type, int offset, uint32_t value);
+
+/* Run frames samples, writing frames * ACIDGEN_OUTPUTS floats to out */
+int acidgen_process(acidgen_engine* engine, float* out, int frames);
+
+/* Replace the pattern now, as a GEN would (mutes cleared, playback position
+ * kept) */
+int acidgen_generate(acidgen_engine* engine, uint32_t seed);
+uint32_t acidgen_seed(const acidgen_engine* engine);
+
+/* Step index being played, -1 before the first clock or after a reset */
+int acidgen_current_step(const acidgen_engine* engine);
+
+/* Resolve step (0-63) of the pattern with the engine's current params. The
+ * chance roll is not applied: a step resolved here may still drop when it
+ * plays with CHANCE above 0. */
+int acidgen_resolve_step(const acidgen_engine* engine, int step, acidgen_step* out);
+
+/* Mute (force a rest on) one step, as the pattern display does */
+int acidgen_set_mute(acidgen_engine* engine, int step, int muted);
+
+/* Save and restore the state the module keeps in a patch: seed, params,
+ * master pattern with mutes, chance lane and the loop its rolls are on,
+ * playback position and slide state. As with a patch, gate/accent pulses
+ * and the ACC CV sweep in flight are not saved,
+ * and the clock period is measured again from the next clocks. The format is
+ * little-endian and versioned, so it moves between machines.
+ * acidgen_serialize returns the bytes needed and writes only if size is
+ * large enough (pass NULL, 0 to query). Restoring drops queued events.
+ * State from version 1 of the format, which had no chance lane, restores with
+ * the seed's lane, loop 0 and CHANCE at 0. */
+size_t acidgen_serialize(const acidgen_engine* engine, void* buffer, size_t size);
+int acidgen_deserialize(acidgen_engine* engine, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACIDGEN_H */
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// AccentSweep - TB-303 accent sweep capacitor
+//-----------------------------------------------------------------------------
+// On the 303, accented notes charge a capacitor through the accent circuit and
+// the cap bleeds off between notes. Because it rarely discharges fully at
+// 16th-note tempos, runs of consecutive accents stack up into the familiar
+// rising "wow". Modelled as a one-pole RC:
+//
+//   charging (accent gate high):  v(t) = 1 - (1 - v0) * exp(-t / CHARGE_TIME)
+//   discharging:                  v(t) = v0 * exp(-t / DECAY_TIME)
+//
+// Both curves are evaluated in closed form with the per-sample exp() terms
+// precomputed in setSampleRate(), so each process() call is one multiply-add.
+
+struct AccentSweep {
+    static constexpr float CHARGE_TIME = 0.03f;  // RC charge time constant (s)
+    static constexpr float DECAY_TIME = 0.2f;    // RC discharge time constant (s)
+
+    float value = 0.f;        // Capacitor charge, 0-1
+    float chargeCoef = 0.f;   // exp(-1 / (CHARGE_TIME * sampleRate))
+    float decayCoef = 0.f;    // exp(-1 / (DECAY_TIME * sampleRate))
+
+    AccentSweep() {
+        setSampleRate(44100.f);
+    }
+
+    void setSampleRate(float sampleRate) {
+        chargeCoef = std::exp(-1.f / (CHARGE_TIME * sampleRate));
+        decayCoef = std::exp(-1.f / (DECAY_TIME * sampleRate));
+    }
+
+    void reset() {
+        value = 0.f;
+    }
+
+    // Advance one sample. Returns the charge (0-1).
+    float process(bool charging) {
+        if (charging) {
+            value = 1.f - (1.f - value) * chargeCoef;
+        } else {
+            value *= decayCoef;
+        }
+        return value;
+    }
+};
+
+} // namespace AcidGenerator
@@ -1,5 +1,18 @@
 #include "plugin.hpp"
 #include "Generator.hpp"
+#include "Sequencer.hpp"
+#include "FixedSequencer.hpp"
+#include "Voice.hpp"
+#include "MidiClock.hpp"
+#include "Trace.hpp"
+#include "ClockStats.hpp"
+#include "Capture.hpp"
+#include "Footprint.hpp"
+#include "MacroMap.hpp"
+#include "Layer.hpp"
+#include "Chance.hpp"
+#include <memory>
+#include <type_traits>
 #include <ctime>
 
 using namespace AcidGenerator;
@@ -17,6 +30,15 @@ struct AcidSeq : Module {
         PARAM_OCTAVE,
         PARAM_OCTAVE_UP,
         PARAM_OCTAVE_DOWN,
+        PARAM_VOICE_CUTOFF,
+        PARAM_VOICE_RESONANCE,
+        PARAM_VOICE_ENV_MOD,
+        PARAM_VOICE_DECAY,
+        PARAM_VOICE_ACCENT,
+        PARAM_VOICE_WAVEFORM,
+        PARAM_LAYER_OP,
+        PARAM_LAYER_PITCH,
+        PARAM_CHANCE,
         PARAMS_LEN
     };
 
@@ -24,6 +46,11 @@ struct AcidSeq : Module {
         INPUT_CLOCK,
         INPUT_RESET,
         INPUT_GENERATE,
+        INPUT_REC_PITCH,
+        INPUT_REC_GATE,
+        INPUT_REC_ACCENT,
+        INPUT_REC_SLIDE,
+        INPUT_LAYER_OP,
         INPUTS_LEN
     };
 
@@ -32,6 +59,8 @@ struct AcidSeq : Module {
         OUTPUT_GATE,
         OUTPUT_ACCENT,
         OUTPUT_SLIDE,
+        OUTPUT_ACCENT_CV,
+        OUTPUT_AUDIO,
         OUTPUTS_LEN
     };
 
@@ -50,13 +79,39 @@ struct AcidSeq : Module {
     dsp::SchmittTrigger octaveUpTrigger;
     dsp::SchmittTrigger octaveDownTrigger;
 
-    // Gate pulse generator (for timed gate output)
-    dsp::PulseGenerator gatePulse;
-    dsp::PulseGenerator accentPulse;
+    // Step engine: clock, slide, gate/accent pulses and accent sweep
+#ifdef ACIDSEQ_FIXED_POINT
+    using StepEngine = FixedSequencer;
+#else
+    using StepEngine = Sequencer;
+#endif
+    StepEngine seq;
+
+    // Integrated 303-style voice (ladder stages packed in one SIMD vector)
+    AcidVoice<simd::float_4> voice;
 
     // Master pattern data (density/spread applied in real-time)
     MasterPattern masterPattern;
 
+    // Layer B, whose rhythm combines with masterPattern's (see Layer.hpp).
+    // GEN replaces it with the one for the new seed unless held.
+    MasterPattern layerPattern;
+    bool layerHold = false;
+
+    // What the engine plays while layering, rebuilt only when an input to
+    // the mix changes (resolveLayers)
+    MasterPattern mixPattern;
+    float mixDensity = 0.f;
+    bool mixStale = true;  // A or B replaced since the last mix
+    bool mixActive = false;
+    LayerOp mixOp = LayerOp::A_ONLY;
+    bool mixPitchFromB = false;
+    int mixLevel = -1;
+
+    // Per-step chance to play, from the seed (see Chance.hpp). The CHANCE
+    // amount fades it in; at 0 every step plays.
+    ChanceLane chanceLane;
+
     // Cached pattern for display (recomputed when params change or edits occur)
     Pattern displayPattern;
     float cachedDensity = -1.f;
@@ -65,21 +120,52 @@ struct AcidSeq : Module {
     float cachedSlideDensity = -1.f;
     bool forceDisplayRefresh = false;  // Set by UI edits to trigger refresh
 
-    int currentStep = -1;  // -1 means not started yet
-
-    // Slide state
-    bool currentSlideActive = false;  // Is current step sliding INTO next?
-    float slideTargetPitch = 0.f;
-    float currentPitch = 0.f;
-    float slideRate = 0.f;
-
-    // Clock period measurement (for tempo-aware slide gates)
-    float timeSinceLastClock = 0.f;
-    float measuredClockPeriod = 0.125f;  // Default ~120 BPM 16ths
-
-    // Retrigger gap (forces gate low briefly when retriggering mid-slide)
-    float retriggerGapRemaining = 0.f;
-    static constexpr float RETRIGGER_GAP_TIME = 0.001f;  // 1ms gap
+    // DENSITY x SPREAD map (pattern display mode): the master (with layer B
+    // while layering) is posted to a worker when it, the layering, the length
+    // or ACC/SLD change, and only while shown
+    bool showMacroMap = false;
+    MacroMapWorker macroMap;
+    bool macroMapStale = true;  // A or B replaced since the last post
+    LayerOp macroMapOp = LayerOp::A_ONLY;
+    bool macroMapPitchFromB = false;
+    int macroMapLength = -1;
+    float macroMapAccent = -1.f;
+    float macroMapSlide = -1.f;
+
+    // Live recorder: captures the REC inputs into a shadow pattern that replaces
+    // masterPattern when the loop wraps, so playback is untouched until commit
+    bool recordEnabled = false;       // Armed from the context menu
+    bool recordActive = false;        // Capturing the current loop pass
+    MasterPattern recordPattern;      // Shadow pattern being written
+    int recordCaptureStep = -1;       // Step awaiting capture, -1 if none
+    float recordCaptureRemaining = 0.f;
+    // Inputs are sampled shortly after the clock so an upstream sequencer on the
+    // same clock has had time to update (Rack cables add a sample of delay)
+    static constexpr float RECORD_CAPTURE_DELAY = 0.001f;  // 1ms
+
+    // MIDI output: notes follow the gate, accent sets velocity, slides overlap
+    midi::Output midiOutput;
+    int midiActiveNote = -1;          // Sounding MIDI note, -1 if none
+    bool midiClockEnabled = false;    // Send 24 PPQN clock + start/stop
+    bool midiClockRunning = false;    // Start sent, Stop not yet
+    int midiClockTicksPending = 0;    // Ticks left in the current step
+    float midiClockTimer = 0.f;       // Time until the next pending tick
+    static constexpr int MIDI_TICKS_PER_STEP = 6;  // 24 PPQN / 4 steps per beat
+    static constexpr int MIDI_VELOCITY = 100;
+    static constexpr int MIDI_ACCENT_VELOCITY = 127;
+
+    // MIDI clock input: replaces CLK when selected
+    midi::InputQueue midiInput;
+    bool clockFromMidi = false;
+    MidiClockFollower midiClockFollower;
+
+    // Clock interval/jitter and edge-to-gate latency histograms (context menu)
+    ClockStats clockStats;
+
+#ifdef ACIDSEQ_TRACE
+    // Section timings and event counts (trace builds only, see Trace.hpp)
+    TraceStats traceStats;
+#endif
 
     // Light fade
     float generateLightBrightness = 0.f;
@@ -87,6 +173,50 @@ struct AcidSeq : Module {
     // Seed for random generation
     uint32_t currentSeed = 12345;
 
+    // The first pattern is generated lazily: a module restored from a patch
+    // gets its pattern from dataFromJson, so generating in the constructor
+    // would be wasted work on the main thread for every instance loaded.
+    // Whichever comes first - process(), the display's first draw or a save -
+    // claims the generation; the others see GENERATING and wait it out.
+    enum PatternInit { PATTERN_PENDING, PATTERN_GENERATING, PATTERN_READY };
+    std::atomic<int> patternInit{PATTERN_PENDING};
+
+    // Input capture (see Capture.hpp). The UI owns the session; the audio
+    // thread sees it through activeCapture until it has written END.
+    std::unique_ptr<CaptureSession> capture;
+    std::atomic<CaptureSession*> activeCapture{nullptr};
+    uint32_t capturedInputs[INPUTS_LEN] = {};   // Last recorded values, as bits
+    bool capturedConnected[INPUTS_LEN] = {};
+    uint32_t capturedParams[PARAMS_LEN] = {};
+    uint32_t capturedSampleRate = 0;
+    uint32_t capturedFlags = 0;
+    int64_t replaySeed = -1;  // Seed for the next GEN, set by the replayer
+    static constexpr int CAPTURE_OUTPUTS = 5;  // PITCH, GATE, ACCENT, SLIDE, ACC CV
+    static constexpr uint32_t FLAG_RECORD = 1;
+    static constexpr uint32_t FLAG_CLOCK_FROM_MIDI = 2;
+    static constexpr uint32_t FLAG_LAYER_HOLD = 4;
+
+    // Everything the sequencing path carries between samples, snapshotted when
+    // a capture starts. Voice, MIDI output and display state are left out:
+    // none of it reaches the captured outputs.
+    struct ReplayState {
+        MasterPattern masterPattern;
+        MasterPattern recordPattern;
+        MasterPattern layerPattern;
+        ChanceLane chanceLane;
+        StepEngine seq;
+        MidiClockFollower midiClockFollower;
+        dsp::SchmittTrigger triggers[6];  // clock, reset, generate, GEN button, octave up, octave down
+        uint32_t currentSeed;
+        bool recordEnabled;
+        bool recordActive;
+        int recordCaptureStep;
+        float recordCaptureRemaining;
+        bool clockFromMidi;
+        bool layerHold;
+    };
+    static_assert(std::is_trivially_copyable<ReplayState>::value, "capture state is written as raw bytes");
+
     // Cached values for display access (updated each process cycle)
     int cachedPatternLength = 16;
     Scale cachedScale = Scale::MINOR;
@@ -105,7 +235,7 @@ struct AcidSeq : Module {
         configParam(PARAM_SLIDE_DENSITY, 0.f, 100.f, 15.f, "Slide Density", "%");
 
         // Scale selection
-        configParam(PARAM_SCALE, 0.f, (float)(Scale::NUM_SCALES) - 1.f, 0.f, "Scale");
+        configParam(PARAM_SCALE, 0.f, (float)NUM_SCALES - 1.f, 0.f, "Scale");
         paramQuantities[PARAM_SCALE]->snapEnabled = true;
 
         // Root note (0-11 = C to B)
@@ -123,42 +253,325 @@ struct AcidSeq : Module {
         // Generate button
         configButton(PARAM_GENERATE, "Generate Pattern");
 
+        // Integrated voice (no panel knobs - edited from the context menu)
+        configParam(PARAM_VOICE_CUTOFF, 0.f, 100.f, 40.f, "Voice Cutoff", "%");
+        configParam(PARAM_VOICE_RESONANCE, 0.f, 100.f, 50.f, "Voice Resonance", "%");
+        configParam(PARAM_VOICE_ENV_MOD, 0.f, 100.f, 50.f, "Voice Env Mod", "%");
+        configParam(PARAM_VOICE_DECAY, 0.f, 100.f, 30.f, "Voice Decay", "%");
+        configParam(PARAM_VOICE_ACCENT, 0.f, 100.f, 50.f, "Voice Accent", "%");
+        configSwitch(PARAM_VOICE_WAVEFORM, 0.f, 1.f, 0.f, "Voice Waveform", {"Saw", "Square"});
+
+        // Layering (context menu; the LAYER input steps through the ops)
+        configSwitch(PARAM_LAYER_OP, 0.f, NUM_LAYER_OPS - 1.f, 0.f, "Layer Rhythm",
+                     {"A only", "A AND B", "A OR B", "A XOR B", "A minus B"});
+        configSwitch(PARAM_LAYER_PITCH, 0.f, 1.f, 0.f, "Layer Pitch", {"A", "B"});
+
+        // Chance lane amount (context menu)
+        configParam(PARAM_CHANCE, 0.f, 100.f, 0.f, "Chance", "%");
+
         // Inputs
         configInput(INPUT_CLOCK, "Clock");
         configInput(INPUT_RESET, "Reset");
         configInput(INPUT_GENERATE, "Generate Trigger");
+        configInput(INPUT_REC_PITCH, "Record Pitch (1V/oct)");
+        configInput(INPUT_REC_GATE, "Record Gate");
+        configInput(INPUT_REC_ACCENT, "Record Accent");
+        configInput(INPUT_REC_SLIDE, "Record Slide");
+        configInput(INPUT_LAYER_OP, "Layer rhythm CV (1V per op, added to the menu choice)");
 
         // Outputs
         configOutput(OUTPUT_PITCH, "Pitch (1V/oct)");
         configOutput(OUTPUT_GATE, "Gate");
         configOutput(OUTPUT_ACCENT, "Accent");
         configOutput(OUTPUT_SLIDE, "Slide");
+        configOutput(OUTPUT_ACCENT_CV, "Accent sweep CV");
+        configOutput(OUTPUT_AUDIO, "Voice audio");
 
-        // Generate initial pattern
-        generateNewPattern();
+        // Initial pattern: generated on first use unless a patch supplies one
+    }
+
+    // True once masterPattern holds a pattern (generating it if nobody has)
+    bool ensureInitialPattern() {
+        int state = patternInit.load(std::memory_order_acquire);
+        if (state == PATTERN_READY) {
+            return true;
+        }
+        if (state == PATTERN_PENDING && patternInit.compare_exchange_strong(state, PATTERN_GENERATING)) {
+            generateNewPattern();
+            updateDisplayPattern();
+            patternInit.store(PATTERN_READY, std::memory_order_release);
+            return true;
+        }
+        return patternInit.load(std::memory_order_acquire) == PATTERN_READY;
     }
 
     void generateNewPattern() {
-        // Create new seed from system time
-        currentSeed = static_cast<uint32_t>(std::time(nullptr)) ^
-                      static_cast<uint32_t>(currentSeed * 1664525 + 1013904223);
+        // Create new seed from system time (a replay supplies the captured one)
+        if (replaySeed >= 0) {
+            currentSeed = static_cast<uint32_t>(replaySeed);
+            replaySeed = -1;
+        } else {
+            currentSeed = static_cast<uint32_t>(std::time(nullptr)) ^
+                          static_cast<uint32_t>(currentSeed * 1664525 + 1013904223);
+        }
 
         // Generate master pattern (density/spread will be applied in real-time)
         generateMaster(currentSeed, masterPattern);
+        if (!layerHold) {
+            generateMaster(layerSeedFor(currentSeed), layerPattern);
+        }
+        mixStale = true;
+        generateChance(currentSeed, chanceLane);
 
         // Clear any user mutes from previous pattern
         masterPattern.clearMutes();
 
+        // A recording pass in progress belongs to the old pattern
+        recordActive = false;
+        recordCaptureStep = -1;
+
         // Force display pattern update
         cachedDensity = -1.f;
+        macroMapStale = true;
 
         // Visual feedback
         generateLightBrightness = 1.f;
     }
 
-    // Update the display pattern from master pattern + current params
+#ifdef ACIDSEQ_TRACE
+    // Append the stats report to a text file (UI thread)
+    bool dumpTraceStats(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "a");
+        if (!f) {
+            return false;
+        }
+        std::time_t now = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        std::fprintf(f, "Acid Generator Mini %lld, %s, seed %u\n%s\n", static_cast<long long>(id), stamp,
+                     currentSeed, traceStats.report().c_str());
+        std::fclose(f);
+        return true;
+    }
+#endif
+
+    //-------------------------------------------------------------------------
+    // Input capture and replay
+    //-------------------------------------------------------------------------
+
+    void saveReplayState(uint8_t* out) const {
+        ReplayState st;
+        st.masterPattern = masterPattern;
+        st.recordPattern = recordPattern;
+        st.layerPattern = layerPattern;
+        st.chanceLane = chanceLane;
+        st.seq = seq;
+        st.midiClockFollower = midiClockFollower;
+        st.triggers[0] = clockTrigger;
+        st.triggers[1] = resetTrigger;
+        st.triggers[2] = generateTrigger;
+        st.triggers[3] = generateButtonTrigger;
+        st.triggers[4] = octaveUpTrigger;
+        st.triggers[5] = octaveDownTrigger;
+        st.currentSeed = currentSeed;
+        st.recordEnabled = recordEnabled;
+        st.recordActive = recordActive;
+        st.recordCaptureStep = recordCaptureStep;
+        st.recordCaptureRemaining = recordCaptureRemaining;
+        st.clockFromMidi = clockFromMidi;
+        st.layerHold = layerHold;
+        std::memcpy(out, &st, sizeof(st));
+    }
+
+    void loadReplayState(const uint8_t* in) {
+        ReplayState st;
+        std::memcpy(&st, in, sizeof(st));
+        masterPattern = st.masterPattern;
+        recordPattern = st.recordPattern;
+        layerPattern = st.layerPattern;
+        chanceLane = st.chanceLane;
+        seq = st.seq;
+        midiClockFollower = st.midiClockFollower;
+        clockTrigger = st.triggers[0];
+        resetTrigger = st.triggers[1];
+        generateTrigger = st.triggers[2];
+        generateButtonTrigger = st.triggers[3];
+        octaveUpTrigger = st.triggers[4];
+        octaveDownTrigger = st.triggers[5];
+        currentSeed = st.currentSeed;
+        recordEnabled = st.recordEnabled;
+        recordActive = st.recordActive;
+        recordCaptureStep = st.recordCaptureStep;
+        recordCaptureRemaining = st.recordCaptureRemaining;
+        clockFromMidi = st.clockFromMidi;
+        layerHold = st.layerHold;
+        cachedDensity = -1.f;
+        macroMapStale = true;
+        mixStale = true;
+        patternInit.store(PATTERN_READY, std::memory_order_release);
+    }
+
+    // UI thread. Fails if a capture is still running or the file can't be opened.
+    bool startCapture(const std::string& path) {
+        if (activeCapture.load(std::memory_order_acquire)) {
+            return false;
+        }
+        // The audio thread has let go of any previous session
+        capture.reset(new CaptureSession(path, sizeof(ReplayState)));
+        if (!capture->ok()) {
+            capture.reset();
+            return false;
+        }
+        activeCapture.store(capture.get(), std::memory_order_release);
+        return true;
+    }
+
+    // UI thread. The audio thread writes END on its next process() call.
+    void stopCapture() {
+        CaptureSession* session = activeCapture.load(std::memory_order_acquire);
+        if (session) {
+            session->stopRequested.store(true, std::memory_order_release);
+        }
+    }
+
+    bool capturing() const {
+        return activeCapture.load(std::memory_order_acquire) != nullptr;
+    }
+
+    // UI thread: bytes this instance holds (the "Memory" submenu, acidseq-bench --memory)
+    Footprint footprint() const {
+        Footprint f;
+        f.object = sizeof(AcidSeq);
+        f.add("Patterns (A, B, mix, record, display)", 4 * sizeof(MasterPattern) + sizeof(Pattern), false);
+        f.add("Step engine", sizeof(StepEngine), false);
+        f.add("Voice", sizeof(voice), false);
+        f.add("Clock stats", sizeof(ClockStats), false);
+        f.add("DENSITY x SPREAD map", sizeof(MacroMapWorker), false);
+#ifdef ACIDSEQ_TRACE
+        f.add("Trace stats", sizeof(TraceStats), false);
+#endif
+        // sizeof(v[0]) is unevaluated, so empty vectors are fine
+        size_t ports = params.capacity() * sizeof(params[0]) + inputs.capacity() * sizeof(inputs[0]) +
+                       outputs.capacity() * sizeof(outputs[0]) + lights.capacity() * sizeof(lights[0]);
+        for (const ParamQuantity* pq : paramQuantities) {
+            ports += sizeof(pq) + (pq ? sizeof(*pq) : 0);
+        }
+        for (const auto* info : inputInfos) {
+            ports += sizeof(info) + (info ? sizeof(*info) : 0);
+        }
+        for (const auto* info : outputInfos) {
+            ports += sizeof(info) + (info ? sizeof(*info) : 0);
+        }
+        f.add("Ports, params, lights", ports, true);
+        if (capture) {
+            f.add("Capture ring and state", sizeof(CaptureSession) + capture->ring.capacity() * sizeof(CaptureRecord) +
+                                                capture->state.capacity(), true);
+        }
+        return f;
+    }
+
+    // Audio thread, before anything else in process(): record what changed
+    // since the last frame (everything on the first)
+    void captureInputs(CaptureSession& session, float sampleRate) {
+        bool first = !session.started.load(std::memory_order_relaxed);
+        if (first) {
+            saveReplayState(session.state.data());
+        }
+        for (int i = 0; i < INPUTS_LEN; i++) {
+            uint32_t v = floatBits(inputs[i].getVoltage());
+            if (first || v != capturedInputs[i]) {
+                session.push(CAPTURE_INPUT, static_cast<uint8_t>(i), v);
+                capturedInputs[i] = v;
+            }
+            bool connected = inputs[i].isConnected();
+            if (first || connected != capturedConnected[i]) {
+                session.push(CAPTURE_CONNECTED, static_cast<uint8_t>(i), connected);
+                capturedConnected[i] = connected;
+            }
+        }
+        for (int i = 0; i < PARAMS_LEN; i++) {
+            uint32_t v = floatBits(params[i].getValue());
+            if (first || v != capturedParams[i]) {
+                session.push(CAPTURE_PARAM, static_cast<uint8_t>(i), v);
+                capturedParams[i] = v;
+            }
+        }
+        uint32_t rate = floatBits(sampleRate);
+        if (first || rate != capturedSampleRate) {
+            session.push(CAPTURE_SAMPLE_RATE, 0, rate);
+            capturedSampleRate = rate;
+        }
+        uint32_t flags = (recordEnabled ? FLAG_RECORD : 0) | (clockFromMidi ? FLAG_CLOCK_FROM_MIDI : 0) |
+                         (layerHold ? FLAG_LAYER_HOLD : 0);
+        if (first || flags != capturedFlags) {
+            session.push(CAPTURE_FLAGS, 0, flags);
+            capturedFlags = flags;
+        }
+        if (first) {
+            session.started.store(true, std::memory_order_release);
+        }
+    }
+
+    // Replayer: apply a CAPTURE_FLAGS record
+    void applyCaptureFlags(uint32_t flags) {
+        recordEnabled = flags & FLAG_RECORD;
+        clockFromMidi = flags & FLAG_CLOCK_FROM_MIDI;
+        layerHold = flags & FLAG_LAYER_HOLD;
+    }
+
+    // The outputs a capture hashes, in the order it hashes them
+    void captureOutputs(float* out) const {
+        out[0] = outputs[OUTPUT_PITCH].getVoltage();
+        out[1] = outputs[OUTPUT_GATE].getVoltage();
+        out[2] = outputs[OUTPUT_ACCENT].getVoltage();
+        out[3] = outputs[OUTPUT_SLIDE].getVoltage();
+        out[4] = outputs[OUTPUT_ACCENT_CV].getVoltage();
+    }
+
+    void onSampleRateChange(const SampleRateChangeEvent& e) override {
+        // Precompute the accent sweep RC and voice envelope coefficients for the new rate
+        seq.setSampleRate(e.sampleRate);
+        voice.setSampleRate(e.sampleRate);
+    }
+
+    // The pattern to play and the DENSITY to play it at (written to density):
+    // the primary at the knob, or the two layers mixed. The mix is rebuilt
+    // only when a layer, the op, the pitch layer or the DENSITY level changed.
+    const MasterPattern& resolveLayers(float& density) {
+        density = params[PARAM_DENSITY].getValue();
+        int op = static_cast<int>(params[PARAM_LAYER_OP].getValue());
+        if (inputs[INPUT_LAYER_OP].isConnected()) {
+            op += static_cast<int>(std::round(inputs[INPUT_LAYER_OP].getVoltage()));
+        }
+        LayerOp layerOp = static_cast<LayerOp>(clamp(op, 0, NUM_LAYER_OPS - 1));
+        bool pitchFromB = params[PARAM_LAYER_PITCH].getValue() > 0.5f;
+
+        bool active = layerOp != LayerOp::A_ONLY || pitchFromB;
+        if (active != mixActive) {
+            mixActive = active;
+            forceDisplayRefresh = true;
+        }
+        if (!active) {
+            return masterPattern;
+        }
+
+        int level = densityLevel(density);
+        if (mixStale || layerOp != mixOp || pitchFromB != mixPitchFromB || level != mixLevel) {
+            mixDensity = mixLayers(masterPattern, layerPattern, layerOp, pitchFromB, level, mixPattern);
+            mixStale = false;
+            mixOp = layerOp;
+            mixPitchFromB = pitchFromB;
+            mixLevel = level;
+            forceDisplayRefresh = true;
+        }
+        density = mixDensity;
+        return mixPattern;
+    }
+
+    // Update the display pattern from the played pattern + current params
     void updateDisplayPattern() {
-        float density = params[PARAM_DENSITY].getValue();
+        float density;
+        const MasterPattern& pattern = resolveLayers(density);
         float spread = params[PARAM_SPREAD].getValue();
         float accentDensity = params[PARAM_ACCENT_DENSITY].getValue();
         float slideDensity = params[PARAM_SLIDE_DENSITY].getValue();
@@ -170,6 +583,7 @@ struct AcidSeq : Module {
             return;
         }
 
+        ACID_TRACE_SCOPE(traceStats, TRACE_DISPLAY);
         forceDisplayRefresh = false;
         cachedDensity = density;
         cachedSpread = spread;
@@ -178,21 +592,174 @@ struct AcidSeq : Module {
 
         // Recompute display pattern
         for (int i = 0; i < MAX_STEPS; i++) {
-            displayPattern.steps[i] = masterPattern.getStep(i, density, spread, accentDensity, slideDensity);
+            displayPattern.steps[i] = pattern.getStep(i, density, spread, accentDensity, slideDensity);
+        }
+    }
+
+    // Hand the master, and layer B with the op while layering, to the map
+    // worker if the map is out of date. A busy slot leaves it stale, so the
+    // next frame tries again. Follows the layering resolveLayers() last saw.
+    void postMacroMap(const SequencerParams& sp) {
+        if (!showMacroMap) {
+            return;
+        }
+        LayerOp op = mixActive ? mixOp : LayerOp::A_ONLY;
+        bool pitchFromB = mixActive && mixPitchFromB;
+        if (!macroMapStale && op == macroMapOp && pitchFromB == macroMapPitchFromB &&
+            sp.patternLength == macroMapLength && sp.accentDensity == macroMapAccent &&
+            sp.slideDensity == macroMapSlide) {
+            return;
+        }
+        if (macroMap.post(masterPattern, layerPattern, op, pitchFromB, sp.patternLength, sp.accentDensity,
+                          sp.slideDensity)) {
+            macroMapStale = false;
+            macroMapOp = op;
+            macroMapPitchFromB = pitchFromB;
+            macroMapLength = sp.patternLength;
+            macroMapAccent = sp.accentDensity;
+            macroMapSlide = sp.slideDensity;
+        }
+    }
+
+    // Return to the top of the pattern: next clock plays step 0
+    void resetSequence(int64_t frame) {
+        ACID_TRACE_EVENT(traceStats, TRACE_RESET);
+        seq.reset();
+        // Drop a partial recording pass; capture restarts at step 0
+        recordActive = false;
+        recordCaptureStep = -1;
+        // MIDI: the next clock restarts receivers from the top
+        stopMidiNote(frame);
+        if (midiClockRunning) {
+            sendMidiRealtime(0xc, frame);
+            midiClockRunning = false;
+            midiClockTicksPending = 0;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // MIDI output helpers
+    //-------------------------------------------------------------------------
+    // Every message carries the engine frame it was generated on, so the driver
+    // can place it sample-accurately instead of at the block boundary.
+
+    void sendMidiNote(uint8_t status, int note, int velocity, int64_t frame) {
+        midi::Message msg;
+        msg.setStatus(status);
+        msg.setChannel(0);  // Overridden by the port's channel setting
+        msg.setNote(static_cast<uint8_t>(note));
+        msg.setValue(static_cast<uint8_t>(velocity));
+        msg.setFrame(frame);
+        midiOutput.sendMessage(msg);
+    }
+
+    void sendMidiRealtime(uint8_t type, int64_t frame) {
+        midi::Message msg;
+        msg.setSize(1);
+        msg.setStatus(0xf);
+        msg.setChannel(type);  // 0x8 clock, 0xa start, 0xc stop
+        msg.setFrame(frame);
+        midiOutput.sendMessage(msg);
+    }
+
+    void stopMidiNote(int64_t frame) {
+        if (midiActiveNote >= 0) {
+            sendMidiNote(0x8, midiActiveNote, 0, frame);
+            midiActiveNote = -1;
+        }
+    }
+
+    // Legato notes send the new note-on before the old note-off so the
+    // receiver glides; a legato repeat of the held note just keeps it
+    void startMidiNote(int note, bool accent, bool legato, int64_t frame) {
+        note = clamp(note, 0, 127);
+        int velocity = accent ? MIDI_ACCENT_VELOCITY : MIDI_VELOCITY;
+
+        if (legato && midiActiveNote >= 0) {
+            if (note != midiActiveNote) {
+                int previousNote = midiActiveNote;
+                sendMidiNote(0x9, note, velocity, frame);
+                sendMidiNote(0x8, previousNote, 0, frame);
+                midiActiveNote = note;
+            }
+            return;
+        }
+
+        stopMidiNote(frame);
+        sendMidiNote(0x9, note, velocity, frame);
+        midiActiveNote = note;
+    }
+
+    // Write the REC inputs into the shadow pattern for the pending step.
+    // Each lane is only recorded when its jack is patched; an unpatched GATE
+    // counts as high so pitch-only recording works.
+    void captureRecordedStep(Scale scale, int rootNote, int octaveOffset) {
+        int step = recordCaptureStep;
+        recordCaptureStep = -1;
+        if (!recordActive || step < 0 || step >= MAX_STEPS) {
+            return;
+        }
+
+        bool gateHigh = !inputs[INPUT_REC_GATE].isConnected() ||
+                        inputs[INPUT_REC_GATE].getVoltage() >= 1.f;
+        recordPattern.muted[step] = !gateHigh;
+        if (!gateHigh) {
+            return;
+        }
+
+        MasterStep& ms = recordPattern.steps[step];
+        if (inputs[INPUT_REC_PITCH].isConnected()) {
+            voltageToPoolStep(inputs[INPUT_REC_PITCH].getVoltage(), recordPattern, scale, rootNote,
+                              octaveOffset, ms.notePoolIndex, ms.octave);
+        }
+        // Probabilities of 0 / 1 make the flag follow the ACC/SLD knobs as on/off
+        if (inputs[INPUT_REC_ACCENT].isConnected()) {
+            ms.accentProb = inputs[INPUT_REC_ACCENT].getVoltage() >= 1.f ? 0.f : 1.f;
+        }
+        if (inputs[INPUT_REC_SLIDE].isConnected()) {
+            ms.slideProb = inputs[INPUT_REC_SLIDE].getVoltage() >= 1.f ? 0.f : 1.f;
         }
     }
 
     void process(const ProcessArgs& args) override {
-        int patternLength = static_cast<int>(params[PARAM_PATTERN_LENGTH].getValue());
-        Scale scale = static_cast<Scale>(static_cast<int>(params[PARAM_SCALE].getValue()));
-        int rootNote = static_cast<int>(params[PARAM_ROOT_NOTE].getValue());
-        int octaveOffset = static_cast<int>(params[PARAM_OCTAVE].getValue());
+        // First sample of a new instance (the UI may be generating it right
+        // now, for at most one generateMaster; outputs hold until it's done)
+        if (!ensureInitialPattern()) {
+            return;
+        }
+
+        ACID_TRACE_POLL(traceStats);
+        ACID_TRACE_SCOPE(traceStats, TRACE_PROCESS);
+        clockStats.poll();
+
+        // --- Input capture: END once stopped, otherwise this frame's inputs ---
+        CaptureSession* session = activeCapture.load(std::memory_order_acquire);
+        if (session && session->stopRequested.load(std::memory_order_acquire)) {
+            session->finish();
+            activeCapture.store(nullptr, std::memory_order_release);
+            session = nullptr;
+        }
+        if (session) {
+            captureInputs(*session, args.sampleRate);
+        }
+
+        SequencerParams sp;
+        sp.patternLength = static_cast<int>(params[PARAM_PATTERN_LENGTH].getValue());
+        sp.scale = static_cast<Scale>(static_cast<int>(params[PARAM_SCALE].getValue()));
+        sp.rootNote = static_cast<int>(params[PARAM_ROOT_NOTE].getValue());
+        sp.octaveOffset = static_cast<int>(params[PARAM_OCTAVE].getValue());
 
         // Real-time params for density/spread (applied every clock)
-        float density = params[PARAM_DENSITY].getValue();
-        float spread = params[PARAM_SPREAD].getValue();
-        float accentDensity = params[PARAM_ACCENT_DENSITY].getValue();
-        float slideDensity = params[PARAM_SLIDE_DENSITY].getValue();
+        sp.density = params[PARAM_DENSITY].getValue();
+        sp.spread = params[PARAM_SPREAD].getValue();
+        sp.accentDensity = params[PARAM_ACCENT_DENSITY].getValue();
+        sp.slideDensity = params[PARAM_SLIDE_DENSITY].getValue();
+        sp.chanceAmount = params[PARAM_CHANCE].getValue();
+
+        int patternLength = sp.patternLength;
+        Scale scale = sp.scale;
+        int rootNote = sp.rootNote;
+        int octaveOffset = sp.octaveOffset;
 
         // Update cached values for display widget access
         cachedPatternLength = patternLength;
@@ -201,6 +768,7 @@ struct AcidSeq : Module {
 
         // Update display pattern (checks internally if params changed)
         updateDisplayPattern();
+        postMacroMap(sp);
 
         // --- Handle Generate Trigger ---
         bool generateTriggered = false;
@@ -213,9 +781,16 @@ struct AcidSeq : Module {
         }
 
         if (generateTriggered) {
+            ACID_TRACE_EVENT(traceStats, TRACE_GENERATE);
             generateNewPattern();
+            if (session) {
+                session->push(CAPTURE_SEED, 0, currentSeed);
+            }
         }
 
+        // --- Layers: the pattern the engine plays and its DENSITY ---
+        const MasterPattern* playing = &resolveLayers(sp.density);
+
         // --- Handle Octave Buttons ---
         if (octaveUpTrigger.process(params[PARAM_OCTAVE_UP].getValue() > 0.f)) {
             float currentOctave = params[PARAM_OCTAVE].getValue();
@@ -232,126 +807,181 @@ struct AcidSeq : Module {
 
         // --- Handle Reset Trigger ---
         if (resetTrigger.process(inputs[INPUT_RESET].getVoltage())) {
-            currentStep = -1;  // Will become 0 on next clock
-            currentSlideActive = false;
-            retriggerGapRemaining = 0.f;
+            resetSequence(args.frame);
         }
 
-        // --- Accumulate time for clock period measurement ---
-        timeSinceLastClock += args.sampleTime;
+        // --- MIDI Clock Input ---
+        // Messages are popped up to the current frame, so each one lands on
+        // the sample the driver stamped it with. The queue is drained even
+        // when CLK is the clock source so it can't back up.
+        bool midiClockStep = false;
+        midi::Message midiMsg;
+        while (midiInput.tryPop(&midiMsg, args.frame)) {
+            if (!clockFromMidi || midiMsg.getStatus() != 0xf) {
+                continue;
+            }
+            switch (midiMsg.getChannel()) {
+                case 0x8: midiClockStep |= midiClockFollower.tick(); break;
+                case 0xa: midiClockFollower.start(); resetSequence(args.frame); break;
+                case 0xb: midiClockFollower.resume(); break;
+                case 0xc: midiClockFollower.stop(); break;
+            }
+        }
+        if (clockFromMidi && midiClockFollower.process(args.sampleTime)) {
+            midiClockStep = true;
+        }
+
+        if (!recordEnabled) {
+            recordActive = false;
+        }
 
         // --- Handle Clock ---
-        bool clockRising = clockTrigger.process(inputs[INPUT_CLOCK].getVoltage());
+        bool clockRising = clockFromMidi ? midiClockStep : clockTrigger.process(inputs[INPUT_CLOCK].getVoltage());
 
         if (clockRising) {
-            // Measure clock period (with sanity bounds)
-            if (timeSinceLastClock > 0.01f && timeSinceLastClock < 2.0f) {
-                measuredClockPeriod = timeSinceLastClock;
+            ACID_TRACE_SCOPE(traceStats, TRACE_CLOCK_EDGE);
+            ACID_TRACE_EVENT(traceStats, TRACE_CLOCK);
+#ifdef ACIDSEQ_TRACE
+            if (!clockFromMidi && (seq.timeSinceClock() <= StepEngine::MIN_CLOCK_PERIOD ||
+                                   seq.timeSinceClock() >= StepEngine::MAX_CLOCK_PERIOD)) {
+                traceStats.count(TRACE_CLOCK_DROPPED);
             }
-            timeSinceLastClock = 0.f;
-            // Advance step
-            currentStep++;
-            if (currentStep >= patternLength) {
-                currentStep = 0;
+#endif
+            clockStats.onClock(args.frame, seq.clockPeriod(), args.sampleRate);
+
+            // Measure the clock period and advance; MIDI uses the PLL estimate
+            seq.advance(patternLength, clockFromMidi ? midiClockFollower.stepPeriod() : 0.f);
+            int currentStep = seq.currentStep;
+
+            // MIDI clock: finish the previous step's ticks, then start this step's
+            if (midiClockEnabled) {
+                for (; midiClockTicksPending > 0; midiClockTicksPending--) {
+                    sendMidiRealtime(0x8, args.frame);
+                }
+                if (!midiClockRunning) {
+                    sendMidiRealtime(0xa, args.frame);
+                    midiClockRunning = true;
+                }
+                sendMidiRealtime(0x8, args.frame);
+                midiClockTicksPending = MIDI_TICKS_PER_STEP - 1;
+                midiClockTimer = seq.clockPeriod() / MIDI_TICKS_PER_STEP;
             }
 
-            // Get current step data with real-time density/spread applied
-            SequenceStep step = masterPattern.getStep(currentStep, density, spread, accentDensity, slideDensity);
+            // Flush a capture still pending from a very fast clock
+            if (recordCaptureStep >= 0) {
+                captureRecordedStep(scale, rootNote, octaveOffset);
+            }
 
-            if (!step.isRest()) {
-                // Calculate pitch voltage
-                // getNoteInScale returns semitone offset from root
-                // VCV standard: 0V = C4, 1V/octave
-                int midiNote = getNoteInScale(step.note, scale, rootNote, step.octave + octaveOffset);
-                float pitchVoltage = (midiNote) / 12.0f;  // 1V/oct, 0V = C0
-
-                // Check if previous step had slide active (slide INTO this note)
-                int prevStep = (currentStep - 1 + patternLength) % patternLength;
-                SequenceStep prevStepData = masterPattern.getStep(prevStep, density, spread, accentDensity, slideDensity);
-                bool slideFromPrev = !prevStepData.isRest() && prevStepData.slide;
-
-                if (slideFromPrev) {
-                    // Sliding into this note - set up portamento, no retrigger
-                    slideTargetPitch = pitchVoltage;
-                    // Slide over ~50ms (typical 303 glide time)
-                    slideRate = (slideTargetPitch - currentPitch) / (0.05f * args.sampleRate);
-
-                    // If this step also has slide, extend gate to tie into next step
-                    if (step.slide) {
-                        gatePulse.trigger(measuredClockPeriod * 1.1f);
-                    }
-                    // Otherwise let the previous gate naturally decay
-                } else {
-                    // Normal attack - set pitch immediately and retrigger gate
-                    currentPitch = pitchVoltage;
-                    slideTargetPitch = pitchVoltage;
-                    slideRate = 0.f;
-
-                    // If gate is currently high, force a brief gap for retrigger
-                    if (gatePulse.remaining > 0.f) {
-                        retriggerGapRemaining = RETRIGGER_GAP_TIME;
-                    }
-
-                    // Gate time: slides extend to next step, normal notes are short
-                    float gateTime = step.slide ? (measuredClockPeriod * 1.1f) : 0.02f;
-                    gatePulse.trigger(gateTime);
-
-                    // Trigger accent pulse if accented
-                    if (step.accent) {
-                        accentPulse.trigger(gateTime);
-                    }
+            // --- Live recorder: commit at loop end, then start a new pass ---
+            if (currentStep == 0 && recordEnabled) {
+                if (recordActive) {
+                    ACID_TRACE_EVENT(traceStats, TRACE_RECORD_COMMIT);
+                    masterPattern = recordPattern;
+                    forceDisplayRefresh = true;
+                    macroMapStale = true;
+                    mixStale = true;
+                    playing = &resolveLayers(sp.density);
                 }
+                recordPattern = masterPattern;
+                recordActive = true;
+            }
+            if (recordActive) {
+                recordCaptureStep = currentStep;
+                recordCaptureRemaining = RECORD_CAPTURE_DELAY;
+            }
 
-                // Store slide state for next step
-                currentSlideActive = step.slide;
+            // Play the step with real-time density/spread applied
+            StepEvent ev = seq.playStep(*playing, sp, args.sampleRate, &chanceLane);
 
-            } else {
-                // Rest - no gate, reset slide
-                currentSlideActive = false;
+            if (ev.note && !ev.legato) {
+                clockStats.onNoteStart(args.frame);
+            }
+
+            // MIDI note (0V = C4 = note 60)
+            if (ev.note) {
+                startMidiNote(ev.midiNote + 60, ev.accent, ev.legato, args.frame);
+            }
+        }
+
+        // --- Step engine: slide, gate/accent pulses, accent sweep ---
+        SequencerOutputs seqOut;
+        {
+            ACID_TRACE_SCOPE(traceStats, TRACE_ENGINE);
+            seqOut = seq.process(args.sampleTime, *playing, sp);
+        }
+        clockStats.onGate(args.frame, seqOut.gate);
+
+        // --- MIDI clock ticks between steps, spaced over the measured period ---
+        if (midiClockTicksPending > 0) {
+            midiClockTimer -= args.sampleTime;
+            if (midiClockTimer <= 0.f) {
+                sendMidiRealtime(0x8, args.frame);
+                midiClockTicksPending--;
+                midiClockTimer += seq.clockPeriod() / MIDI_TICKS_PER_STEP;
             }
         }
+        // Clock stopped (same 2s bound as period measurement): send Stop
+        if (midiClockRunning && (!midiClockEnabled || seq.timeSinceClock() >= 2.f)) {
+            sendMidiRealtime(0xc, args.frame);
+            midiClockRunning = false;
+            midiClockTicksPending = 0;
+        }
 
-        // --- Process slide (portamento) ---
-        if (slideRate != 0.f) {
-            currentPitch += slideRate;
-            // Check if we've reached target
-            if ((slideRate > 0.f && currentPitch >= slideTargetPitch) ||
-                (slideRate < 0.f && currentPitch <= slideTargetPitch)) {
-                currentPitch = slideTargetPitch;
-                slideRate = 0.f;
+        // --- Live recorder capture (delayed sample of the REC inputs) ---
+        if (recordCaptureStep >= 0) {
+            recordCaptureRemaining -= args.sampleTime;
+            if (recordCaptureRemaining <= 0.f) {
+                captureRecordedStep(scale, rootNote, octaveOffset);
             }
         }
 
         // --- Set Outputs ---
-        outputs[OUTPUT_PITCH].setVoltage(currentPitch);
+        {
+            ACID_TRACE_SCOPE(traceStats, TRACE_OUTPUTS);
+            outputs[OUTPUT_PITCH].setVoltage(seqOut.pitch);
 
-        // Gate output (high while pulse is active, but forced low during retrigger gap)
-        bool gateHigh = gatePulse.process(args.sampleTime);
-        if (retriggerGapRemaining > 0.f) {
-            retriggerGapRemaining -= args.sampleTime;
-            outputs[OUTPUT_GATE].setVoltage(0.f);  // Force low for retrigger
-        } else {
-            outputs[OUTPUT_GATE].setVoltage(gateHigh ? 10.f : 0.f);
+            // MIDI note ends with the gate pulse (the retrigger gap is handled as note-off/on)
+            if (!seqOut.gatePulse) {
+                stopMidiNote(args.frame);
+            }
+
+            outputs[OUTPUT_GATE].setVoltage(seqOut.gate ? 10.f : 0.f);
+            outputs[OUTPUT_ACCENT].setVoltage(seqOut.accent ? 10.f : 0.f);
+            outputs[OUTPUT_ACCENT_CV].setVoltage(seqOut.accentSweep * 10.f);
+            outputs[OUTPUT_SLIDE].setVoltage(seqOut.slide ? 10.f : 0.f);
         }
 
-        // Accent output
-        bool accentHigh = accentPulse.process(args.sampleTime);
-        outputs[OUTPUT_ACCENT].setVoltage(accentHigh ? 10.f : 0.f);
+        // --- Integrated voice (only rendered while AUDIO is patched) ---
+        if (outputs[OUTPUT_AUDIO].isConnected()) {
+            ACID_TRACE_SCOPE(traceStats, TRACE_VOICE);
+            VoiceParams voiceParams;
+            voiceParams.cutoff = params[PARAM_VOICE_CUTOFF].getValue() / 100.f;
+            voiceParams.resonance = params[PARAM_VOICE_RESONANCE].getValue() / 100.f;
+            voiceParams.envMod = params[PARAM_VOICE_ENV_MOD].getValue() / 100.f;
+            voiceParams.decay = params[PARAM_VOICE_DECAY].getValue() / 100.f;
+            voiceParams.accent = params[PARAM_VOICE_ACCENT].getValue() / 100.f;
+            voiceParams.square = params[PARAM_VOICE_WAVEFORM].getValue() > 0.5f;
+
+            // Same pitch a VCO patched to V/OCT would see (0V = C4)
+            outputs[OUTPUT_AUDIO].setVoltage(
+                voice.process(seqOut.pitch, seqOut.gate, seqOut.accent, seqOut.accentSweep, voiceParams));
+        }
 
-        // Slide output (indicates current step has slide, useful for external portamento)
-        if (currentStep >= 0 && currentStep < patternLength) {
-            SequenceStep currentStepData = masterPattern.getStep(currentStep, density, spread, accentDensity, slideDensity);
-            outputs[OUTPUT_SLIDE].setVoltage(currentStepData.slide ? 10.f : 0.f);
+        if (session) {
+            float captured[CAPTURE_OUTPUTS];
+            captureOutputs(captured);
+            session->endFrame(captured, CAPTURE_OUTPUTS);
         }
 
         // --- Update Lights ---
+        ACID_TRACE_SCOPE(traceStats, TRACE_LIGHTS);
         // Generate light fades out
         generateLightBrightness *= 1.f - args.sampleTime * 4.f;
         lights[LIGHT_GENERATE].setBrightness(generateLightBrightness);
 
         // Step lights (show current position in first 16 steps)
         for (int i = 0; i < 16; i++) {
-            bool isCurrentStep = (currentStep == i);
+            bool isCurrentStep = (seq.currentStep == i);
             bool hasNote = (i < patternLength) && !displayPattern.steps[i].isRest();
 
             if (isCurrentStep) {
@@ -381,34 +1011,26 @@ struct AcidSeq : Module {
     //   - seed: The RNG seed used to generate master pattern
     //   - currentStep: Playback position
     //   - masterPattern: Full master pattern backup (barActivationOrder, scalePriorityOrder, steps)
+    //   - layerPattern, layerHold: Layer B in the same form, and whether GEN keeps it
+    //   - chance, chanceLoop: Chance lane percents and the loop the rolls are on
     //-------------------------------------------------------------------------
 
     static constexpr int JSON_VERSION = 3;
 
-    json_t* dataToJson() override {
-        json_t* rootJ = json_object();
-
-        // Version for future compatibility
-        json_object_set_new(rootJ, "version", json_integer(JSON_VERSION));
-
-        // Core state
-        json_object_set_new(rootJ, "seed", json_integer(currentSeed));
-        json_object_set_new(rootJ, "currentStep", json_integer(currentStep));
-
-        // Save master pattern
+    static json_t* masterToJson(const MasterPattern& pattern) {
         json_t* masterJ = json_object();
 
         // Bar activation order
         json_t* barOrderJ = json_array();
         for (int i = 0; i < BAR_LEN; i++) {
-            json_array_append_new(barOrderJ, json_integer(masterPattern.barActivationOrder[i]));
+            json_array_append_new(barOrderJ, json_integer(pattern.barActivationOrder[i]));
         }
         json_object_set_new(masterJ, "barActivationOrder", barOrderJ);
 
         // Scale priority order
         json_t* scaleOrderJ = json_array();
         for (int i = 0; i < SCALE_SIZE; i++) {
-            json_array_append_new(scaleOrderJ, json_integer(masterPattern.scalePriorityOrder[i]));
+            json_array_append_new(scaleOrderJ, json_integer(pattern.scalePriorityOrder[i]));
         }
         json_object_set_new(masterJ, "scalePriorityOrder", scaleOrderJ);
 
@@ -416,22 +1038,99 @@ struct AcidSeq : Module {
         json_t* stepsJ = json_array();
         for (int i = 0; i < MAX_STEPS; i++) {
             json_t* stepJ = json_object();
-            json_object_set_new(stepJ, "p", json_integer(masterPattern.steps[i].notePoolIndex));
-            json_object_set_new(stepJ, "o", json_integer(masterPattern.steps[i].octave));
-            json_object_set_new(stepJ, "a", json_real(masterPattern.steps[i].accentProb));
-            json_object_set_new(stepJ, "s", json_real(masterPattern.steps[i].slideProb));
-            json_object_set_new(stepJ, "m", json_boolean(masterPattern.muted[i]));
+            json_object_set_new(stepJ, "p", json_integer(pattern.steps[i].notePoolIndex));
+            json_object_set_new(stepJ, "o", json_integer(pattern.steps[i].octave));
+            json_object_set_new(stepJ, "a", json_real(pattern.steps[i].accentProb));
+            json_object_set_new(stepJ, "s", json_real(pattern.steps[i].slideProb));
+            json_object_set_new(stepJ, "m", json_boolean(pattern.muted[i]));
             json_array_append_new(stepsJ, stepJ);
         }
         json_object_set_new(masterJ, "steps", stepsJ);
 
-        json_object_set_new(rootJ, "masterPattern", masterJ);
+        return masterJ;
+    }
+
+    static void masterFromJson(json_t* patternJ, MasterPattern& pattern) {
+        // Load bar activation order
+        json_t* barOrderJ = json_object_get(patternJ, "barActivationOrder");
+        if (barOrderJ) {
+            for (int i = 0; i < BAR_LEN && i < (int)json_array_size(barOrderJ); i++) {
+                pattern.barActivationOrder[i] = json_integer_value(json_array_get(barOrderJ, i));
+            }
+        }
+
+        // Load scale priority order
+        json_t* scaleOrderJ = json_object_get(patternJ, "scalePriorityOrder");
+        if (scaleOrderJ) {
+            for (int i = 0; i < SCALE_SIZE && i < (int)json_array_size(scaleOrderJ); i++) {
+                pattern.scalePriorityOrder[i] = json_integer_value(json_array_get(scaleOrderJ, i));
+            }
+        }
+
+        // Load steps
+        json_t* stepsJ = json_object_get(patternJ, "steps");
+        if (stepsJ) {
+            for (int i = 0; i < MAX_STEPS && i < (int)json_array_size(stepsJ); i++) {
+                json_t* stepDataJ = json_array_get(stepsJ, i);
+                if (stepDataJ) {
+                    json_t* pJ = json_object_get(stepDataJ, "p");
+                    json_t* oJ = json_object_get(stepDataJ, "o");
+                    json_t* aJ = json_object_get(stepDataJ, "a");
+                    json_t* sJ = json_object_get(stepDataJ, "s");
+                    json_t* mJ = json_object_get(stepDataJ, "m");
+
+                    if (pJ) pattern.steps[i].notePoolIndex = json_integer_value(pJ);
+                    if (oJ) pattern.steps[i].octave = json_integer_value(oJ);
+                    if (aJ) pattern.steps[i].accentProb = json_real_value(aJ);
+                    if (sJ) pattern.steps[i].slideProb = json_real_value(sJ);
+                    if (mJ) pattern.muted[i] = json_boolean_value(mJ);
+                }
+            }
+        }
+    }
+
+    json_t* dataToJson() override {
+        // Saved before the first process(): store a real pattern, not the default
+        ensureInitialPattern();
+        json_t* rootJ = json_object();
+
+        // Version for future compatibility
+        json_object_set_new(rootJ, "version", json_integer(JSON_VERSION));
+
+        // Core state
+        json_object_set_new(rootJ, "seed", json_integer(currentSeed));
+        json_object_set_new(rootJ, "currentStep", json_integer(seq.currentStep));
+
+        // Save master pattern and layer
+        json_object_set_new(rootJ, "masterPattern", masterToJson(masterPattern));
+        json_object_set_new(rootJ, "layerPattern", masterToJson(layerPattern));
+        json_object_set_new(rootJ, "layerHold", json_boolean(layerHold));
+
+        // Chance lane, and the loop count so the rolls carry on where they were
+        json_t* chanceJ = json_array();
+        for (int i = 0; i < MAX_STEPS; i++) {
+            json_array_append_new(chanceJ, json_integer(chanceLane.percent[i]));
+        }
+        json_object_set_new(rootJ, "chance", chanceJ);
+        json_object_set_new(rootJ, "chanceLoop", json_integer(seq.loop));
 
         // Save slide/portamento state for seamless restoration mid-playback
-        json_object_set_new(rootJ, "currentSlideActive", json_boolean(currentSlideActive));
-        json_object_set_new(rootJ, "currentPitch", json_real(currentPitch));
-        json_object_set_new(rootJ, "slideTargetPitch", json_real(slideTargetPitch));
-        json_object_set_new(rootJ, "slideRate", json_real(slideRate));
+        SlideState slide = seq.slideState();
+        json_object_set_new(rootJ, "currentSlideActive", json_boolean(slide.active));
+        json_object_set_new(rootJ, "currentPitch", json_real(slide.pitch));
+        json_object_set_new(rootJ, "slideTargetPitch", json_real(slide.target));
+        json_object_set_new(rootJ, "slideRate", json_real(slide.rate));
+
+        // MIDI output
+        json_object_set_new(rootJ, "midiOutput", midiOutput.toJson());
+        json_object_set_new(rootJ, "midiClockEnabled", json_boolean(midiClockEnabled));
+
+        // MIDI clock input
+        json_object_set_new(rootJ, "midiInput", midiInput.toJson());
+        json_object_set_new(rootJ, "clockFromMidi", json_boolean(clockFromMidi));
+
+        // Pattern display mode
+        json_object_set_new(rootJ, "showMacroMap", json_boolean(showMacroMap));
 
         return rootJ;
     }
@@ -450,50 +1149,14 @@ struct AcidSeq : Module {
         // Load playback position
         json_t* stepJ = json_object_get(rootJ, "currentStep");
         if (stepJ) {
-            currentStep = json_integer_value(stepJ);
+            seq.currentStep = json_integer_value(stepJ);
         }
 
         // Try to load master pattern (version 2+)
         bool loaded = false;
         json_t* masterJ = json_object_get(rootJ, "masterPattern");
         if (masterJ && version >= 2) {
-            // Load bar activation order
-            json_t* barOrderJ = json_object_get(masterJ, "barActivationOrder");
-            if (barOrderJ) {
-                for (int i = 0; i < BAR_LEN && i < (int)json_array_size(barOrderJ); i++) {
-                    masterPattern.barActivationOrder[i] = json_integer_value(json_array_get(barOrderJ, i));
-                }
-            }
-
-            // Load scale priority order
-            json_t* scaleOrderJ = json_object_get(masterJ, "scalePriorityOrder");
-            if (scaleOrderJ) {
-                for (int i = 0; i < SCALE_SIZE && i < (int)json_array_size(scaleOrderJ); i++) {
-                    masterPattern.scalePriorityOrder[i] = json_integer_value(json_array_get(scaleOrderJ, i));
-                }
-            }
-
-            // Load steps
-            json_t* stepsJ = json_object_get(masterJ, "steps");
-            if (stepsJ) {
-                for (int i = 0; i < MAX_STEPS && i < (int)json_array_size(stepsJ); i++) {
-                    json_t* stepDataJ = json_array_get(stepsJ, i);
-                    if (stepDataJ) {
-                        json_t* pJ = json_object_get(stepDataJ, "p");
-                        json_t* oJ = json_object_get(stepDataJ, "o");
-                        json_t* aJ = json_object_get(stepDataJ, "a");
-                        json_t* sJ = json_object_get(stepDataJ, "s");
-                        json_t* mJ = json_object_get(stepDataJ, "m");
-
-                        if (pJ) masterPattern.steps[i].notePoolIndex = json_integer_value(pJ);
-                        if (oJ) masterPattern.steps[i].octave = json_integer_value(oJ);
-                        if (aJ) masterPattern.steps[i].accentProb = json_real_value(aJ);
-                        if (sJ) masterPattern.steps[i].slideProb = json_real_value(sJ);
-                        if (mJ) masterPattern.muted[i] = json_boolean_value(mJ);
-                    }
-                }
-            }
-
+            masterFromJson(masterJ, masterPattern);
             loaded = true;
         }
 
@@ -502,28 +1165,86 @@ struct AcidSeq : Module {
             generateMaster(currentSeed, masterPattern);
         }
 
+        // Layer: from the patch, or for older patches the one GEN would
+        // have made with the seed
+        json_t* layerJ = json_object_get(rootJ, "layerPattern");
+        if (layerJ) {
+            masterFromJson(layerJ, layerPattern);
+        } else {
+            generateMaster(layerSeedFor(currentSeed), layerPattern);
+        }
+        json_t* layerHoldJ = json_object_get(rootJ, "layerHold");
+        if (layerHoldJ) {
+            layerHold = json_boolean_value(layerHoldJ);
+        }
+        mixStale = true;
+
+        // Chance lane: from the patch, or for older patches the seed's
+        generateChance(currentSeed, chanceLane);
+        json_t* chanceJ = json_object_get(rootJ, "chance");
+        if (chanceJ) {
+            for (int i = 0; i < MAX_STEPS && i < (int)json_array_size(chanceJ); i++) {
+                chanceLane.percent[i] = clamp((int)json_integer_value(json_array_get(chanceJ, i)), 1, 100);
+            }
+        }
+        json_t* chanceLoopJ = json_object_get(rootJ, "chanceLoop");
+        if (chanceLoopJ) {
+            seq.loop = static_cast<uint32_t>(json_integer_value(chanceLoopJ));
+        }
+        patternInit.store(PATTERN_READY, std::memory_order_release);
+
         // Force display pattern update
         cachedDensity = -1.f;
+        macroMapStale = true;
 
         // Load slide/portamento state
+        SlideState slide = seq.slideState();
         json_t* slideActiveJ = json_object_get(rootJ, "currentSlideActive");
         if (slideActiveJ) {
-            currentSlideActive = json_boolean_value(slideActiveJ);
+            slide.active = json_boolean_value(slideActiveJ);
         }
 
         json_t* currentPitchJ = json_object_get(rootJ, "currentPitch");
         if (currentPitchJ) {
-            currentPitch = static_cast<float>(json_real_value(currentPitchJ));
+            slide.pitch = static_cast<float>(json_real_value(currentPitchJ));
         }
 
         json_t* slideTargetJ = json_object_get(rootJ, "slideTargetPitch");
         if (slideTargetJ) {
-            slideTargetPitch = static_cast<float>(json_real_value(slideTargetJ));
+            slide.target = static_cast<float>(json_real_value(slideTargetJ));
         }
 
         json_t* slideRateJ = json_object_get(rootJ, "slideRate");
         if (slideRateJ) {
-            slideRate = static_cast<float>(json_real_value(slideRateJ));
+            slide.rate = static_cast<float>(json_real_value(slideRateJ));
+        }
+        seq.setSlideState(slide);
+
+        // Load MIDI output
+        json_t* midiOutputJ = json_object_get(rootJ, "midiOutput");
+        if (midiOutputJ) {
+            midiOutput.fromJson(midiOutputJ);
+        }
+
+        json_t* midiClockJ = json_object_get(rootJ, "midiClockEnabled");
+        if (midiClockJ) {
+            midiClockEnabled = json_boolean_value(midiClockJ);
+        }
+
+        // Load MIDI clock input
+        json_t* midiInputJ = json_object_get(rootJ, "midiInput");
+        if (midiInputJ) {
+            midiInput.fromJson(midiInputJ);
+        }
+
+        json_t* clockFromMidiJ = json_object_get(rootJ, "clockFromMidi");
+        if (clockFromMidiJ) {
+            clockFromMidi = json_boolean_value(clockFromMidiJ);
+        }
+
+        json_t* showMacroMapJ = json_object_get(rootJ, "showMacroMap");
+        if (showMacroMapJ) {
+            showMacroMap = json_boolean_value(showMacroMapJ);
         }
     }
 };
@@ -535,10 +1256,12 @@ struct AcidSeq : Module {
 struct PatternDisplay : widget::OpaqueWidget {
     AcidSeq* module = nullptr;
 
-    static constexpr const char* NOTE_NAMES[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-
     void draw(const DrawArgs& args) override {
         NVGcontext* vg = args.vg;
+        // A new instance drawn before the engine has run it (e.g. engine paused)
+        if (module) {
+            module->ensureInitialPattern();
+        }
 
         // Background
         nvgBeginPath(vg);
@@ -554,7 +1277,8 @@ struct PatternDisplay : widget::OpaqueWidget {
         nvgStroke(vg);
 
         int patternLength = module ? module->cachedPatternLength : 16;
-        int currentStep = module ? module->currentStep : -1;
+        int currentStep = module ? module->seq.currentStep : -1;
+        int chanceAmount = module ? chanceAmountFor(module->params[AcidSeq::PARAM_CHANCE].getValue()) : 0;
 
         // Auto-follow: calculate which page of 16 steps to show
         int viewOffset = 0;
@@ -632,6 +1356,15 @@ struct PatternDisplay : widget::OpaqueWidget {
                 nvgRect(vg, x, barY, barWidth, barHeight);
                 nvgFillColor(vg, barColor);
                 nvgFill(vg);
+
+                // Chance below 100%: darken the bar by the odds of a drop
+                int chance = chanceAmount > 0 ? module->chanceLane.chanceAt(stepIndex, chanceAmount) : 100;
+                if (chance < 100) {
+                    nvgBeginPath(vg);
+                    nvgRect(vg, x, barY, barWidth, barHeight);
+                    nvgFillColor(vg, nvgRGBA(0x0a, 0x0a, 0x0a, (100 - chance) * 2));
+                    nvgFill(vg);
+                }
             }
 
             // Current step indicator (bottom line)
@@ -669,44 +1402,141 @@ struct PatternDisplay : widget::OpaqueWidget {
 };
 
 //-----------------------------------------------------------------------------
-// Scale/Root + Current Note Display Widget
+// DENSITY x SPREAD Map - Pattern display mode previewing every knob setting
 //-----------------------------------------------------------------------------
+// One cell per DENSITY level (columns, 0-16 bar positions) and SPREAD level
+// (rows, 1-7 pool entries, widest at the top). Brightness is the note count
+// over the loop, the bar inside a cell its pitch range. The cells sit in a
+// framebuffer that is redrawn only when the worker delivers a new map; the
+// crosshair on top follows the knobs every frame.
 
-struct InfoDisplay : widget::OpaqueWidget {
+struct MacroMapCellsWidget : widget::Widget {
+    const MacroMapWorker* worker = nullptr;
+    float padding = 3.f;
+
+    void draw(const DrawArgs& args) override {
+        if (!worker || !worker->ready()) {
+            return;
+        }
+        NVGcontext* vg = args.vg;
+        const MacroMapCells& map = worker->map;
+        float cellWidth = (box.size.x - padding * 2) / DENSITY_LEVELS;
+        float cellHeight = (box.size.y - padding * 2) / SPREAD_LEVELS;
+
+        // Ranges are scaled to the widest one on the map
+        int widest = 1;
+        for (int d = 0; d < DENSITY_LEVELS; d++) {
+            for (int s = 0; s < SPREAD_LEVELS; s++) {
+                widest = std::max(widest, map.cells[d][s].high - map.cells[d][s].low);
+            }
+        }
+
+        for (int d = 0; d < DENSITY_LEVELS; d++) {
+            for (int s = 0; s < SPREAD_LEVELS; s++) {
+                const SweepCell& cell = map.cells[d][s];
+                if (cell.notes == 0) {
+                    continue;
+                }
+                float x = padding + d * cellWidth;
+                float y = padding + (SPREAD_LEVELS - 1 - s) * cellHeight;
+
+                // Note count: dark to the bright cyan of the step bars
+                float fill = 0.2f + 0.8f * cell.notes / static_cast<float>(map.length);
+                nvgBeginPath(vg);
+                nvgRect(vg, x + 0.5f, y + 0.5f, cellWidth - 1.f, cellHeight - 1.f);
+                nvgFillColor(vg, nvgRGB((int)(0x79 * fill), (int)(0xd8 * fill), (int)(0xb9 * fill)));
+                nvgFill(vg);
+
+                // Pitch range, from the bottom of the cell
+                float range = (cell.high - cell.low) / static_cast<float>(widest);
+                float barHeight = std::max(1.f, range * (cellHeight - 2.f));
+                nvgBeginPath(vg);
+                nvgRect(vg, x + cellWidth / 2 - 0.75f, y + cellHeight - 1.f - barHeight, 1.5f, barHeight);
+                nvgFillColor(vg, nvgRGB(0xff, 0x80, 0x40));
+                nvgFill(vg);
+            }
+        }
+    }
+};
+
+struct MacroMapDisplay : widget::OpaqueWidget {
     AcidSeq* module = nullptr;
+    widget::FramebufferWidget* framebuffer = nullptr;
+    float padding = 3.f;
+
+    MacroMapDisplay(AcidSeq* module, Vec pos, Vec size) : module(module) {
+        box.pos = pos;
+        box.size = size;
+        framebuffer = new widget::FramebufferWidget();
+        framebuffer->box.size = size;
+        MacroMapCellsWidget* cells = new MacroMapCellsWidget();
+        cells->box.size = size;
+        cells->padding = padding;
+        cells->worker = module ? &module->macroMap : nullptr;
+        framebuffer->addChild(cells);
+        addChild(framebuffer);
+    }
 
-    static constexpr const char* NOTE_NAMES[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-
-    static const char* getScaleAbbrev(Scale scale) {
-        switch (scale) {
-            case Scale::MAJOR: return "MAJ";
-            case Scale::MINOR: return "MIN";
-            case Scale::DORIAN: return "DOR";
-            case Scale::MIXOLYDIAN: return "MIX";
-            case Scale::LYDIAN: return "LYD";
-            case Scale::PHRYGIAN: return "PHR";
-            case Scale::LOCRIAN: return "LOC";
-            case Scale::HARMONIC_MINOR: return "H-m";
-            case Scale::HARMONIC_MAJOR: return "H-M";
-            case Scale::DORIAN_NR_4: return "D#4";
-            case Scale::PHRYGIAN_DOMINANT: return "PhD";
-            case Scale::MELODIC_MINOR: return "Mm";
-            case Scale::LYDIAN_AUGMENTED: return "L+";
-            case Scale::LYDIAN_DOMINANT: return "LD";
-            case Scale::HUNGARIAN_MINOR: return "HUN";
-            case Scale::SUPER_LOCRIAN: return "SuL";
-            case Scale::SPANISH: return "SPA";
-            case Scale::BHAIRAV: return "BHV";
-            case Scale::PENTATONIC_MINOR: return "Pm";
-            case Scale::PENTATONIC_MAJOR: return "PM";
-            case Scale::BLUES_MINOR: return "BLU";
-            case Scale::WHOLE_TONE: return "WHL";
-            case Scale::CHROMATIC: return "CHR";
-            case Scale::JAPANESE_IN_SEN: return "INS";
-            default: return "---";
+    void step() override {
+        // Collects a finished sweep and starts the next one
+        if (module && module->macroMap.poll()) {
+            framebuffer->setDirty();
         }
+        OpaqueWidget::step();
     }
 
+    void draw(const DrawArgs& args) override {
+        NVGcontext* vg = args.vg;
+
+        nvgBeginPath(vg);
+        nvgRoundedRect(vg, 0, 0, box.size.x, box.size.y, 3.f);
+        nvgFillColor(vg, nvgRGB(0x0a, 0x0a, 0x0a));
+        nvgFill(vg);
+
+        nvgBeginPath(vg);
+        nvgRoundedRect(vg, 0, 0, box.size.x, box.size.y, 3.f);
+        nvgStrokeColor(vg, nvgRGB(0x33, 0x33, 0x33));
+        nvgStrokeWidth(vg, 1.f);
+        nvgStroke(vg);
+
+        // Cached cells
+        OpaqueWidget::draw(args);
+
+        if (!module) {
+            return;
+        }
+
+        // Crosshair through the cell the knobs select
+        float cellWidth = (box.size.x - padding * 2) / DENSITY_LEVELS;
+        float cellHeight = (box.size.y - padding * 2) / SPREAD_LEVELS;
+        int d = densityLevel(module->params[AcidSeq::PARAM_DENSITY].getValue());
+        int s = spreadLevel(module->params[AcidSeq::PARAM_SPREAD].getValue());
+        float x = padding + d * cellWidth;
+        float y = padding + (SPREAD_LEVELS - 1 - s) * cellHeight;
+
+        nvgBeginPath(vg);
+        nvgMoveTo(vg, x + cellWidth / 2, padding);
+        nvgLineTo(vg, x + cellWidth / 2, box.size.y - padding);
+        nvgMoveTo(vg, padding, y + cellHeight / 2);
+        nvgLineTo(vg, box.size.x - padding, y + cellHeight / 2);
+        nvgStrokeColor(vg, nvgRGBA(0xff, 0xff, 0xff, 0x40));
+        nvgStrokeWidth(vg, 1.f);
+        nvgStroke(vg);
+
+        nvgBeginPath(vg);
+        nvgRect(vg, x, y, cellWidth, cellHeight);
+        nvgStrokeColor(vg, nvgRGB(0xff, 0xff, 0xff));
+        nvgStroke(vg);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Scale/Root + Current Note Display Widget
+//-----------------------------------------------------------------------------
+
+struct InfoDisplay : widget::OpaqueWidget {
+    AcidSeq* module = nullptr;
+
     void draw(const DrawArgs& args) override {
         NVGcontext* vg = args.vg;
 
@@ -719,7 +1549,7 @@ struct InfoDisplay : widget::OpaqueWidget {
         // Get values
         Scale scale = module ? module->cachedScale : Scale::MINOR;
         int rootNote = module ? module->cachedRootNote : 0;
-        int currentStep = module ? module->currentStep : -1;
+        int currentStep = module ? module->seq.currentStep : -1;
         int patternLength = module ? module->cachedPatternLength : 16;
 
         const char* rootName = NOTE_NAMES[rootNote % 12];
@@ -730,7 +1560,6 @@ struct InfoDisplay : widget::OpaqueWidget {
         if (module && currentStep >= 0 && currentStep < patternLength) {
             SequenceStep step = module->displayPattern.steps[currentStep];
             if (!step.isRest()) {
-                int noteInScale = step.note % 7;
                 int octave = step.octave + 4;  // Base octave
                 // Get the actual note name based on scale and root
                 int midiNote = getNoteInScale(step.note, scale, rootNote, step.octave);
@@ -753,6 +1582,25 @@ struct InfoDisplay : widget::OpaqueWidget {
         nvgFillColor(vg, nvgRGB(0xff, 0xff, 0xff));
         nvgTextAlign(vg, NVG_ALIGN_RIGHT | NVG_ALIGN_MIDDLE);
         nvgText(vg, box.size.x - 4, box.size.y / 2, currentNoteStr, nullptr);
+
+        // Record indicator (center): solid while capturing, dim while armed
+        if (module && module->recordEnabled) {
+            nvgBeginPath(vg);
+            nvgCircle(vg, box.size.x / 2, box.size.y / 2, 2.5f);
+            nvgFillColor(vg, module->recordActive ? nvgRGB(0xff, 0x30, 0x30) : nvgRGB(0x60, 0x18, 0x18));
+            nvgFill(vg);
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Context menu slider bound to a parameter (voice, chance)
+//-----------------------------------------------------------------------------
+
+struct MenuParamSlider : ui::Slider {
+    MenuParamSlider(ParamQuantity* pq) {
+        quantity = pq;
+        box.size.x = 200.f;
     }
 };
 
@@ -761,6 +1609,9 @@ struct InfoDisplay : widget::OpaqueWidget {
 //-----------------------------------------------------------------------------
 
 struct AcidSeqWidget : ModuleWidget {
+    PatternDisplay* patternDisplay = nullptr;
+    MacroMapDisplay* macroMapDisplay = nullptr;
+
     AcidSeqWidget(AcidSeq* module) {
         setModule(module);
         setPanel(createPanel(asset::plugin(pluginInstance, "res/AcidGenMini.svg")));
@@ -795,8 +1646,14 @@ struct AcidSeqWidget : ModuleWidget {
             patternDisp->box.size = mm2px(Vec(52.96, 22));
             patternDisp->module = module;
             addChild(patternDisp);
+            patternDisplay = patternDisp;
         }
 
+        // === DENSITY x SPREAD Map (same place, shown instead from the menu) ===
+        macroMapDisplay = new MacroMapDisplay(module, mm2px(Vec(4, 46)), mm2px(Vec(52.96, 22)));
+        macroMapDisplay->visible = false;
+        addChild(macroMapDisplay);
+
         // === Info Display (Scale/Root + Current Note) ===
         {
             InfoDisplay* infoDisp = new InfoDisplay();
@@ -822,27 +1679,182 @@ struct AcidSeqWidget : ModuleWidget {
             addChild(createLightCentered<SmallLight<GreenLight>>(mm2px(Vec(x, 82)), module, AcidSeq::LIGHT_OCTAVE + i));
         }
 
-        // === Inputs Row (well-spaced) ===
-        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(10, 98.4125)), module, AcidSeq::INPUT_CLOCK));
-        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(24, 98.4125)), module, AcidSeq::INPUT_RESET));
-        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(38, 98.4125)), module, AcidSeq::INPUT_GENERATE));
+        // === Jack Grid ===
+        // Inputs on a 4-column grid (15.24mm pitch) on the dark band, outputs
+        // on a 6-column grid (10.16mm pitch) on the light plate; labels sit
+        // 4.8mm above each jack row
+        const float IN_COL[4] = {7.62f, 22.86f, 38.1f, 53.34f};
+        const float OUT_COL[6] = {5.08f, 15.24f, 25.4f, 35.56f, 45.72f, 55.88f};
+        const float IN_ROW = 95.6f;
+        const float REC_ROW = 106.9f;
+        const float OUT_ROW = 118.8f;
+
+        // === Inputs Row ===
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[0], IN_ROW)), module, AcidSeq::INPUT_CLOCK));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[1], IN_ROW)), module, AcidSeq::INPUT_RESET));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[2], IN_ROW)), module, AcidSeq::INPUT_GENERATE));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[3], IN_ROW)), module, AcidSeq::INPUT_LAYER_OP));
+
+        // === Record Inputs Row ===
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[0], REC_ROW)), module, AcidSeq::INPUT_REC_PITCH));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[1], REC_ROW)), module, AcidSeq::INPUT_REC_GATE));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[2], REC_ROW)), module, AcidSeq::INPUT_REC_ACCENT));
+        addInput(createInputCentered<PJ301MPort>(mm2px(Vec(IN_COL[3], REC_ROW)), module, AcidSeq::INPUT_REC_SLIDE));
+
+        // === Outputs Row ===
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[0], OUT_ROW)), module, AcidSeq::OUTPUT_PITCH));
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[1], OUT_ROW)), module, AcidSeq::OUTPUT_GATE));
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[2], OUT_ROW)), module, AcidSeq::OUTPUT_ACCENT));
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[3], OUT_ROW)), module, AcidSeq::OUTPUT_SLIDE));
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[4], OUT_ROW)), module, AcidSeq::OUTPUT_ACCENT_CV));
+        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(OUT_COL[5], OUT_ROW)), module, AcidSeq::OUTPUT_AUDIO));
+    }
 
-        // === Outputs Row (well-spaced) ===
-        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(10, 114)), module, AcidSeq::OUTPUT_PITCH));
-        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(24, 114)), module, AcidSeq::OUTPUT_GATE));
-        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(38, 114)), module, AcidSeq::OUTPUT_ACCENT));
-        addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(51, 114)), module, AcidSeq::OUTPUT_SLIDE));
+    void step() override {
+        AcidSeq* module = dynamic_cast<AcidSeq*>(this->module);
+        bool map = module && module->showMacroMap;
+        patternDisplay->visible = !map;
+        macroMapDisplay->visible = map;
+        ModuleWidget::step();
     }
 
-    // Context menu for scale selection
+    // Context menu: record arm, display mode, MIDI clock in/out, layering, chance, voice settings,
+    // clock timing, input capture and scale selection
     void appendContextMenu(Menu* menu) override {
         AcidSeq* module = dynamic_cast<AcidSeq*>(this->module);
         if (!module) return;
 
+        menu->addChild(new MenuSeparator());
+        menu->addChild(createBoolPtrMenuItem("Record REC inputs", "commits each loop", &module->recordEnabled));
+        menu->addChild(createBoolPtrMenuItem("Show DENSITY x SPREAD map", "", &module->showMacroMap));
+
+        menu->addChild(createSubmenuItem("MIDI clock input", "", [=](Menu* menu) {
+            menu->addChild(createBoolPtrMenuItem("Clock from MIDI (replaces CLK)", "", &module->clockFromMidi));
+            menu->addChild(new MenuSeparator());
+            appendMidiMenu(menu, &module->midiInput);
+        }));
+
+        menu->addChild(createSubmenuItem("MIDI output", "", [=](Menu* menu) {
+            appendMidiMenu(menu, &module->midiOutput);
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createBoolPtrMenuItem("Send clock (24 PPQN)", "", &module->midiClockEnabled));
+        }));
+
+        LayerOp layerOp = static_cast<LayerOp>(static_cast<int>(module->params[AcidSeq::PARAM_LAYER_OP].getValue()));
+        menu->addChild(createSubmenuItem("Layer", getLayerOpName(layerOp), [=](Menu* menu) {
+            menu->addChild(createMenuLabel("Rhythm (LAYER CV adds 1V per op)"));
+            for (int op = 0; op < NUM_LAYER_OPS; op++) {
+                menu->addChild(createCheckMenuItem(
+                    getLayerOpName(static_cast<LayerOp>(op)),
+                    "",
+                    [=]() { return static_cast<int>(module->params[AcidSeq::PARAM_LAYER_OP].getValue()) == op; },
+                    [=]() { module->params[AcidSeq::PARAM_LAYER_OP].setValue(static_cast<float>(op)); }
+                ));
+            }
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createMenuLabel("Pitch"));
+            const char* layerNames[] = {"From A", "From B"};
+            for (int l = 0; l < 2; l++) {
+                menu->addChild(createCheckMenuItem(
+                    layerNames[l],
+                    "",
+                    [=]() { return static_cast<int>(module->params[AcidSeq::PARAM_LAYER_PITCH].getValue()) == l; },
+                    [=]() { module->params[AcidSeq::PARAM_LAYER_PITCH].setValue(static_cast<float>(l)); }
+                ));
+            }
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createBoolPtrMenuItem("Keep layer B on GEN", "", &module->layerHold));
+        }));
+
+        int chanceAmount = chanceAmountFor(module->params[AcidSeq::PARAM_CHANCE].getValue());
+        menu->addChild(createSubmenuItem("Chance", std::to_string(chanceAmount) + "%", [=](Menu* menu) {
+            menu->addChild(new MenuParamSlider(module->paramQuantities[AcidSeq::PARAM_CHANCE]));
+            menu->addChild(createMenuLabel("0% plays every step; GEN rolls a new lane"));
+        }));
+
+        menu->addChild(createSubmenuItem("Voice", "", [=](Menu* menu) {
+            for (int id = AcidSeq::PARAM_VOICE_CUTOFF; id <= AcidSeq::PARAM_VOICE_ACCENT; id++) {
+                menu->addChild(new MenuParamSlider(module->paramQuantities[id]));
+            }
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createMenuLabel("Waveform"));
+            const char* waveNames[] = {"Saw", "Square"};
+            for (int w = 0; w < 2; w++) {
+                menu->addChild(createCheckMenuItem(
+                    waveNames[w],
+                    "",
+                    [=]() { return static_cast<int>(module->params[AcidSeq::PARAM_VOICE_WAVEFORM].getValue()) == w; },
+                    [=]() { module->params[AcidSeq::PARAM_VOICE_WAVEFORM].setValue(static_cast<float>(w)); }
+                ));
+            }
+        }));
+
+        menu->addChild(createSubmenuItem("Clock timing", "samples", [=](Menu* menu) {
+            const ClockStats& cs = module->clockStats;
+            menu->addChild(createMenuLabel(cs.intervalLine()));
+            menu->addChild(createMenuLabel(ClockStats::percentileLine("Deviation from tempo", cs.deviation)));
+            menu->addChild(createMenuLabel(ClockStats::percentileLine("Edge to gate", cs.latency)));
+            menu->addChild(createMenuLabel("Stops/glitches: " + std::to_string(cs.unmeasured.load())));
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createMenuItem("Reset", "", [=]() {
+                module->clockStats.resetRequested.store(true, std::memory_order_release);
+            }));
+        }));
+
+        menu->addChild(createSubmenuItem("Input capture", module->capturing() ? "recording" : "", [=](Menu* menu) {
+            if (module->capturing()) {
+                const CaptureSession& session = *module->capture;
+                menu->addChild(createMenuLabel(session.path));
+                menu->addChild(createMenuLabel(std::to_string(session.bytesWritten.load() / 1024) + " KB written"));
+                menu->addChild(createMenuItem("Stop capture", "", [=]() {
+                    module->stopCapture();
+                }));
+            } else {
+                menu->addChild(createMenuItem("Start capture", "", [=]() {
+                    std::time_t now = std::time(nullptr);
+                    char stamp[32];
+                    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+                    module->startCapture(asset::user(std::string("AcidGenMini-") + stamp + ".acidcap"));
+                }));
+                if (module->capture) {
+                    menu->addChild(createMenuLabel("Last: " + module->capture->path));
+                }
+            }
+        }));
+
+#ifdef ACIDSEQ_TRACE
+        menu->addChild(createSubmenuItem("Memory", Footprint::kb(module->footprint().total()), [=](Menu* menu) {
+            Footprint f = module->footprint();
+            menu->addChild(createMenuLabel("Module object: " + Footprint::kb(f.object)));
+            for (int i = 0; i < f.count; i++) {
+                menu->addChild(createMenuLabel(Footprint::line(f.parts[i])));
+            }
+            menu->addChild(createMenuLabel("Total: " + Footprint::kb(f.total())));
+        }));
+
+        menu->addChild(createSubmenuItem("Trace stats", TRACE_UNIT, [=](Menu* menu) {
+            for (int i = 0; i < TRACE_SECTIONS; i++) {
+                menu->addChild(createMenuLabel(module->traceStats.sectionLine(i)));
+            }
+            menu->addChild(new MenuSeparator());
+            for (int i = 0; i < TRACE_EVENTS; i++) {
+                menu->addChild(createMenuLabel(module->traceStats.eventLine(i)));
+            }
+            menu->addChild(new MenuSeparator());
+            menu->addChild(createMenuItem("Reset stats", "", [=]() {
+                module->traceStats.resetRequested.store(true, std::memory_order_release);
+            }));
+            std::string path = asset::user("AcidGenMini-stats.txt");
+            menu->addChild(createMenuItem("Dump to file", "AcidGenMini-stats.txt", [=]() {
+                module->dumpTraceStats(path);
+            }));
+        }));
+#endif
+
         menu->addChild(new MenuSeparator());
         menu->addChild(createMenuLabel("Scale"));
 
-        for (int i = 0; i < static_cast<int>(Scale::NUM_SCALES); i++) {
+        for (int i = 0; i < NUM_SCALES; i++) {
             Scale s = static_cast<Scale>(i);
             menu->addChild(createCheckMenuItem(
                 getScaleName(s),
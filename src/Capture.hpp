@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Capture - Record the engine's inputs for offline replay
+//-----------------------------------------------------------------------------
+// The audio thread writes fixed-size records into a preallocated ring; a
+// writer thread drains it to disk, so process() never allocates or blocks.
+// tools/acidseq-replay feeds a capture back through AcidSeq and compares the
+// outputs block by block.
+//
+// File layout (little-endian):
+//   char[8]  magic "ACIDCAP1"
+//   u32      version (1)
+//   u32      stateBytes         size of the module state snapshot
+//   u32      hashBlock          frames per OUTPUT_HASH record
+//   u32      reserved
+//   u8[stateBytes]              state at the first captured frame
+//   CaptureRecord...            12 bytes each, frames ascending, ends with END
+//
+// Frames count from the first captured process() call. Before each frame the
+// replayer applies that frame's records, then runs process(). Only values
+// that changed are recorded, except at frame 0 where everything is.
+
+namespace AcidGenerator {
+
+enum CaptureKind : uint8_t {
+    CAPTURE_INPUT = 1,      // index = input id, value = voltage bits
+    CAPTURE_CONNECTED,      // index = input id, value = 0/1
+    CAPTURE_PARAM,          // index = param id, value = value bits
+    CAPTURE_SAMPLE_RATE,    // value = sample rate bits
+    CAPTURE_SEED,           // value = seed chosen by a GEN on this frame
+    CAPTURE_FLAGS,          // value = context menu switches the engine reads (module-defined bits)
+    CAPTURE_OUTPUT_HASH,    // value = hash of the outputs of the hashBlock frames ending here
+    CAPTURE_END,            // value = records dropped because the ring was full
+};
+
+struct CaptureRecord {
+    uint32_t frame;
+    uint8_t kind;
+    uint8_t index;
+    uint16_t reserved;
+    uint32_t value;
+};
+static_assert(sizeof(CaptureRecord) == 12, "capture records are 12 bytes on disk");
+
+inline uint32_t floatBits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    return u;
+}
+
+inline float bitsFloat(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, 4);
+    return f;
+}
+
+// FNV-1a over the bit patterns of a frame's outputs
+inline uint32_t hashOutputs(uint32_t hash, const float* values, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t u = floatBits(values[i]);
+        for (int b = 0; b < 4; b++) {
+            hash = (hash ^ ((u >> (8 * b)) & 0xff)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+constexpr uint32_t HASH_SEED = 2166136261u;
+constexpr char CAPTURE_MAGIC[8] = {'A', 'C', 'I', 'D', 'C', 'A', 'P', '1'};
+constexpr uint32_t CAPTURE_VERSION = 1;
+constexpr uint32_t CAPTURE_HASH_BLOCK = 256;
+
+//-----------------------------------------------------------------------------
+// CaptureSession - One capture: ring, state snapshot and writer thread
+//-----------------------------------------------------------------------------
+// Lifecycle: the UI constructs the session (allocates, opens the file and
+// starts the writer), then publishes it to the audio thread. The audio
+// thread fills `state` once, sets `started`, and pushes records until it
+// sees `stopRequested`, when it pushes END and sets `finished`. The writer
+// drains until `finished`. Destroy the session only once the audio thread
+// has let go of it (finished, or the module is out of the engine): the
+// destructor drains what is left, without END if the audio thread never
+// finished, and closes the file.
+
+struct CaptureSession {
+    static constexpr uint32_t RING_SIZE = 1 << 16;  // 768 KB, ~80 s of output hashes alone
+
+    std::vector<CaptureRecord> ring;
+    std::atomic<uint32_t> head{0};  // Written by the audio thread
+    std::atomic<uint32_t> tail{0};  // Written by the writer thread
+    uint32_t dropped = 0;           // Audio thread
+
+    std::vector<uint8_t> state;     // Filled by the audio thread before `started`
+    std::atomic<bool> started{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> closing{false};  // Destructor: drain and exit
+    std::atomic<uint64_t> bytesWritten{0};
+
+    // Audio thread frame bookkeeping
+    uint32_t frame = 0;
+    uint32_t hash = HASH_SEED;
+
+    std::string path;
+    FILE* file = nullptr;
+    std::thread writer;
+
+    CaptureSession(const std::string& path, size_t stateBytes) : ring(RING_SIZE), state(stateBytes), path(path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (file) {
+            writer = std::thread([this] { writeLoop(); });
+        }
+    }
+
+    ~CaptureSession() {
+        closing = true;
+        if (writer.joinable()) {
+            writer.join();
+        }
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    bool ok() const {
+        return file != nullptr;
+    }
+
+    // Audio thread. Drops (and counts) the record when the ring is full.
+    void push(uint8_t kind, uint8_t index, uint32_t value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= RING_SIZE) {
+            dropped++;
+            return;
+        }
+        ring[h & (RING_SIZE - 1)] = {frame, kind, index, 0, value};
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Audio thread, after process(): fold this frame's outputs into the hash
+    void endFrame(const float* outputs, int count) {
+        hash = hashOutputs(hash, outputs, count);
+        if ((frame + 1) % CAPTURE_HASH_BLOCK == 0) {
+            push(CAPTURE_OUTPUT_HASH, 0, hash);
+            hash = HASH_SEED;
+        }
+        frame++;
+    }
+
+    // Audio thread. If the ring is full, END is lost too and the replayer
+    // reports the capture as incomplete.
+    void finish() {
+        push(CAPTURE_END, 0, dropped);
+        finished.store(true, std::memory_order_release);
+    }
+
+private:
+    void writeLoop() {
+        while (!started.load(std::memory_order_acquire)) {
+            if (closing.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        uint32_t header[4] = {CAPTURE_VERSION, static_cast<uint32_t>(state.size()), CAPTURE_HASH_BLOCK, 0};
+        std::fwrite(CAPTURE_MAGIC, 1, 8, file);
+        std::fwrite(header, 4, 4, file);
+        std::fwrite(state.data(), 1, state.size(), file);
+        bytesWritten += 24 + state.size();
+
+        for (;;) {
+            bool done = finished.load(std::memory_order_acquire) || closing.load(std::memory_order_acquire);
+            uint32_t h = head.load(std::memory_order_acquire);
+            uint32_t t = tail.load(std::memory_order_relaxed);
+            while (t != h) {
+                // Contiguous run up to the ring's end
+                uint32_t begin = t & (RING_SIZE - 1);
+                uint32_t n = std::min(h - t, RING_SIZE - begin);
+                std::fwrite(&ring[begin], sizeof(CaptureRecord), n, file);
+                bytesWritten += n * sizeof(CaptureRecord);
+                t += n;
+                tail.store(t, std::memory_order_release);
+            }
+            if (done) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::fflush(file);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Capture file reading (replay tool and tests)
+//-----------------------------------------------------------------------------
+
+struct CaptureFile {
+    std::vector<uint8_t> state;
+    std::vector<CaptureRecord> records;
+    uint32_t hashBlock = CAPTURE_HASH_BLOCK;
+    bool complete = false;  // Ends with an END record
+    uint32_t dropped = 0;
+
+    bool load(const std::string& path, std::string& error) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            error = "cannot open " + path;
+            return false;
+        }
+        char magic[8];
+        uint32_t header[4];
+        if (std::fread(magic, 1, 8, f) != 8 || std::memcmp(magic, CAPTURE_MAGIC, 8) != 0 ||
+            std::fread(header, 4, 4, f) != 4) {
+            std::fclose(f);
+            error = "not a capture file";
+            return false;
+        }
+        if (header[0] != CAPTURE_VERSION || header[2] == 0) {
+            std::fclose(f);
+            error = "unsupported capture version";
+            return false;
+        }
+        state.resize(header[1]);
+        hashBlock = header[2];
+        if (std::fread(state.data(), 1, state.size(), f) != state.size()) {
+            std::fclose(f);
+            error = "truncated state";
+            return false;
+        }
+        CaptureRecord r;
+        while (std::fread(&r, sizeof(r), 1, f) == 1) {
+            records.push_back(r);
+        }
+        std::fclose(f);
+        if (!records.empty() && records.back().kind == CAPTURE_END) {
+            complete = true;
+            dropped = records.back().value;
+        }
+        return true;
+    }
+};
+
+} // namespace AcidGenerator
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Capture.hpp"
+
+#include <cstdint>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// replayCapture - Drive a module from a capture and check its outputs
+//-----------------------------------------------------------------------------
+// Shared by tools/acidseq-replay and the module tests. TModule is AcidSeq
+// (kept generic so this header stays free of the module's definition). It
+// needs loadReplayState(), applyCaptureFlags(), replaySeed, captureOutputs()
+// and the Rack port, param and process() API.
+
+namespace AcidGenerator {
+
+struct ReplayResult {
+    uint64_t frames = 0;
+    uint64_t blocksChecked = 0;
+    int64_t firstMismatchFrame = -1;  // First frame of the first block that differs
+    std::string error;                // Set when the capture cannot be replayed
+};
+
+// perFrame(frame, outputs, count) is called after every process()
+template <typename TModule, typename F>
+ReplayResult replayCapture(const CaptureFile& capture, TModule& module, F&& perFrame) {
+    ReplayResult result;
+    if (capture.state.size() != sizeof(typename TModule::ReplayState)) {
+        result.error = "capture was made by a different build (state size mismatch)";
+        return result;
+    }
+
+    typename TModule::ProcessArgs args;
+    const std::vector<CaptureRecord>& records = capture.records;
+    size_t next = 0;
+
+    // Sample rate first, so state restored afterwards keeps its coefficients
+    for (const CaptureRecord& r : records) {
+        if (r.frame != 0) {
+            break;
+        }
+        if (r.kind == CAPTURE_SAMPLE_RATE) {
+            args.sampleRate = bitsFloat(r.value);
+            args.sampleTime = 1.f / args.sampleRate;
+            typename TModule::SampleRateChangeEvent e;
+            e.sampleRate = args.sampleRate;
+            e.sampleTime = args.sampleTime;
+            module.onSampleRateChange(e);
+        }
+    }
+    module.loadReplayState(capture.state.data());
+
+    uint32_t hash = HASH_SEED;
+    for (uint32_t frame = 0; next < records.size(); frame++) {
+        // This frame's inputs, params and GEN seed
+        for (; next < records.size() && records[next].frame == frame; next++) {
+            const CaptureRecord& r = records[next];
+            if (r.kind == CAPTURE_OUTPUT_HASH || r.kind == CAPTURE_END) {
+                break;
+            }
+            switch (r.kind) {
+                case CAPTURE_INPUT: module.inputs[r.index].setVoltage(bitsFloat(r.value)); break;
+                case CAPTURE_CONNECTED: module.inputs[r.index].setChannels(r.value ? 1 : 0); break;
+                case CAPTURE_PARAM: module.params[r.index].setValue(bitsFloat(r.value)); break;
+                case CAPTURE_SEED: module.replaySeed = static_cast<int64_t>(r.value); break;
+                case CAPTURE_FLAGS: module.applyCaptureFlags(r.value); break;
+                case CAPTURE_SAMPLE_RATE:
+                    if (bitsFloat(r.value) != args.sampleRate) {
+                        args.sampleRate = bitsFloat(r.value);
+                        args.sampleTime = 1.f / args.sampleRate;
+                        typename TModule::SampleRateChangeEvent e;
+                        e.sampleRate = args.sampleRate;
+                        e.sampleTime = args.sampleTime;
+                        module.onSampleRateChange(e);
+                    }
+                    break;
+            }
+        }
+        if (next < records.size() && records[next].frame == frame && records[next].kind == CAPTURE_END) {
+            break;
+        }
+
+        args.frame = frame;
+        module.process(args);
+        float outputs[TModule::CAPTURE_OUTPUTS];
+        module.captureOutputs(outputs);
+        perFrame(frame, outputs, TModule::CAPTURE_OUTPUTS);
+        hash = hashOutputs(hash, outputs, TModule::CAPTURE_OUTPUTS);
+        result.frames++;
+
+        if (next < records.size() && records[next].frame == frame && records[next].kind == CAPTURE_OUTPUT_HASH) {
+            if (records[next].value != hash && result.firstMismatchFrame < 0) {
+                result.firstMismatchFrame = frame + 1 - capture.hashBlock;
+            }
+            result.blocksChecked++;
+            hash = HASH_SEED;
+            next++;
+        }
+    }
+    return result;
+}
+
+} // namespace AcidGenerator
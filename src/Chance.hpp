@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Generator.hpp"
+
+#include <cstdint>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Chance - Per-step play probability with counter-based rolls
+//-----------------------------------------------------------------------------
+// Each step carries a chance to play. At play time it is compared with a
+// roll that is a pure function of (seed, loop, step): a hash, not a draw
+// from a sequential RNG. Steps don't consume each other's randomness, any
+// roll can be recomputed in O(1) in any order (the slide lookahead re-rolls
+// the previous step), and the same seed and loop count give the same steps
+// after a reset, a reload or an offline re-render.
+//
+// The CHANCE amount (0-100%) fades between every step playing (0) and the
+// lane's own values (100), so a patch that never turns it up plays as before.
+
+// SplitMix64 finalizer over the seed-scrambled (loop, step) counter
+inline uint32_t chanceHash(uint32_t seed, uint32_t loop, uint32_t step) {
+    uint64_t x = ((static_cast<uint64_t>(loop) << 8) | step) + static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return static_cast<uint32_t>((x ^ (x >> 31)) >> 32);
+}
+
+// 0-99, uniform
+inline int chanceRoll(uint32_t seed, uint32_t loop, int step) {
+    return static_cast<int>((static_cast<uint64_t>(chanceHash(seed, loop, static_cast<uint32_t>(step))) * 100) >> 32);
+}
+
+// CHANCE amount (0-100) in the integer percent the lane compares with
+inline int chanceAmountFor(float amount) {
+    if (!(amount > 0.f)) {
+        return 0;
+    }
+    return amount >= 100.f ? 100 : static_cast<int>(amount + 0.5f);
+}
+
+struct ChanceLane {
+    uint32_t seed = 0;            // Seed of the rolls (the pattern's)
+    uint8_t percent[MAX_STEPS];   // Chance each step plays, 1-100
+
+    ChanceLane() {
+        for (int i = 0; i < MAX_STEPS; i++) {
+            percent[i] = 100;
+        }
+    }
+
+    // Chance at a CHANCE amount (integer percent)
+    int chanceAt(int step, int amount) const {
+        return 100 - amount * (100 - percent[step]) / 100;
+    }
+
+    // Whether a step that the pattern plays survives its roll on this loop
+    bool plays(int step, uint32_t loop, int amount) const {
+        int chance = chanceAt(step, amount);
+        return chance >= 100 || chanceRoll(seed, loop, step) < chance;
+    }
+};
+
+// Rolls for the lane itself use their own key, so they are unrelated to
+// playback rolls and to generateMaster()'s RNG stream (and its golden vectors)
+constexpr uint32_t CHANCE_LANE_KEY = 0x6c8e9cf5u;
+
+// Lane for a seed: quarter-note steps always play, the rest are 100% half
+// the time and otherwise 75%, 50% or 25%
+inline void generateChance(uint32_t seed, ChanceLane& lane) {
+    static const uint8_t CHOICES[8] = {100, 100, 100, 100, 75, 75, 50, 25};
+    lane.seed = seed;
+    for (int i = 0; i < MAX_STEPS; i++) {
+        lane.percent[i] = i % 4 == 0 ? 100 : CHOICES[chanceHash(seed ^ CHANCE_LANE_KEY, 0, i) & 7];
+    }
+}
+
+} // namespace AcidGenerator
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Sequencer.hpp"
+#include "Trace.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// ClockStats - Clock interval, tempo deviation and edge-to-gate latency
+//-----------------------------------------------------------------------------
+// Tells a loose bassline's causes apart:
+//   interval   frames between clock edges (the source clock as the module sees it)
+//   deviation  |interval - tracked period| in frames: the jitter the engine
+//              smooths over, since gate lengths and MIDI clock spacing follow
+//              the tracked period, not the latest interval
+//   latency    frames from a clock edge to the GATE rising for a non-legato
+//              note (0, or the 1ms retrigger gap when the gate was high)
+// Edges more than 2s or less than 10ms apart are a stop/restart or a glitch;
+// they count but are left out of the interval and deviation histograms.
+//
+// Same threading as TraceStats: the audio thread writes, the UI reads and
+// requests resets, which the audio thread carries out in poll().
+
+// Every recorded value is a frame count below 2s: 1.5M frames at 768kHz,
+// under 2^21. Fine buckets up to there, instead of the full 64-bit range,
+// cut each histogram from 3.9 KB to 1.2 KB.
+using ClockHistogram = BasicLogHistogram<4, 21>;
+
+struct ClockStats {
+    ClockHistogram interval;
+    ClockHistogram deviation;
+    ClockHistogram latency;
+    std::atomic<uint64_t> unmeasured{0};  // Edges outside the period range
+    std::atomic<float> sampleRate{44100.f};  // Of the latest edge, for converting to ms
+    std::atomic<bool> resetRequested{false};
+
+    // Audio thread state
+    int64_t lastEdgeFrame = -1;
+    int64_t pendingGateFrame = -1;  // Edge waiting for its gate, -1 if none
+    bool lastGate = false;
+
+    // Audio thread, once per process()
+    void poll() {
+        if (resetRequested.load(std::memory_order_acquire)) {
+            interval.clear();
+            deviation.clear();
+            latency.clear();
+            unmeasured.store(0, std::memory_order_relaxed);
+            lastEdgeFrame = -1;
+            pendingGateFrame = -1;
+            resetRequested.store(false, std::memory_order_release);
+        }
+    }
+
+    // Audio thread: a clock edge at `frame`, before the sequencer updates its
+    // tracked period (so `trackedPeriod` is what this interval is judged by)
+    void onClock(int64_t frame, float trackedPeriod, float sampleRate) {
+        pendingGateFrame = -1;
+        this->sampleRate.store(sampleRate, std::memory_order_relaxed);
+        if (lastEdgeFrame >= 0) {
+            int64_t frames = frame - lastEdgeFrame;
+            float seconds = frames / sampleRate;
+            if (seconds > Sequencer::MIN_CLOCK_PERIOD && seconds < Sequencer::MAX_CLOCK_PERIOD) {
+                interval.record(static_cast<uint64_t>(frames));
+                deviation.record(static_cast<uint64_t>(std::llround(std::fabs(frames - trackedPeriod * sampleRate))));
+            } else {
+                unmeasured.store(unmeasured.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+        lastEdgeFrame = frame;
+    }
+
+    // Audio thread: the step started on this edge fires the gate
+    void onNoteStart(int64_t frame) {
+        pendingGateFrame = frame;
+    }
+
+    // Audio thread: the GATE output value for `frame`
+    void onGate(int64_t frame, bool gate) {
+        if (gate && !lastGate && pendingGateFrame >= 0) {
+            latency.record(static_cast<uint64_t>(frame - pendingGateFrame));
+            pendingGateFrame = -1;
+        }
+        lastGate = gate;
+    }
+
+    // Menu/report lines, in samples
+    std::string intervalLine() const {
+        char line[160];
+        uint64_t n = interval.count();
+        if (n == 0) {
+            return "Interval: no clock yet";
+        }
+        std::snprintf(line, sizeof(line), "Interval: mean %.1f (%.2f ms), min %llu, max %llu, n %llu",
+                      interval.mean(), interval.mean() * 1000.0 / sampleRate.load(std::memory_order_relaxed),
+                      static_cast<unsigned long long>(interval.min.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(interval.max.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(n));
+        return line;
+    }
+
+    static std::string percentileLine(const char* name, const ClockHistogram& h) {
+        if (h.count() == 0) {
+            return std::string(name) + ": -";
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line), "%s: p50 %llu, p90 %llu, p99 %llu, max %llu", name,
+                      static_cast<unsigned long long>(h.percentile(50)),
+                      static_cast<unsigned long long>(h.percentile(90)),
+                      static_cast<unsigned long long>(h.percentile(99)),
+                      static_cast<unsigned long long>(h.max.load(std::memory_order_relaxed)));
+        return line;
+    }
+};
+
+// Three fine histograms, kept to the 21-bit range they can see
+static_assert(sizeof(ClockStats) <= 3592, "ClockStats grew past its 3592-byte budget");
+
+} // namespace AcidGenerator
@@ -0,0 +1,464 @@
+#pragma once
+
+#include "Generator.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// PatternBits - A resolved pattern as 64-bit step masks
+//-----------------------------------------------------------------------------
+// Bit s of each mask is step s. Feature kernels work on whole masks at once
+// (64 steps per AND/popcount) instead of walking SequenceSteps.
+//
+// pitchPlanes hold each step's state as a 5-bit code, one plane per bit:
+// 0 = rest, otherwise octave * 7 + scale degree + PITCH_CODE_OFFSET. Two
+// steps are identical (same note or both rests) when all planes agree.
+
+constexpr int PITCH_PLANES = 5;
+constexpr int PITCH_CODE_OFFSET = 8;  // Lowest pitch (-1 octave, degree 0) -> 1
+
+struct PatternBits {
+    int length = MAX_STEPS;
+    uint64_t rhythm = 0;   // Step plays a note
+    uint64_t accent = 0;
+    uint64_t slide = 0;
+    uint64_t root = 0;     // Note is scale degree 0 (any octave)
+    uint64_t pitchPlanes[PITCH_PLANES] = {};
+    int8_t pitch[MAX_STEPS] = {};  // octave * 7 + degree; only meaningful where rhythm is set
+};
+
+// Hardware popcount where the target has one; otherwise the SWAR bit count
+// (Rack's x64 baseline has no POPCNT, and the libgcc fallback is a call)
+inline int popcount64(uint64_t x) {
+#if defined(__POPCNT__) || defined(__aarch64__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<int>((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+inline uint64_t lengthMask(int length) {
+    return length >= 64 ? ~0ull : (1ull << length) - 1;
+}
+
+// Bit s of the result is bit (s + lag) % length of x (loop-aware shift),
+// for 0 <= lag <= length
+inline uint64_t rotateLoop(uint64_t x, int lag, int length) {
+    if (lag == 0 || lag == length) {
+        return x;
+    }
+    return ((x >> lag) | (x << (length - lag))) & lengthMask(length);
+}
+
+// Same result as calling getStep() for steps 0..length-1, in one branch-free
+// pass over the loop's steps
+inline PatternBits resolveBits(const MasterPattern& pattern, int length, float density, float spread,
+                               float accentsDensity, float slidesDensity) {
+    PatternBits bits;
+    bits.length = std::max(1, std::min(MAX_STEPS, length));
+
+    // Density: the first activeCount bar positions, repeated every bar
+    int activeCount = std::max(0, static_cast<int>(std::round(BAR_LEN * density / 100.0f)));
+    uint64_t barMask = 0;
+    for (int i = 0; i < activeCount && i < BAR_LEN; i++) {
+        barMask |= 1ull << pattern.barActivationOrder[i];
+    }
+    barMask *= 0x0001000100010001ull;
+
+    int spreadCount = std::max(1, static_cast<int>(std::round(SCALE_SIZE * spread / 100.0f)));
+    float accentThreshold = accentsDensity / 100.0f;
+    float slideThreshold = slidesDensity / 100.0f;
+
+    uint64_t muted = 0;
+    uint64_t accent = 0;
+    uint64_t slide = 0;
+    uint64_t root = 0;
+    // Locals, so the byte stores cannot alias `pattern`
+    int8_t pitches[MAX_STEPS];
+    uint8_t codes[MAX_STEPS] = {};
+    for (int s = 0; s < bits.length; s++) {
+        const MasterStep& ms = pattern.steps[s];
+        muted |= static_cast<uint64_t>(pattern.muted[s]) << s;
+        accent |= static_cast<uint64_t>(ms.accentProb < accentThreshold) << s;
+        slide |= static_cast<uint64_t>(ms.slideProb < slideThreshold) << s;
+
+        // Out-of-pool notes quantize to the root, as getStep() does
+        int degree = pattern.scalePriorityOrder[ms.notePoolIndex < spreadCount ? ms.notePoolIndex : 0];
+        int pitch = ms.octave * SCALE_SIZE + degree;
+        pitches[s] = static_cast<int8_t>(pitch);
+        root |= static_cast<uint64_t>(degree == 0) << s;
+        codes[s] = static_cast<uint8_t>(pitch + PITCH_CODE_OFFSET);
+    }
+    std::memcpy(bits.pitch, pitches, bits.length);
+
+    // Transpose the codes into planes 8 steps at a time (little-endian loads):
+    // the multiply gathers bit 0 of each byte into the top byte, with no
+    // carries between terms
+    uint64_t planes[PITCH_PLANES] = {};
+    for (int chunk = 0; chunk * 8 < bits.length; chunk++) {
+        uint64_t x;
+        std::memcpy(&x, codes + chunk * 8, 8);
+        for (int k = 0; k < PITCH_PLANES; k++) {
+            uint64_t gathered = (((x >> k) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56;
+            planes[k] |= gathered << (chunk * 8);
+        }
+    }
+
+    // Rests clear every lane, so they compare equal to each other only
+    bits.rhythm = barMask & ~muted & lengthMask(bits.length);
+    bits.accent = accent & bits.rhythm;
+    bits.slide = slide & bits.rhythm;
+    bits.root = root & bits.rhythm;
+    for (int k = 0; k < PITCH_PLANES; k++) {
+        bits.pitchPlanes[k] = planes[k] & bits.rhythm;
+    }
+    return bits;
+}
+
+//-----------------------------------------------------------------------------
+// KnobSweep - One master resolved at every DENSITY x SPREAD level
+//-----------------------------------------------------------------------------
+// getStep() only sees DENSITY as a count of bar positions (0-16) and SPREAD
+// as a count of pool entries (1-7), so the two knobs have 17 x 7 distinct
+// settings. Both orders nest: each density level adds one bar position to
+// the one below, and each spread level moves the steps of one more pool
+// index off the root and onto their own degree. sweepDensitySpread() walks
+// the steps once, as resolveBits() does, and derives every level from the
+// resulting masks; cells[][] summarizes each setting (for heatmaps and for
+// scoring a seed at every knob position) and bits() rebuilds any one of
+// them exactly as resolveBits() would.
+
+constexpr int DENSITY_LEVELS = BAR_LEN + 1;  // 0-16 active bar positions
+constexpr int SPREAD_LEVELS = SCALE_SIZE;    // 1-7 pool entries; level = count - 1
+
+// Level a knob value resolves to, with getStep()'s rounding
+inline int densityLevel(float density) {
+    return std::min(BAR_LEN, std::max(0, static_cast<int>(std::round(BAR_LEN * density / 100.0f))));
+}
+
+inline int spreadLevel(float spread) {
+    return std::min(SCALE_SIZE, std::max(1, static_cast<int>(std::round(SCALE_SIZE * spread / 100.0f)))) - 1;
+}
+
+// A knob value that resolves to the level
+inline float densityForLevel(int level) {
+    return level * 100.0f / BAR_LEN;
+}
+
+inline float spreadForLevel(int level) {
+    return (level + 1) * 100.0f / SCALE_SIZE;
+}
+
+// Counts over the loop at one DENSITY/SPREAD setting
+struct SweepCell {
+    uint8_t notes = 0;
+    uint8_t accents = 0;
+    uint8_t slides = 0;
+    uint8_t roots = 0;    // Notes on scale degree 0
+    uint8_t degrees = 0;  // Distinct pool entries played
+    int8_t low = 0;       // Lowest and highest note as octave * 7 + degree
+    int8_t high = 0;      // (both 0 without notes)
+};
+
+struct KnobSweep {
+    int length = MAX_STEPS;
+    uint64_t rhythm[DENSITY_LEVELS] = {};   // Steps that play, per density level (mutes applied)
+    uint64_t inPool[SPREAD_LEVELS] = {};    // Steps on their own degree, per spread level
+    uint64_t poolSteps[SCALE_SIZE] = {};    // Steps by notePoolIndex
+    uint64_t accent = 0;                    // Accent/slide before the rhythm is applied
+    uint64_t slide = 0;
+    // Every step both ways, on its own degree (own) and quantized to the
+    // root (root), whether or not it plays
+    uint64_t ownRoot = 0;
+    uint64_t rootRoot = 0;
+    uint64_t ownPlanes[PITCH_PLANES] = {};
+    uint64_t rootPlanes[PITCH_PLANES] = {};
+    int8_t ownPitch[MAX_STEPS] = {};
+    int8_t rootPitch[MAX_STEPS] = {};
+    SweepCell cells[DENSITY_LEVELS][SPREAD_LEVELS];
+
+    // Same PatternBits as resolveBits() at any knob values on these levels
+    PatternBits bits(int density, int spread) const {
+        PatternBits b;
+        b.length = length;
+        const uint64_t pool = inPool[spread];
+        const uint64_t r = rhythm[density];
+        b.rhythm = r;
+        b.accent = accent & r;
+        b.slide = slide & r;
+        b.root = ((ownRoot & pool) | (rootRoot & ~pool)) & r;
+        for (int k = 0; k < PITCH_PLANES; k++) {
+            b.pitchPlanes[k] = ((ownPlanes[k] & pool) | (rootPlanes[k] & ~pool)) & r;
+        }
+        for (int s = 0; s < length; s++) {
+            b.pitch[s] = ((pool >> s) & 1) ? ownPitch[s] : rootPitch[s];
+        }
+        return b;
+    }
+};
+
+inline void sweepDensitySpread(const MasterPattern& pattern, int length, float accentsDensity,
+                               float slidesDensity, KnobSweep& out) {
+    out.length = std::max(1, std::min(MAX_STEPS, length));
+    const uint64_t len = lengthMask(out.length);
+    const float accentThreshold = accentsDensity / 100.0f;
+    const float slideThreshold = slidesDensity / 100.0f;
+    const int rootDegree = pattern.scalePriorityOrder[0];
+
+    // The single pass over the steps: every per-step fact any level needs
+    uint64_t muted = 0;
+    uint64_t accent = 0;
+    uint64_t slide = 0;
+    uint64_t ownRoot = 0;
+    uint64_t poolSteps[SCALE_SIZE] = {};
+    uint8_t ownCodes[MAX_STEPS] = {};
+    uint8_t rootCodes[MAX_STEPS] = {};
+    for (int s = 0; s < out.length; s++) {
+        const MasterStep& ms = pattern.steps[s];
+        muted |= static_cast<uint64_t>(pattern.muted[s]) << s;
+        accent |= static_cast<uint64_t>(ms.accentProb < accentThreshold) << s;
+        slide |= static_cast<uint64_t>(ms.slideProb < slideThreshold) << s;
+        poolSteps[ms.notePoolIndex] |= 1ull << s;
+
+        int degree = pattern.scalePriorityOrder[ms.notePoolIndex];
+        int own = ms.octave * SCALE_SIZE + degree;
+        int root = ms.octave * SCALE_SIZE + rootDegree;
+        out.ownPitch[s] = static_cast<int8_t>(own);
+        out.rootPitch[s] = static_cast<int8_t>(root);
+        ownRoot |= static_cast<uint64_t>(degree == 0) << s;
+        ownCodes[s] = static_cast<uint8_t>(own + PITCH_CODE_OFFSET);
+        rootCodes[s] = static_cast<uint8_t>(root + PITCH_CODE_OFFSET);
+    }
+    out.accent = accent;
+    out.slide = slide;
+    out.ownRoot = ownRoot;
+    out.rootRoot = rootDegree == 0 ? len : 0;
+
+    // Code planes, as in resolveBits()
+    for (int k = 0; k < PITCH_PLANES; k++) {
+        out.ownPlanes[k] = 0;
+        out.rootPlanes[k] = 0;
+    }
+    for (int chunk = 0; chunk * 8 < out.length; chunk++) {
+        uint64_t own, root;
+        std::memcpy(&own, ownCodes + chunk * 8, 8);
+        std::memcpy(&root, rootCodes + chunk * 8, 8);
+        for (int k = 0; k < PITCH_PLANES; k++) {
+            out.ownPlanes[k] |= ((((own >> k) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56) << (chunk * 8);
+            out.rootPlanes[k] |= ((((root >> k) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56) << (chunk * 8);
+        }
+    }
+
+    // Nested levels: one more bar position, one more pool index
+    uint64_t barMask = 0;
+    out.rhythm[0] = 0;
+    for (int d = 1; d < DENSITY_LEVELS; d++) {
+        barMask |= 1ull << pattern.barActivationOrder[d - 1];
+        out.rhythm[d] = barMask * 0x0001000100010001ull & ~muted & len;
+    }
+    uint64_t pool = 0;
+    for (int c = 0; c < SPREAD_LEVELS; c++) {
+        out.poolSteps[c] = poolSteps[c];
+        pool |= poolSteps[c];
+        out.inPool[c] = pool;
+    }
+
+    // The cells, with no per-cell popcounts: density levels only add steps,
+    // so per-pool-index tallies of the playing steps grow one bar position at
+    // a time, and each spread level splits them into in-pool indices (own
+    // degree) and the ones above (quantized to the root)
+    const bool rootIsDegree0 = rootDegree == 0;
+    int count[SCALE_SIZE] = {};     // Playing steps per pool index
+    int ownRoots[SCALE_SIZE] = {};  // ... whose own degree is 0
+    int ownLow[SCALE_SIZE], ownHigh[SCALE_SIZE], rootLow[SCALE_SIZE], rootHigh[SCALE_SIZE];
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        ownLow[i] = rootLow[i] = INT8_MAX;
+        ownHigh[i] = rootHigh[i] = INT8_MIN;
+    }
+    SweepCell row;
+
+    for (int d = 0; d < DENSITY_LEVELS; d++) {
+        for (uint64_t m = d > 0 ? out.rhythm[d] & ~out.rhythm[d - 1] : 0; m; m &= m - 1) {
+            int st = __builtin_ctzll(m);
+            int i = pattern.steps[st].notePoolIndex;
+            count[i]++;
+            ownRoots[i] += (ownRoot >> st) & 1;
+            row.notes++;
+            row.accents += (accent >> st) & 1;
+            row.slides += (slide >> st) & 1;
+            ownLow[i] = std::min(ownLow[i], static_cast<int>(out.ownPitch[st]));
+            ownHigh[i] = std::max(ownHigh[i], static_cast<int>(out.ownPitch[st]));
+            rootLow[i] = std::min(rootLow[i], static_cast<int>(out.rootPitch[st]));
+            rootHigh[i] = std::max(rootHigh[i], static_cast<int>(out.rootPitch[st]));
+        }
+
+        // Outside the pool at level c means index above c: suffix tallies
+        int outCount[SPREAD_LEVELS + 1], outLow[SPREAD_LEVELS + 1], outHigh[SPREAD_LEVELS + 1];
+        outCount[SPREAD_LEVELS] = 0;
+        outLow[SPREAD_LEVELS] = INT8_MAX;
+        outHigh[SPREAD_LEVELS] = INT8_MIN;
+        for (int i = SPREAD_LEVELS - 1; i >= 0; i--) {
+            outCount[i] = outCount[i + 1] + count[i];
+            outLow[i] = std::min(outLow[i + 1], rootLow[i]);
+            outHigh[i] = std::max(outHigh[i + 1], rootHigh[i]);
+        }
+
+        // Pool indices 1+ each add a degree once their steps play; index 0
+        // shares the root degree with every step still outside the pool
+        int higher = 0;
+        int inRoots = 0;
+        int inLow = INT8_MAX, inHigh = INT8_MIN;
+        for (int c = 0; c < SPREAD_LEVELS; c++) {
+            higher += c > 0 && count[c] > 0;
+            inRoots += ownRoots[c];
+            inLow = std::min(inLow, ownLow[c]);
+            inHigh = std::max(inHigh, ownHigh[c]);
+            SweepCell& cell = out.cells[d][c];
+            cell = row;
+            cell.roots = static_cast<uint8_t>(inRoots + (rootIsDegree0 ? outCount[c + 1] : 0));
+            cell.degrees = static_cast<uint8_t>(higher + (count[0] > 0 || outCount[c + 1] > 0));
+            if (row.notes) {
+                cell.low = static_cast<int8_t>(std::min(inLow, outLow[c + 1]));
+                cell.high = static_cast<int8_t>(std::max(inHigh, outHigh[c + 1]));
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// PatternFeatures - Descriptors for filtering, sorting and corpus statistics
+//-----------------------------------------------------------------------------
+// Counts are over the loop (steps 0..length-1). Consecutive-note measures
+// treat the loop as cyclic: the last note leads back into the first.
+
+// |interval| bins, in scale steps: 0 | 1 | 2 | 3-4 | 5-6 | 7+ (octave or more)
+constexpr int INTERVAL_BINS = 6;
+
+struct PatternFeatures {
+    uint8_t length = 0;
+    uint8_t noteCount = 0;
+    uint8_t accentCount = 0;
+    uint8_t slideCount = 0;
+    uint8_t accentsOnBeat = 0;        // Accents on quarter-note steps
+    uint8_t slidesOnBeat = 0;
+    uint8_t downbeats = 0;            // Notes on quarter-note steps
+    uint8_t downbeatRoots = 0;        // ... that are the root
+    uint8_t syncopation = 0;          // Metrical weight of notes that anticipate a stronger rest
+    uint8_t octaveJumps = 0;          // Consecutive notes in different octaves
+    uint8_t intervals[INTERVAL_BINS] = {};
+    uint8_t repeatsBeat = 0;          // Steps identical to the step one beat (4 steps) later
+    uint8_t repeatsHalf = 0;          // Steps identical to the step half a loop later
+
+    float downbeatRootRatio() const {
+        return downbeats ? static_cast<float>(downbeatRoots) / downbeats : 0.f;
+    }
+    float octaveJumpRate() const {
+        return noteCount > 1 ? static_cast<float>(octaveJumps) / noteCount : 0.f;
+    }
+    float repetition() const {
+        return length ? static_cast<float>(repeatsHalf) / length : 0.f;
+    }
+};
+
+// Metrical strength of a step in a 16-step bar: bar 4, half 3, beat 2, 8th 1, 16th 0
+constexpr int metricalStrength(int step) {
+    int s = step % BAR_LEN;
+    if (s == 0) return 4;
+    if (s % 8 == 0) return 3;
+    if (s % 4 == 0) return 2;
+    if (s % 2 == 0) return 1;
+    return 0;
+}
+
+// Steps whose successor is `diff` levels stronger, within one 64-step pass
+constexpr uint64_t syncopationMask(int diff) {
+    uint64_t mask = 0;
+    for (int s = 0; s + 1 < MAX_STEPS; s++) {
+        if (metricalStrength(s + 1) - metricalStrength(s) == diff) {
+            mask |= 1ull << s;
+        }
+    }
+    return mask;
+}
+
+inline PatternFeatures computeFeatures(const PatternBits& bits) {
+    static constexpr uint64_t SYNC[5] = {0, syncopationMask(1), syncopationMask(2), syncopationMask(3),
+                                         syncopationMask(4)};
+    constexpr uint64_t BEATS = 0x1111111111111111ull;  // Every 4th step
+
+    PatternFeatures f;
+    const int length = bits.length;
+    const uint64_t len = lengthMask(length);
+    f.length = static_cast<uint8_t>(length);
+    f.noteCount = static_cast<uint8_t>(popcount64(bits.rhythm));
+    f.accentCount = static_cast<uint8_t>(popcount64(bits.accent));
+    f.slideCount = static_cast<uint8_t>(popcount64(bits.slide));
+    f.accentsOnBeat = static_cast<uint8_t>(popcount64(bits.accent & BEATS));
+    f.slidesOnBeat = static_cast<uint8_t>(popcount64(bits.slide & BEATS));
+    f.downbeats = static_cast<uint8_t>(popcount64(bits.rhythm & BEATS));
+    f.downbeatRoots = static_cast<uint8_t>(popcount64(bits.rhythm & bits.root & BEATS));
+
+    // Syncopation: a note followed by a rest on a stronger step scores the
+    // strength difference. The last step's successor is step 0 (strength 4).
+    uint64_t anticipations = bits.rhythm & ~rotateLoop(bits.rhythm, 1, length) & len;
+    uint64_t last = 1ull << (length - 1);
+    int score = 0;
+    for (int d = 1; d <= 4; d++) {
+        score += d * popcount64(anticipations & SYNC[d] & ~last);
+    }
+    if (anticipations & last) {
+        score += 4 - metricalStrength(length - 1);
+    }
+    f.syncopation = static_cast<uint8_t>(std::min(score, 255));
+
+    // Steps equal to their successor `lag` steps on: every pitch plane agrees
+    auto repeats = [&](int lag) {
+        uint64_t differ = 0;
+        for (int k = 0; k < PITCH_PLANES; k++) {
+            differ |= bits.pitchPlanes[k] ^ rotateLoop(bits.pitchPlanes[k], lag, length);
+        }
+        return static_cast<uint8_t>(popcount64(~differ & len));
+    };
+    f.repeatsBeat = length > 4 ? repeats(4) : 0;
+    f.repeatsHalf = length >= 2 ? repeats(length / 2) : 0;
+
+    // Consecutive-note measures walk the set bits only. The histogram is
+    // kept as 8-bit lanes of one register (at most 64 notes per bin).
+    if (f.noteCount >= 2) {
+        uint64_t histogram = 0;
+        int jumps = 0;
+        int prev = bits.pitch[63 - __builtin_clzll(bits.rhythm)];  // Last note leads into the first
+        for (uint64_t m = bits.rhythm; m; m &= m - 1) {
+            int pitch = bits.pitch[__builtin_ctzll(m)];
+            int interval = std::abs(pitch - prev);
+            int bin = (0x54433210 >> (4 * std::min(interval, 7))) & 0xf;  // 0 1 2 3 3 4 4 5
+            histogram += 1ull << (8 * bin);
+            // pitch + 7 is non-negative, so division gives the octave
+            jumps += (pitch + SCALE_SIZE) / SCALE_SIZE != (prev + SCALE_SIZE) / SCALE_SIZE;
+            prev = pitch;
+        }
+        for (int i = 0; i < INTERVAL_BINS; i++) {
+            f.intervals[i] = static_cast<uint8_t>(histogram >> (8 * i));
+        }
+        f.octaveJumps = static_cast<uint8_t>(jumps);
+    }
+    return f;
+}
+
+// Batch entry point: features of `count` patterns at one knob setting
+inline void extractFeatures(const MasterPattern* patterns, size_t count, int length, float density, float spread,
+                            float accentsDensity, float slidesDensity, PatternFeatures* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = computeFeatures(resolveBits(patterns[i], length, density, spread, accentsDensity, slidesDensity));
+    }
+}
+
+} // namespace AcidGenerator
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Sequencer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// FixedSequencer - Integer build of the step engine (FPU-less targets)
+//-----------------------------------------------------------------------------
+// Drop-in replacement for Sequencer, selected with `make FIXED=1`
+// (-DACIDSEQ_FIXED_POINT). Per-sample work is integer only:
+//
+//   time         whole frames, in the same StepTimer Sequencer runs
+//   pitch        Q16 semitones; slides interpolate exactly from start to target
+//   accent sweep Q30 one-pole
+//   step lookup  density/spread as counts, accent/slide as threshold compares
+//
+// Float remains where values enter and leave the engine: knob values are
+// turned into FixedParams when they change, coefficients are computed in
+// setSampleRate(), a MIDI clock period override is converted once per step,
+// and process() writes pitch and sweep as float. Gate, accent and slide
+// match Sequencer exactly and pitch to one LSB of a 16-bit pitch DAC
+// (checked in acidseq-test).
+
+// Step resolution settings, converted from SequencerParams when a knob moves
+struct FixedParams {
+    int activeCount = 0;          // Bar positions playing (DENSITY)
+    int spreadCount = 1;          // Pool entries in use (SPREAD)
+    int32_t accentThreshold = 0;  // Bits of ACCENT / 100; a step accents when its probability's bits are lower
+    int32_t slideThreshold = 0;   // Same for SLIDE
+
+    // Non-negative floats order like their bit patterns, so comparing bits
+    // gives the same answer as MasterPattern::getStep's float compare
+    static int32_t probBits(float f) {
+        int32_t bits;
+        std::memcpy(&bits, &f, 4);
+        return bits;
+    }
+
+    static int32_t thresholdBits(float density) {
+        float t = density / 100.0f;
+        return t > 0.f ? probBits(t) : 0;
+    }
+
+    void set(const SequencerParams& p) {
+        activeCount = std::min(BAR_LEN, std::max(0, static_cast<int>(std::round(BAR_LEN * p.density / 100.0f))));
+        spreadCount = std::max(1, static_cast<int>(std::round(SCALE_SIZE * p.spread / 100.0f)));
+        accentThreshold = thresholdBits(p.accentDensity);
+        slideThreshold = thresholdBits(p.slideDensity);
+    }
+
+    // Integer MasterPattern::getStep (quantizing to the pool)
+    SequenceStep step(const MasterPattern& pattern, int step) const {
+        if (pattern.muted[step]) {
+            return {-1, 0, false, false};
+        }
+        int barPos = step % BAR_LEN;
+        bool active = false;
+        for (int i = 0; i < activeCount; i++) {
+            if (pattern.barActivationOrder[i] == barPos) {
+                active = true;
+                break;
+            }
+        }
+        if (!active) {
+            return {-1, 0, false, false};
+        }
+        const MasterStep& ms = pattern.steps[step];
+        return {
+            pattern.scalePriorityOrder[ms.notePoolIndex < spreadCount ? ms.notePoolIndex : 0],
+            ms.octave,
+            probBits(ms.accentProb) < accentThreshold,
+            probBits(ms.slideProb) < slideThreshold
+        };
+    }
+};
+
+struct FixedSequencer {
+    static constexpr float RETRIGGER_GAP_TIME = StepTimer::RETRIGGER_GAP_TIME;
+    static constexpr float SLIDE_TIME = StepTimer::SLIDE_TIME;
+    static constexpr float MIN_CLOCK_PERIOD = StepTimer::MIN_CLOCK_PERIOD;
+    static constexpr float MAX_CLOCK_PERIOD = StepTimer::MAX_CLOCK_PERIOD;
+
+    static constexpr int32_t SEMITONE = 1 << 16;            // Q16 pitch
+    static constexpr float PITCH_SCALE = 12.f * SEMITONE;   // Q16 semitones per volt
+    static constexpr int SWEEP_BITS = 30;
+    static constexpr int32_t SWEEP_ONE = 1 << SWEEP_BITS;   // Q30 sweep
+
+    int currentStep = -1;  // -1 means not started yet
+    uint32_t loop = 0;     // Loops completed since the last reset (chance rolls)
+
+    // Slide state (Q16 semitones)
+    bool currentSlideActive = false;  // Is current step sliding INTO next?
+    bool stepDropped = false;         // Current step lost its chance roll
+    int32_t currentPitch = 0;
+    int32_t slideStart = 0;
+    int32_t slideTarget = 0;
+
+    StepTimer timer;    // Clock period, pulses and slide progress in frames
+    int32_t sweep = 0;  // Accent sweep charge, Q30
+    bool slideOut = false;
+
+    int32_t chargeCoef = 0;  // Q30 AccentSweep coefficients
+    int32_t decayCoef = 0;
+
+    // Knob values the cached FixedParams were built from (as bits)
+    uint32_t paramsKey[4] = {0, 0, 0, 0};
+    bool paramsValid = false;
+    FixedParams fixed;
+
+    FixedSequencer() {
+        setSampleRate(44100.f);
+    }
+
+    void setSampleRate(float sr) {
+        timer.setSampleRate(sr);
+
+        // Same float coefficients as AccentSweep, then to Q30
+        AccentSweep reference;
+        reference.setSampleRate(sr);
+        chargeCoef = static_cast<int32_t>(std::lround(static_cast<double>(reference.chargeCoef) * SWEEP_ONE));
+        decayCoef = static_cast<int32_t>(std::lround(static_cast<double>(reference.decayCoef) * SWEEP_ONE));
+    }
+
+    // Next clock plays step 0
+    void reset() {
+        currentStep = -1;
+        loop = 0;
+        currentSlideActive = false;
+        stepDropped = false;
+        timer.retriggerGapFrames = 0;
+    }
+
+    float clockPeriod() const {
+        return timer.clockPeriod();
+    }
+
+    float timeSinceClock() const {
+        return timer.timeSinceClock();
+    }
+
+    SlideState slideState() const {
+        SlideState s;
+        s.active = currentSlideActive;
+        s.pitch = currentPitch / PITCH_SCALE;
+        s.target = slideTarget / PITCH_SCALE;
+        s.rate = timer.slideSpan > 0
+                     ? (slideTarget - slideStart) / PITCH_SCALE * StepTimer::SLIDE_SUBSTEPS / timer.slideSpan
+                     : 0.f;
+        return s;
+    }
+
+    void setSlideState(const SlideState& s) {
+        currentSlideActive = s.active;
+        currentPitch = static_cast<int32_t>(std::lround(s.pitch * PITCH_SCALE));
+        slideTarget = static_cast<int32_t>(std::lround(s.target * PITCH_SCALE));
+        slideStart = currentPitch;
+        timer.resumeSlide(s.rate != 0.f && slideTarget != currentPitch ? std::fabs((s.target - s.pitch) / s.rate) : 0.);
+    }
+
+    const FixedParams& params(const SequencerParams& p) {
+        uint32_t key[4];
+        std::memcpy(&key[0], &p.density, 4);
+        std::memcpy(&key[1], &p.spread, 4);
+        std::memcpy(&key[2], &p.accentDensity, 4);
+        std::memcpy(&key[3], &p.slideDensity, 4);
+        if (!paramsValid || std::memcmp(key, paramsKey, sizeof(key)) != 0) {
+            std::memcpy(paramsKey, key, sizeof(key));
+            fixed.set(p);
+            paramsValid = true;
+        }
+        return fixed;
+    }
+
+    // Clock edge: measure the period and move to the next step.
+    // A positive periodOverride replaces the measurement (MIDI clock PLL).
+    int advance(int patternLength, float periodOverride = 0.f) {
+        timer.clockEdge(periodOverride);
+
+        currentStep++;
+        if (currentStep >= patternLength) {
+            currentStep = 0;
+            loop++;
+        }
+        return currentStep;
+    }
+
+    // Start the current step: set pitch/slide and fire the gate and accent
+    StepEvent playStep(const MasterPattern& pattern, const SequencerParams& p, float /*sampleRate*/,
+                       const ChanceLane* chance = nullptr) {
+        StepEvent ev;
+        const FixedParams& fp = params(p);
+        int amount = chanceAmountFor(p.chanceAmount);
+
+        SequenceStep step = fp.step(pattern, currentStep);
+        stepDropped = !step.isRest() && chance && !chance->plays(currentStep, loop, amount);
+        if (step.isRest() || stepDropped) {
+            currentSlideActive = false;
+            return ev;
+        }
+
+        int midiNote = getNoteInScale(step.note, p.scale, p.rootNote, step.octave + p.octaveOffset);
+        int32_t pitch = midiNote * SEMITONE;
+
+        int prevStep = (currentStep - 1 + p.patternLength) % p.patternLength;
+        SequenceStep prevStepData = fp.step(pattern, prevStep);
+        bool slideFromPrev = !prevStepData.isRest() && prevStepData.slide &&
+                             !(chance && !chance->plays(prevStep, prevLoop(), amount));
+
+        if (slideFromPrev) {
+            slideStart = currentPitch;
+            slideTarget = pitch;
+            timer.startSlide(pitch != currentPitch);
+            if (step.slide) {
+                timer.tie();
+            }
+        } else {
+            currentPitch = pitch;
+            slideTarget = pitch;
+            timer.startSlide(false);
+            timer.attack(step.slide, step.accent);
+        }
+
+        currentSlideActive = step.slide;
+
+        ev.note = true;
+        ev.midiNote = midiNote;
+        ev.accent = step.accent;
+        ev.legato = slideFromPrev;
+        return ev;
+    }
+
+    // Advance one sample and compute the outputs
+    SequencerOutputs process(float /*sampleTime*/, const MasterPattern& pattern, const SequencerParams& p) {
+        SequencerOutputs out;
+
+        if (timer.slideSpan > 0) {
+            if (timer.slideFrame()) {
+                currentPitch = slideStart + static_cast<int32_t>(
+                    static_cast<int64_t>(slideTarget - slideStart) * timer.slidePos / timer.slideSpan);
+            } else {
+                currentPitch = slideTarget;
+            }
+        }
+        out.pitch = currentPitch / PITCH_SCALE;
+
+        timer.process(out);
+        if (out.accent) {
+            sweep = SWEEP_ONE - static_cast<int32_t>((static_cast<int64_t>(SWEEP_ONE - sweep) * chargeCoef) >> SWEEP_BITS);
+        } else {
+            sweep = static_cast<int32_t>((static_cast<int64_t>(sweep) * decayCoef) >> SWEEP_BITS);
+        }
+        out.accentSweep = sweep * (1.f / SWEEP_ONE);
+
+        if (currentStep >= 0 && currentStep < p.patternLength) {
+            slideOut = !stepDropped && params(p).step(pattern, currentStep).slide;
+        }
+        out.slide = slideOut;
+
+        return out;
+    }
+
+    // Loop the previous step was rolled on (the one before at step 0)
+    uint32_t prevLoop() const {
+        return currentStep == 0 ? loop - 1 : loop;
+    }
+};
+
+// 132 bytes, 56 of them the frame timer
+static_assert(sizeof(FixedSequencer) <= 132, "FixedSequencer grew past its 132-byte budget");
+
+} // namespace AcidGenerator
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Footprint - Bytes held by one module instance
+//-----------------------------------------------------------------------------
+// Filled by AcidSeq::footprint() for acidseq-bench --memory and the "Memory"
+// context submenu of TRACE=1 builds. Parts are either inside the module object (a
+// breakdown of sizeof, not added to the total) or on the heap (added).
+// Heap parts count what the module and Rack's Module base allocate for it;
+// allocations inside Rack types (MIDI queues, param quantity strings) are
+// not visible from here.
+
+struct Footprint {
+    struct Part {
+        const char* name;
+        size_t bytes;
+        bool heap;
+    };
+
+    static constexpr int MAX_PARTS = 12;
+    Part parts[MAX_PARTS];
+    int count = 0;
+    size_t object = 0;  // sizeof the module
+
+    void add(const char* name, size_t bytes, bool heap) {
+        if (count < MAX_PARTS) {
+            parts[count++] = {name, bytes, heap};
+        }
+    }
+
+    size_t heap() const {
+        size_t total = 0;
+        for (int i = 0; i < count; i++) {
+            if (parts[i].heap) {
+                total += parts[i].bytes;
+            }
+        }
+        return total;
+    }
+
+    size_t total() const {
+        return object + heap();
+    }
+
+    static std::string kb(size_t bytes) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+        return text;
+    }
+
+    // Menu/report line for a part
+    static std::string line(const Part& part) {
+        return std::string(part.heap ? "Heap: " : "  ") + part.name + ": " + kb(part.bytes);
+    }
+};
+
+} // namespace AcidGenerator
@@ -64,7 +64,10 @@ struct SFC32 {
         c = c + t;
 
         // return (t >>> 0) / 4294967296;
-        return static_cast<float>(t) / 4294967296.0f;
+        // In float, t >= 2^32 - 128 rounds up to 1.0f, which JS (double) never
+        // returns; pin those draws to the largest float below 1 so the range
+        // stays [0, 1) and randomInt() can't overshoot max
+        return std::min(static_cast<float>(t) / 4294967296.0f, 0x1.fffffep-1f);
     }
 
     // Convenience: random int in [min, max] inclusive
@@ -74,9 +77,51 @@ struct SFC32 {
 };
 
 //-----------------------------------------------------------------------------
-// Scale Definitions
+// Scale Registry
 //-----------------------------------------------------------------------------
+// One entry per scale, in SCALE knob order (saved patches store the index, so
+// append new scales at the end). Everything else about a scale - the SCALE
+// menu, the info display abbreviation, pitch lookup - is derived from here,
+// so adding a scale means adding one entry.
+
+struct ScaleDef {
+    const char* name;    // Context menu
+    const char* abbrev;  // Info display (3 characters or fewer)
+    int length;
+    int intervals[12];   // Semitones above the root, ascending
+};
+
+inline constexpr ScaleDef SCALE_REGISTRY[] = {
+    {"Major",             "MAJ", 7, {0, 2, 4, 5, 7, 9, 11}},
+    {"Minor",             "MIN", 7, {0, 2, 3, 5, 7, 8, 10}},
+    {"Dorian",            "DOR", 7, {0, 2, 3, 5, 7, 9, 10}},
+    {"Mixolydian",        "MIX", 7, {0, 2, 4, 5, 7, 9, 10}},
+    {"Lydian",            "LYD", 7, {0, 2, 4, 6, 7, 9, 11}},
+    {"Phrygian",          "PHR", 7, {0, 1, 3, 5, 7, 8, 10}},
+    {"Locrian",           "LOC", 7, {0, 1, 3, 5, 6, 8, 10}},
+    {"Harmonic Minor",    "H-m", 7, {0, 2, 3, 5, 7, 8, 11}},
+    {"Harmonic Major",    "H-M", 7, {0, 2, 4, 5, 7, 8, 11}},
+    {"Dorian #4",         "D#4", 7, {0, 2, 3, 6, 7, 9, 10}},
+    {"Phrygian Dominant", "PhD", 7, {0, 1, 4, 5, 7, 8, 10}},
+    {"Melodic Minor",     "Mm",  7, {0, 2, 3, 5, 7, 9, 11}},
+    {"Lydian Augmented",  "L+",  7, {0, 2, 4, 6, 8, 9, 11}},
+    {"Lydian Dominant",   "LD",  7, {0, 2, 4, 6, 7, 9, 10}},
+    {"Hungarian Minor",   "HUN", 7, {0, 2, 3, 6, 7, 8, 11}},
+    {"Super Locrian",     "SuL", 7, {0, 1, 3, 4, 6, 8, 10}},
+    {"Spanish",           "SPA", 7, {0, 1, 4, 5, 7, 9, 10}},
+    {"Bhairav",           "BHV", 7, {0, 1, 4, 5, 7, 8, 11}},
+    {"Pentatonic Minor",  "Pm",  5, {0, 3, 5, 7, 10}},
+    {"Pentatonic Major",  "PM",  5, {0, 2, 4, 7, 9}},
+    {"Blues Minor",       "BLU", 6, {0, 3, 5, 6, 7, 10}},
+    {"Whole Tone",        "WHL", 6, {0, 2, 4, 6, 8, 10}},
+    {"Chromatic",         "CHR", 12, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    {"Japanese In-Sen",   "INS", 5, {0, 1, 5, 7, 10}},
+};
+
+constexpr int NUM_SCALES = sizeof(SCALE_REGISTRY) / sizeof(SCALE_REGISTRY[0]);
 
+// Named indices into SCALE_REGISTRY, for code that refers to a scale by name.
+// A scale needs no name here to be usable.
 enum class Scale {
     MAJOR,
     MINOR,
@@ -102,83 +147,74 @@ enum class Scale {
     WHOLE_TONE,
     CHROMATIC,
     JAPANESE_IN_SEN,
-    NUM_SCALES
 };
 
-// Scale intervals stored as fixed arrays
-// Max scale length is 12 (chromatic), use -1 as terminator
-struct ScaleData {
-    int intervals[12];
+inline constexpr const char* NOTE_NAMES[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+//-----------------------------------------------------------------------------
+// Scale tables - Derived from the registry at compile time
+//-----------------------------------------------------------------------------
+// Read-only and shared by every instance, widget and tool. DEGREE_SPAN
+// covers every degree the generator and recorder produce; getNoteInScale
+// falls back to arithmetic above it.
+
+constexpr int DEGREE_SPAN = 16;
+
+struct ScaleTable {
     int length;
+    uint16_t mask;                  // Bit n set when n semitones above the root is in the scale
+    int semitone[DEGREE_SPAN];      // Degree -> semitones above the root, wrapping into higher octaves
 };
 
-// Compile-time scale definitions - no heap allocation
-inline const ScaleData SCALES[] = {
-    // MAJOR
-    {{0, 2, 4, 5, 7, 9, 11, -1, -1, -1, -1, -1}, 7},
-    // MINOR
-    {{0, 2, 3, 5, 7, 8, 10, -1, -1, -1, -1, -1}, 7},
-    // DORIAN
-    {{0, 2, 3, 5, 7, 9, 10, -1, -1, -1, -1, -1}, 7},
-    // MIXOLYDIAN
-    {{0, 2, 4, 5, 7, 9, 10, -1, -1, -1, -1, -1}, 7},
-    // LYDIAN
-    {{0, 2, 4, 6, 7, 9, 11, -1, -1, -1, -1, -1}, 7},
-    // PHRYGIAN
-    {{0, 1, 3, 5, 7, 8, 10, -1, -1, -1, -1, -1}, 7},
-    // LOCRIAN
-    {{0, 1, 3, 5, 6, 8, 10, -1, -1, -1, -1, -1}, 7},
-    // HARMONIC_MINOR
-    {{0, 2, 3, 5, 7, 8, 11, -1, -1, -1, -1, -1}, 7},
-    // HARMONIC_MAJOR
-    {{0, 2, 4, 5, 7, 8, 11, -1, -1, -1, -1, -1}, 7},
-    // DORIAN_NR_4
-    {{0, 2, 3, 6, 7, 9, 10, -1, -1, -1, -1, -1}, 7},
-    // PHRYGIAN_DOMINANT
-    {{0, 1, 4, 5, 7, 8, 10, -1, -1, -1, -1, -1}, 7},
-    // MELODIC_MINOR
-    {{0, 2, 3, 5, 7, 9, 11, -1, -1, -1, -1, -1}, 7},
-    // LYDIAN_AUGMENTED
-    {{0, 2, 4, 6, 8, 9, 11, -1, -1, -1, -1, -1}, 7},
-    // LYDIAN_DOMINANT
-    {{0, 2, 4, 6, 7, 9, 10, -1, -1, -1, -1, -1}, 7},
-    // HUNGARIAN_MINOR
-    {{0, 2, 3, 6, 7, 8, 11, -1, -1, -1, -1, -1}, 7},
-    // SUPER_LOCRIAN
-    {{0, 1, 3, 4, 6, 8, 10, -1, -1, -1, -1, -1}, 7},
-    // SPANISH
-    {{0, 1, 4, 5, 7, 9, 10, -1, -1, -1, -1, -1}, 7},
-    // BHAIRAV
-    {{0, 1, 4, 5, 7, 8, 11, -1, -1, -1, -1, -1}, 7},
-    // PENTATONIC_MINOR
-    {{0, 3, 5, 7, 10, -1, -1, -1, -1, -1, -1, -1}, 5},
-    // PENTATONIC_MAJOR
-    {{0, 2, 4, 7, 9, -1, -1, -1, -1, -1, -1, -1}, 5},
-    // BLUES_MINOR
-    {{0, 3, 5, 6, 7, 10, -1, -1, -1, -1, -1, -1}, 6},
-    // WHOLE_TONE
-    {{0, 2, 4, 6, 8, 10, -1, -1, -1, -1, -1, -1}, 6},
-    // CHROMATIC
-    {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, 12},
-    // JAPANESE_IN_SEN
-    {{0, 1, 5, 7, 10, -1, -1, -1, -1, -1, -1, -1}, 5},
+struct ScaleTables {
+    ScaleTable scales[NUM_SCALES];
 };
 
-//-----------------------------------------------------------------------------
-// Scale name lookup (for UI display)
-//-----------------------------------------------------------------------------
+constexpr ScaleTables buildScaleTables() {
+    ScaleTables t{};
+    for (int s = 0; s < NUM_SCALES; s++) {
+        const ScaleDef& def = SCALE_REGISTRY[s];
+        ScaleTable& table = t.scales[s];
+        table.length = def.length;
+        for (int i = 0; i < def.length; i++) {
+            table.mask = static_cast<uint16_t>(table.mask | (1u << def.intervals[i]));
+        }
+        for (int d = 0; d < DEGREE_SPAN; d++) {
+            table.semitone[d] = def.intervals[d % def.length] + 12 * (d / def.length);
+        }
+    }
+    return t;
+}
+
+inline constexpr ScaleTables SCALE_TABLES = buildScaleTables();
+
+constexpr bool registryValid() {
+    for (const ScaleDef& def : SCALE_REGISTRY) {
+        if (def.length < 1 || def.length > 12 || def.intervals[0] != 0) {
+            return false;
+        }
+        for (int i = 1; i < def.length; i++) {
+            if (def.intervals[i] <= def.intervals[i - 1] || def.intervals[i] > 11) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(registryValid(), "scale intervals must start at 0, ascend and stay within the octave");
+static_assert(static_cast<int>(Scale::JAPANESE_IN_SEN) < NUM_SCALES, "every named scale needs a registry entry");
+
+inline const ScaleTable& scaleTable(Scale scale) {
+    return SCALE_TABLES.scales[static_cast<int>(scale)];
+}
 
 inline const char* getScaleName(Scale scale) {
-    static const char* names[] = {
-        "Major", "Minor", "Dorian", "Mixolydian", "Lydian",
-        "Phrygian", "Locrian", "Harmonic Minor", "Harmonic Major",
-        "Dorian #4", "Phrygian Dominant", "Melodic Minor",
-        "Lydian Augmented", "Lydian Dominant", "Hungarian Minor",
-        "Super Locrian", "Spanish", "Bhairav",
-        "Pentatonic Minor", "Pentatonic Major", "Blues Minor",
-        "Whole Tone", "Chromatic", "Japanese In-Sen"
-    };
-    return names[static_cast<int>(scale)];
+    return SCALE_REGISTRY[static_cast<int>(scale)].name;
+}
+
+inline const char* getScaleAbbrev(Scale scale) {
+    int i = static_cast<int>(scale);
+    return i >= 0 && i < NUM_SCALES ? SCALE_REGISTRY[i].abbrev : "---";
 }
 
 //-----------------------------------------------------------------------------
@@ -219,17 +255,14 @@ struct GeneratorParams {
 inline int getNoteInScale(int note, Scale scale, int root = 0, int octave = 0) {
     if (note < 0) return -1;  // Rest
 
-    const ScaleData& scaleData = SCALES[static_cast<int>(scale)];
-    int len = scaleData.length;
-
-    // Wrap the index to fit the scale length
-    int wrappedIndex = note % len;
-
-    // Calculate extra octaves if the index exceeded the scale length
-    int octaveOffset = note / len;
+    const ScaleTable& table = scaleTable(scale);
+    if (note < DEGREE_SPAN) {
+        return table.semitone[note] + root + 12 * octave;
+    }
 
     // Formula: Note in Scale + Root + (User Octave * 12) + (Wrapped Octave * 12)
-    return scaleData.intervals[wrappedIndex] + root + 12 * (octave + octaveOffset);
+    int len = table.length;
+    return table.semitone[note % len] + root + 12 * (octave + note / len);
 }
 
 //-----------------------------------------------------------------------------
@@ -376,6 +409,12 @@ struct MasterPattern {
     }
 };
 
+// Size budgets. Each module instance holds four MasterPatterns (playing,
+// recording, layer and layer mix) and a Pattern (display), so growth here
+// multiplies; raise a budget only deliberately (see acidseq-bench --memory).
+static_assert(sizeof(MasterPattern) <= 1180, "MasterPattern grew past its 1180-byte budget");
+static_assert(sizeof(Pattern) <= 772, "Pattern grew past its 772-byte budget");
+
 //-----------------------------------------------------------------------------
 // generateMaster - Generate a master pattern for real-time control
 //-----------------------------------------------------------------------------
@@ -627,4 +666,28 @@ inline float stepToVoltage(const SequenceStep& step, Scale scale, int root = 0,
     return (midiNote - 60) / 12.0f;
 }
 
+// Inverse of the module's pitch output: find the pool index and octave whose
+// pitch is nearest to a 1V/oct voltage (0V = C0, as written by AcidSeq).
+// Searches all 7 pool entries x 3 octaves; ties keep the higher-priority pool
+// index so a recorded root stays a root. No allocation - safe in the audio thread.
+inline void voltageToPoolStep(float voltage, const MasterPattern& pattern, Scale scale,
+                              int root, int baseOctave, int& notePoolIndex, int& octave) {
+    float target = voltage * 12.0f;
+    float bestDistance = INFINITY;
+    notePoolIndex = 0;
+    octave = 0;
+
+    for (int p = 0; p < SCALE_SIZE; p++) {
+        for (int o = -1; o <= 1; o++) {
+            int midiNote = getNoteInScale(pattern.scalePriorityOrder[p], scale, root, o + baseOctave);
+            float distance = std::fabs(midiNote - target);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                notePoolIndex = p;
+                octave = o;
+            }
+        }
+    }
+}
+
 } // namespace AcidGenerator
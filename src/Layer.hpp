@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Generator.hpp"
+#include "Features.hpp"
+
+#include <cstdint>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Layer - Two master patterns combined through their rhythm masks
+//-----------------------------------------------------------------------------
+// A second "layer" master (B) plays against the primary (A). At a DENSITY
+// level each master plays a 16-bit set of bar positions, the first N of its
+// barActivationOrder, and the layered rhythm is one bitwise op on the two
+// sets. Note content (degree, octave, accent, slide) comes from one layer,
+// chosen separately. A's mutes always apply.
+//
+// The step engines resolve one MasterPattern at one DENSITY value, so
+// mixLayers() writes one: the content layer's steps, with a bar order that
+// puts the combined positions first, and returns the DENSITY value that
+// selects exactly those. Callers rebuild it only when a layer, the op, the
+// pitch layer or the DENSITY level changes; playing it costs what playing
+// the primary does.
+
+enum class LayerOp {
+    A_ONLY,     // Rhythm of A alone (layering off unless pitch comes from B)
+    AND,        // Positions both play
+    OR,         // Positions either plays
+    XOR,        // Positions exactly one plays
+    A_MINUS_B,  // Positions A plays and B does not
+};
+
+constexpr int NUM_LAYER_OPS = 5;
+
+inline const char* getLayerOpName(LayerOp op) {
+    static const char* const NAMES[NUM_LAYER_OPS] = {"A only", "A AND B", "A OR B", "A XOR B", "A minus B"};
+    int i = static_cast<int>(op);
+    return i >= 0 && i < NUM_LAYER_OPS ? NAMES[i] : "";
+}
+
+// Seed of the layer generated alongside a GEN's seed (an odd multiply, so
+// distinct seeds give distinct layers)
+inline uint32_t layerSeedFor(uint32_t seed) {
+    return seed * 0x9e3779b9u + 0x7f4a7c15u;
+}
+
+// Bar positions (bit n = position n) a master plays at a DENSITY level
+inline uint16_t barMask(const MasterPattern& pattern, int level) {
+    uint16_t mask = 0;
+    for (int i = 0; i < level && i < BAR_LEN; i++) {
+        mask = static_cast<uint16_t>(mask | (1u << pattern.barActivationOrder[i]));
+    }
+    return mask;
+}
+
+inline uint16_t combineBars(uint16_t a, uint16_t b, LayerOp op) {
+    switch (op) {
+        case LayerOp::AND: return a & b;
+        case LayerOp::OR: return a | b;
+        case LayerOp::XOR: return a ^ b;
+        case LayerOp::A_MINUS_B: return a & ~b;
+        default: return a;
+    }
+}
+
+// Write into out the single pattern that plays A and B layered at DENSITY
+// level `level`, with notes from B if pitchFromB. Returns the DENSITY value
+// to resolve out with; SPREAD/ACC/SLD apply to it unchanged.
+inline float mixLayers(const MasterPattern& a, const MasterPattern& b, LayerOp op, bool pitchFromB, int level,
+                       MasterPattern& out) {
+    const MasterPattern& content = pitchFromB ? b : a;
+    uint16_t bars = combineBars(barMask(a, level), barMask(b, level), op);
+
+    // Combined positions first, the rest after, so the order stays a permutation
+    int count = 0;
+    for (int pos = 0; pos < BAR_LEN; pos++) {
+        if ((bars >> pos) & 1) {
+            out.barActivationOrder[count++] = pos;
+        }
+    }
+    int next = count;
+    for (int pos = 0; pos < BAR_LEN; pos++) {
+        if (!((bars >> pos) & 1)) {
+            out.barActivationOrder[next++] = pos;
+        }
+    }
+
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        out.scalePriorityOrder[i] = content.scalePriorityOrder[i];
+    }
+    for (int i = 0; i < MAX_STEPS; i++) {
+        out.steps[i] = content.steps[i];
+        out.muted[i] = a.muted[i];
+    }
+    return densityForLevel(count);
+}
+
+} // namespace AcidGenerator
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Generator.hpp"
+#include "Features.hpp"
+#include "Layer.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// MacroMap - DENSITY x SPREAD preview, resolved off the audio thread
+//-----------------------------------------------------------------------------
+// The audio thread posts the master pattern (with the loop length, the
+// ACC/SLD knobs and, while layering, layer B and the op) whenever one of them
+// changes. A layered map is swept one DENSITY level at a time from the mix
+// mixLayers() writes for that level, so each column shows what the engine
+// would play there. The UI polls once per frame;
+// when a newer request is waiting and no job is running it wakes the worker
+// thread, which runs sweepDensitySpread() on a copy, and once the job is done
+// the next poll() moves the cells into `map`. The map widget redraws its
+// framebuffer only when poll() reports a new map. The worker is started by
+// the first job and sleeps on a condition variable between jobs, so a knob
+// drag costs a wake-up per job, not a thread; the destructor joins it.
+//
+// post() never blocks or allocates: if a job is copying the previous request
+// it returns false and the audio thread posts again on a later frame. `map`
+// belongs to the UI thread; the job writes only `building`.
+
+struct MacroMapCells {
+    int length = 0;
+    SweepCell cells[DENSITY_LEVELS][SPREAD_LEVELS];
+};
+
+struct MacroMapWorker {
+    // Request slot, written by the audio thread
+    std::atomic<bool> requestBusy{false};
+    std::atomic<uint32_t> requested{0};  // Bumped on each post
+    MasterPattern requestPattern;        // Pitch layer's steps with A's mutes and bar order
+    int requestLayerBars[BAR_LEN] = {};  // B's bar order
+    LayerOp requestOp = LayerOp::A_ONLY;
+    bool requestLayered = false;
+    int requestLength = MAX_STEPS;
+    float requestAccent = 0.f;
+    float requestSlide = 0.f;
+
+    // Worker thread, woken for each job, and its result
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool jobPending = false;  // Under wakeMutex: a job is waiting to start
+    bool stopping = false;    // Under wakeMutex: destructor, exit the worker
+    std::atomic<bool> jobDone{false};
+    MacroMapCells building;
+    uint32_t buildingVersion = 0;
+
+    // UI thread
+    bool jobRunning = false;  // Job started and not yet collected
+    MacroMapCells map;
+    uint32_t mapVersion = 0;  // Request the map was built from, 0 for none
+
+    ~MacroMapWorker() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            worker.join();
+        }
+    }
+
+    // Audio thread. False when the slot is taken; try again later. Layering
+    // is off when op is A_ONLY and the pitch comes from A; b is unused then.
+    bool post(const MasterPattern& a, const MasterPattern& b, LayerOp op, bool pitchFromB, int length,
+              float accentDensity, float slideDensity) {
+        if (requestBusy.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+        // Only what mixLayers() reads: the pitch layer's steps, A's mutes
+        // and both bar orders
+        requestPattern = pitchFromB ? b : a;
+        for (int i = 0; pitchFromB && i < MAX_STEPS; i++) {
+            requestPattern.muted[i] = a.muted[i];
+        }
+        for (int i = 0; i < BAR_LEN; i++) {
+            requestPattern.barActivationOrder[i] = a.barActivationOrder[i];
+            requestLayerBars[i] = b.barActivationOrder[i];
+        }
+        requestOp = op;
+        requestLayered = op != LayerOp::A_ONLY || pitchFromB;
+        requestLength = length;
+        requestAccent = accentDensity;
+        requestSlide = slideDensity;
+        requested.store(requested.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        requestBusy.store(false, std::memory_order_release);
+        return true;
+    }
+
+    bool ready() const {
+        return mapVersion != 0;
+    }
+
+    // UI thread: collect a finished job and start one for a newer request.
+    // True when `map` changed.
+    bool poll() {
+        bool landed = false;
+        if (jobRunning) {
+            if (!jobDone.load(std::memory_order_acquire)) {
+                return false;
+            }
+            jobRunning = false;
+            map = building;
+            mapVersion = buildingVersion;
+            landed = true;
+        }
+        if (requested.load(std::memory_order_acquire) != mapVersion) {
+            jobDone.store(false, std::memory_order_relaxed);
+            jobRunning = true;
+            if (!worker.joinable()) {
+                worker = std::thread([this] { workLoop(); });
+            }
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                jobPending = true;
+            }
+            wake.notify_one();
+        }
+        return landed;
+    }
+
+    // Blocks until the newest request is in `map` (tests, bench)
+    void wait() {
+        while (poll() || jobRunning) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    void workLoop() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (true) {
+            wake.wait(lock, [this] { return jobPending || stopping; });
+            if (stopping) {
+                return;
+            }
+            jobPending = false;
+            lock.unlock();
+            run();
+            lock.lock();
+        }
+    }
+
+    void run() {
+        // The slot is only held for a copy, so spinning is short
+        while (requestBusy.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        MasterPattern pattern = requestPattern;
+        MasterPattern layer;
+        for (int i = 0; i < BAR_LEN; i++) {
+            layer.barActivationOrder[i] = requestLayerBars[i];
+        }
+        LayerOp op = requestOp;
+        bool layered = requestLayered;
+        int length = requestLength;
+        float accent = requestAccent;
+        float slide = requestSlide;
+        buildingVersion = requested.load(std::memory_order_relaxed);
+        requestBusy.store(false, std::memory_order_release);
+
+        KnobSweep sweep;
+        if (!layered) {
+            sweepDensitySpread(pattern, length, accent, slide, sweep);
+            building.length = sweep.length;
+            for (int d = 0; d < DENSITY_LEVELS; d++) {
+                for (int s = 0; s < SPREAD_LEVELS; s++) {
+                    building.cells[d][s] = sweep.cells[d][s];
+                }
+            }
+        } else {
+            // Column d is the mix at level d, read at the level it resolves to
+            MasterPattern mix;
+            for (int d = 0; d < DENSITY_LEVELS; d++) {
+                int level = densityLevel(mixLayers(pattern, layer, op, false, d, mix));
+                sweepDensitySpread(mix, length, accent, slide, sweep);
+                for (int s = 0; s < SPREAD_LEVELS; s++) {
+                    building.cells[d][s] = sweep.cells[level][s];
+                }
+            }
+            building.length = sweep.length;
+        }
+        jobDone.store(true, std::memory_order_release);
+    }
+};
+
+} // namespace AcidGenerator
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// MidiClockFollower - 24 PPQN MIDI clock to 16th-note steps
+//-----------------------------------------------------------------------------
+// Raw MIDI clock arrives with a millisecond or more of jitter, so steps are
+// not fired on the incoming ticks directly. Instead a phase-locked loop runs
+// its own tick phase at the estimated tick period and each received tick
+// nudges phase and period toward it:
+//
+//   per sample:   phase += dt / period
+//   per tick n:   error   = n - phase
+//                 phase  += PHASE_GAIN * error
+//                 period -= PERIOD_GAIN * period * error
+//
+// A step fires on the sample where phase crosses the next 6-tick boundary, so
+// steps land evenly spaced at sample resolution. The phase never runs more
+// than half a tick past the next expected tick, so a stalled clock stops the
+// sequence instead of free-running.
+
+struct MidiClockFollower {
+    static constexpr int TICKS_PER_STEP = 6;      // 24 PPQN / 4 steps per beat
+    static constexpr float PHASE_GAIN = 0.1f;
+    static constexpr float PERIOD_GAIN = 0.0025f;  // ~PHASE_GAIN^2 / 4, critically damped
+    static constexpr float MIN_TICK_PERIOD = 0.001f;  // ~2500 BPM
+    static constexpr float MAX_TICK_PERIOD = 0.1f;    // 25 BPM
+    static constexpr float LOCK_ERROR = 1.5f;     // Ticks off before re-syncing
+    static constexpr float MAX_LEAD = 0.5f;       // Ticks the PLL may run ahead
+
+    // Phase and tick count are relative to the first tick of the current
+    // step and wrap by TICKS_PER_STEP each step, keeping float precision
+    bool running = false;
+    float period = 0.125f / TICKS_PER_STEP;  // Seconds per tick, ~120 BPM
+    float phase = 0.f;         // PLL position in ticks
+    int ticks = 0;             // Index of the next expected tick
+    float sinceTick = 0.f;     // Time since the last received tick
+    bool haveTick = false;     // sinceTick measures a real tick interval
+    bool locked = false;       // Period estimate seeded from two ticks
+
+    // MIDI Start: the next tick is the first step
+    void start() {
+        running = true;
+        phase = static_cast<float>(TICKS_PER_STEP);
+        ticks = TICKS_PER_STEP;
+        haveTick = false;
+        locked = false;
+    }
+
+    // MIDI Continue: resume from the current tick count
+    void resume() {
+        running = true;
+        haveTick = false;
+        locked = false;
+    }
+
+    // MIDI Stop
+    void stop() {
+        running = false;
+    }
+
+    // A 0xF8 clock message arrived. Returns true if the step has to be fired
+    // here rather than by the PLL (first tick, or resynchronization).
+    bool tick() {
+        if (!running) {
+            return false;
+        }
+
+        int n = ticks++;
+        float measured = sinceTick;
+        bool measuredValid = haveTick;
+        sinceTick = 0.f;
+        haveTick = true;
+
+        if (!locked) {
+            // Seed from the raw interval once there is one, and sit on the tick
+            if (measuredValid && measured >= MIN_TICK_PERIOD && measured <= MAX_TICK_PERIOD) {
+                period = measured;
+                locked = true;
+            }
+            return snapTo(n);
+        }
+
+        float error = static_cast<float>(n) - phase;
+        if (std::fabs(error) > LOCK_ERROR) {
+            // Tempo jump or dropout: follow the raw clock again
+            locked = false;
+            return snapTo(n);
+        }
+
+        phase += PHASE_GAIN * error;
+        period -= PERIOD_GAIN * period * error;
+        period = std::fmax(MIN_TICK_PERIOD, std::fmin(MAX_TICK_PERIOD, period));
+        return false;
+    }
+
+    // Advance by one sample. Returns true on the sample a step starts.
+    bool process(float dt) {
+        sinceTick += dt;
+        if (!running || !locked) {
+            return false;
+        }
+
+        // Wait for the input if it is late
+        phase = std::fmin(phase + dt / period, static_cast<float>(ticks) + MAX_LEAD);
+        if (phase >= static_cast<float>(TICKS_PER_STEP)) {
+            wrap();
+            return true;
+        }
+        return false;
+    }
+
+    float stepPeriod() const {
+        return period * TICKS_PER_STEP;
+    }
+
+private:
+    void wrap() {
+        phase -= TICKS_PER_STEP;
+        ticks -= TICKS_PER_STEP;
+    }
+
+    // Jump the phase to tick n, firing the step if its boundary is due (late
+    // if a resync skipped it, so the step count stays aligned with the ticks)
+    bool snapTo(int n) {
+        phase = static_cast<float>(n);
+        if (n >= TICKS_PER_STEP) {
+            wrap();
+            return true;
+        }
+        return false;
+    }
+};
+
+} // namespace AcidGenerator
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "Features.hpp"
+#include "Generator.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Packed patterns - Compact MasterPattern and Pattern for banks and caches
+//-----------------------------------------------------------------------------
+// MasterPattern is ~1.4 KB and Pattern ~770 bytes; the packed forms are 192
+// and 72 bytes, so thousands of patterns (banks, undo histories, resolve
+// caches) stay in L2. Per-step fields are stored as bit planes: bit s of
+// plane k is bit k of step s's value, so whole-pattern queries are a few
+// 64-bit operations and single-step reads are shifts.
+//
+// Packing is lossless except for the accent/slide probabilities, which keep
+// 8 bits (see packProb). A packed pattern answers every query exactly like
+// its unpacked MasterPattern; against the original float probabilities it
+// agrees whenever density * 2.55 is a whole number (0, 20, 40 ... 100%).
+// Out-of-range fields (hand-edited JSON) are clamped: pool index 0-6,
+// octave -1..1, order entries 0-15.
+
+constexpr int POOL_PLANES = 3;
+constexpr int OCTAVE_PLANES = 2;   // octave + 1 (0-2)
+constexpr int PROB_LEVELS = 255;   // Quantized probability q means q / 255
+
+// q = floor(p * 255): 1 (a recorded "off") stays above every threshold and
+// 0 below every non-zero one, as with the float values. Double keeps the
+// product of a 24-bit float and 255 exact; truncation is floor here and,
+// unlike std::floor without SSE4.1, not a libm call.
+inline uint8_t packProb(float p) {
+    double clamped = std::min(std::max(static_cast<double>(p), 0.0), 1.0);
+    return static_cast<uint8_t>(clamped * PROB_LEVELS);
+}
+
+inline float unpackProb(int q) {
+    return q / static_cast<float>(PROB_LEVELS);
+}
+
+// Number of levels flagged at this density: q is flagged iff q < result.
+// Same float comparison getStep() makes on the unpacked probability.
+inline int probThreshold(float density) {
+    float t = density / 100.0f;
+    int k = std::min(std::max(static_cast<int>(std::ceil(t * PROB_LEVELS)), 0), PROB_LEVELS + 1);
+    while (k > 0 && !(unpackProb(k - 1) < t)) {
+        k--;
+    }
+    while (k <= PROB_LEVELS && unpackProb(k) < t) {
+        k++;
+    }
+    return k;
+}
+
+// Value of a step spread over `count` bit planes
+inline int planeValue(const uint64_t* planes, int count, int step) {
+    int v = 0;
+    for (int k = 0; k < count; k++) {
+        v |= static_cast<int>((planes[k] >> step) & 1) << k;
+    }
+    return v;
+}
+
+inline void setPlaneValue(uint64_t* planes, int count, int step, int value) {
+    for (int k = 0; k < count; k++) {
+        uint64_t bit = 1ull << step;
+        planes[k] = (planes[k] & ~bit) | (static_cast<uint64_t>((value >> k) & 1) << step);
+    }
+}
+
+// Transpose one byte per step into bit planes, 8 steps per multiply (see
+// resolveBits in Features.hpp)
+inline void bytesToPlanes(const uint8_t* values, uint64_t* planes, int count) {
+    for (int k = 0; k < count; k++) {
+        planes[k] = 0;
+    }
+    for (int chunk = 0; chunk < MAX_STEPS / 8; chunk++) {
+        uint64_t x;
+        std::memcpy(&x, values + chunk * 8, 8);
+        for (int k = 0; k < count; k++) {
+            uint64_t gathered = (((x >> k) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56;
+            planes[k] |= gathered << (chunk * 8);
+        }
+    }
+}
+
+// Steps whose plane value is below `limit` (0-7), without unpacking: walk
+// the bits from the top, tracking "equal so far" and "already below"
+inline uint64_t planesLess(const uint64_t* planes, int count, int limit) {
+    uint64_t equal = ~0ull;
+    uint64_t less = 0;
+    for (int k = count - 1; k >= 0; k--) {
+        uint64_t limitBit = (limit >> k) & 1 ? ~0ull : 0;
+        less |= equal & ~planes[k] & limitBit;
+        equal &= ~(planes[k] ^ limitBit);
+    }
+    return limit >= (1 << count) ? ~0ull : less;
+}
+
+// Steps whose plane value is exactly `value`
+inline uint64_t planesEqual(const uint64_t* planes, int count, int value) {
+    uint64_t equal = ~0ull;
+    for (int k = 0; k < count; k++) {
+        equal &= (value >> k) & 1 ? planes[k] : ~planes[k];
+    }
+    return equal;
+}
+
+//-----------------------------------------------------------------------------
+// PackedPattern - Resolved Pattern as masks and planes (72 bytes)
+//-----------------------------------------------------------------------------
+// Rests are canonical ({-1, 0, false, false}, as getStep() returns them), so
+// they cost nothing beyond the notes mask.
+
+struct PackedPattern {
+    uint64_t notes = 0;    // Step plays (not a rest)
+    uint64_t accent = 0;   // Only on notes
+    uint64_t slide = 0;
+    uint64_t degree[POOL_PLANES] = {};     // Scale degree (0-6), 0 on rests
+    uint64_t octave[OCTAVE_PLANES] = {};   // octave + 1, 0 on rests
+    int length = MAX_STEPS;
+
+    SequenceStep getStep(int step) const {
+        if (!((notes >> step) & 1)) {
+            return {-1, 0, false, false};
+        }
+        return {planeValue(degree, POOL_PLANES, step), planeValue(octave, OCTAVE_PLANES, step) - 1,
+                static_cast<bool>((accent >> step) & 1), static_cast<bool>((slide >> step) & 1)};
+    }
+
+    // Notes within the active length
+    int noteCount() const {
+        return popcount64(notes & lengthMask(length));
+    }
+};
+static_assert(sizeof(PackedPattern) <= 72, "PackedPattern should stay 72 bytes");
+
+inline void pack(const Pattern& in, PackedPattern& out) {
+    out = PackedPattern();
+    out.length = in.length;
+    for (int s = 0; s < MAX_STEPS; s++) {
+        const SequenceStep& st = in.steps[s];
+        if (st.isRest()) {
+            continue;
+        }
+        uint64_t bit = 1ull << s;
+        int degree = std::min(st.note, SCALE_SIZE - 1);
+        int octave = std::min(std::max(st.octave, -1), 1) + 1;
+        out.notes |= bit;
+        out.accent |= st.accent ? bit : 0;
+        out.slide |= st.slide ? bit : 0;
+        for (int k = 0; k < POOL_PLANES; k++) {
+            out.degree[k] |= static_cast<uint64_t>((degree >> k) & 1) << s;
+        }
+        for (int k = 0; k < OCTAVE_PLANES; k++) {
+            out.octave[k] |= static_cast<uint64_t>((octave >> k) & 1) << s;
+        }
+    }
+}
+
+inline void unpack(const PackedPattern& in, Pattern& out) {
+    out.length = in.length;
+    for (int s = 0; s < MAX_STEPS; s++) {
+        out.steps[s] = in.getStep(s);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// PackedMasterPattern - MasterPattern in 192 bytes
+//-----------------------------------------------------------------------------
+
+struct PackedMasterPattern {
+    uint64_t barOrder = 0xfedcba9876543210ull;  // barActivationOrder, entry i in bits 4i..4i+3
+    uint32_t scaleOrder = 0x6543210u;           // scalePriorityOrder, 4 bits per entry
+    uint32_t reserved = 0;
+    uint64_t pool[POOL_PLANES] = {};            // notePoolIndex planes
+    uint64_t octave[OCTAVE_PLANES] = {~0ull, 0};  // octave + 1 planes
+    uint64_t muted = 0;
+    uint8_t accent[MAX_STEPS];                  // packProb(accentProb)
+    uint8_t slide[MAX_STEPS];                   // packProb(slideProb)
+
+    // Same content as a default MasterPattern
+    PackedMasterPattern() {
+        for (int s = 0; s < MAX_STEPS; s++) {
+            accent[s] = packProb(0.5f);
+            slide[s] = packProb(0.5f);
+        }
+    }
+
+    int barOrderAt(int i) const {
+        return static_cast<int>((barOrder >> (4 * i)) & 0xf);
+    }
+    int scaleOrderAt(int i) const {
+        return static_cast<int>((scaleOrder >> (4 * i)) & 0xf);
+    }
+    int poolIndex(int step) const {
+        return planeValue(pool, POOL_PLANES, step);
+    }
+    int octaveOf(int step) const {
+        return planeValue(octave, OCTAVE_PLANES, step) - 1;
+    }
+    bool isMuted(int step) const {
+        return (muted >> step) & 1;
+    }
+
+    // In-place edits (recorder, undo) without an unpack/pack round trip
+    void setStep(int step, const MasterStep& ms) {
+        setPlaneValue(pool, POOL_PLANES, step, std::min(std::max(ms.notePoolIndex, 0), SCALE_SIZE - 1));
+        setPlaneValue(octave, OCTAVE_PLANES, step, std::min(std::max(ms.octave, -1), 1) + 1);
+        accent[step] = packProb(ms.accentProb);
+        slide[step] = packProb(ms.slideProb);
+    }
+    void setMuted(int step, bool mute) {
+        muted = (muted & ~(1ull << step)) | (static_cast<uint64_t>(mute) << step);
+    }
+
+    // Steps that play at this density (bar position active, not muted)
+    uint64_t activeMask(float density) const {
+        int activeCount = std::max(0, static_cast<int>(std::round(BAR_LEN * density / 100.0f)));
+        uint64_t barMask = 0;
+        for (int i = 0; i < activeCount && i < BAR_LEN; i++) {
+            barMask |= 1ull << barOrderAt(i);
+        }
+        return (barMask * 0x0001000100010001ull) & ~muted;
+    }
+
+    // Steps whose note is inside the spread pool
+    uint64_t inPoolMask(float spread) const {
+        int spreadCount = std::max(1, static_cast<int>(std::round(SCALE_SIZE * spread / 100.0f)));
+        return planesLess(pool, POOL_PLANES, spreadCount);
+    }
+
+    // Steps whose accent/slide would fire at this density (before density
+    // and mutes are applied)
+    uint64_t accentMask(float accentsDensity) const {
+        return levelMask(accent, probThreshold(accentsDensity));
+    }
+    uint64_t slideMask(float slidesDensity) const {
+        return levelMask(slide, probThreshold(slidesDensity));
+    }
+
+    // Same result as MasterPattern::getStep() on the unpacked pattern
+    SequenceStep getStep(int step, float density, float spread, float accentsDensity, float slidesDensity,
+                         bool quantizeToPool = true) const {
+        if (!((activeMask(density) >> step) & 1)) {
+            return {-1, 0, false, false};
+        }
+        int index = poolIndex(step);
+        if (!((inPoolMask(spread) >> step) & 1)) {
+            if (!quantizeToPool) {
+                return {-1, 0, false, false};
+            }
+            index = 0;
+        }
+        return {scaleOrderAt(index), octaveOf(step), accent[step] < probThreshold(accentsDensity),
+                slide[step] < probThreshold(slidesDensity)};
+    }
+
+    // All 64 steps at one knob setting, mask by mask
+    void resolve(float density, float spread, float accentsDensity, float slidesDensity, PackedPattern& out,
+                 bool quantizeToPool = true) const {
+        uint64_t inPool = inPoolMask(spread);
+        uint64_t notes = activeMask(density) & (quantizeToPool ? ~0ull : inPool);
+        out = PackedPattern();
+        out.notes = notes;
+        out.accent = accentMask(accentsDensity) & notes;
+        out.slide = slideMask(slidesDensity) & notes;
+        for (int k = 0; k < OCTAVE_PLANES; k++) {
+            out.octave[k] = octave[k] & notes;
+        }
+        // Degree lookup through scaleOrder, one pool value at a time across
+        // all steps; out-of-pool steps read entry 0
+        for (int v = 0; v < SCALE_SIZE; v++) {
+            uint64_t steps = planesEqual(pool, POOL_PLANES, v) & inPool & notes;
+            if (v == 0) {
+                steps |= ~inPool & notes;
+            }
+            int degree = scaleOrderAt(v);
+            for (int k = 0; k < POOL_PLANES; k++) {
+                out.degree[k] |= (degree >> k) & 1 ? steps : 0;
+            }
+        }
+    }
+
+private:
+    static uint64_t levelMask(const uint8_t* levels, int threshold) {
+        uint64_t mask = 0;
+        for (int s = 0; s < MAX_STEPS; s++) {
+            mask |= static_cast<uint64_t>(levels[s] < threshold) << s;
+        }
+        return mask;
+    }
+};
+static_assert(sizeof(PackedMasterPattern) == 192, "PackedMasterPattern should stay 192 bytes");
+
+inline void pack(const MasterPattern& in, PackedMasterPattern& out) {
+    out.barOrder = 0;
+    for (int i = 0; i < BAR_LEN; i++) {
+        out.barOrder |= static_cast<uint64_t>(std::min(std::max(in.barActivationOrder[i], 0), 15)) << (4 * i);
+    }
+    out.scaleOrder = 0;
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        out.scaleOrder |= static_cast<uint32_t>(std::min(std::max(in.scalePriorityOrder[i], 0), 15)) << (4 * i);
+    }
+    // Locals, so the byte stores cannot alias `in`
+    uint8_t pools[MAX_STEPS];
+    uint8_t octaves[MAX_STEPS];
+    uint8_t mutes[MAX_STEPS];
+    uint8_t accents[MAX_STEPS];
+    uint8_t slides[MAX_STEPS];
+    for (int s = 0; s < MAX_STEPS; s++) {
+        const MasterStep& ms = in.steps[s];
+        pools[s] = static_cast<uint8_t>(std::min(std::max(ms.notePoolIndex, 0), SCALE_SIZE - 1));
+        octaves[s] = static_cast<uint8_t>(std::min(std::max(ms.octave, -1), 1) + 1);
+        mutes[s] = in.muted[s];
+        accents[s] = packProb(ms.accentProb);
+        slides[s] = packProb(ms.slideProb);
+    }
+    bytesToPlanes(pools, out.pool, POOL_PLANES);
+    bytesToPlanes(octaves, out.octave, OCTAVE_PLANES);
+    bytesToPlanes(mutes, &out.muted, 1);
+    std::memcpy(out.accent, accents, MAX_STEPS);
+    std::memcpy(out.slide, slides, MAX_STEPS);
+    out.reserved = 0;
+}
+
+inline void unpack(const PackedMasterPattern& in, MasterPattern& out) {
+    for (int i = 0; i < BAR_LEN; i++) {
+        out.barActivationOrder[i] = in.barOrderAt(i);
+    }
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        out.scalePriorityOrder[i] = in.scaleOrderAt(i);
+    }
+    for (int s = 0; s < MAX_STEPS; s++) {
+        out.steps[s] = {in.poolIndex(s), in.octaveOf(s), unpackProb(in.accent[s]), unpackProb(in.slide[s])};
+        out.muted[s] = in.isMuted(s);
+    }
+}
+
+} // namespace AcidGenerator
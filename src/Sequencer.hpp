@@ -0,0 +1,388 @@
+#pragma once
+
+#include "Generator.hpp"
+#include "AccentSweep.hpp"
+#include "Chance.hpp"
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Sequencer - Per-sample step engine, independent of the Rack SDK
+//-----------------------------------------------------------------------------
+// Turns clock edges and a MasterPattern into pitch/gate/accent/slide. AcidSeq
+// and the offline renderer (tools/) both run this, so what the renderer
+// writes is exactly what the module plays. Per sample:
+//
+//   if (clock edge) {
+//       seq.advance(patternLength);
+//       StepEvent ev = seq.playStep(pattern, params, sampleRate, &chanceLane);
+//   }
+//   SequencerOutputs out = seq.process(sampleTime, pattern, params);
+//
+// Callers may act between advance() and playStep(), e.g. to swap the
+// pattern at step 0. The chance lane is optional; without one every step the
+// pattern plays is played. Timing is counted in frames at the rate given to
+// setSampleRate(), so process() ignores sampleTime.
+
+// Resolved knob values, in the module's parameter units
+struct SequencerParams {
+    int patternLength = 16;
+    Scale scale = Scale::MAJOR;  // SCALE knob default
+    int rootNote = 0;
+    int octaveOffset = 0;
+    float density = 50.f;
+    float spread = 50.f;
+    float accentDensity = 25.f;
+    float slideDensity = 15.f;
+    float chanceAmount = 0.f;  // 0-100, how far the chance lane applies
+};
+
+// A note started by playStep() (for MIDI and other note consumers)
+struct StepEvent {
+    bool note = false;     // False on rests
+    int midiNote = 0;      // Semitones from C4 (0V)
+    bool accent = false;
+    bool legato = false;   // Slid into from the previous step
+};
+
+// Portamento state in volts, as saved with the patch
+struct SlideState {
+    bool active = false;  // Current step slides into the next
+    float pitch = 0.f;
+    float target = 0.f;
+    float rate = 0.f;     // Volts per sample, 0 when not sliding
+};
+
+struct SequencerOutputs {
+    float pitch = 0.f;        // 1V/oct
+    bool gatePulse = false;   // Gate before the retrigger gap is applied
+    bool gate = false;
+    bool accent = false;
+    float accentSweep = 0.f;  // 0-1
+    bool slide = false;
+};
+
+// Clock, pulse and slide timing in whole frames. Sequencer and FixedSequencer
+// both keep one, so the float and fixed-point engines start and end every
+// gate, accent, retrigger gap and slide on the same frame; they differ only
+// in how pitch and the accent sweep are held.
+struct StepTimer {
+    static constexpr float RETRIGGER_GAP_TIME = 0.001f;    // 1ms gap
+    static constexpr float SHORT_GATE_TIME = 0.02f;        // Gate of a step that doesn't slide
+    static constexpr float SLIDE_TIME = 0.05f;             // 303 glide time
+    static constexpr float MIN_CLOCK_PERIOD = 0.01f;
+    static constexpr float MAX_CLOCK_PERIOD = 2.f;
+    static constexpr float DEFAULT_CLOCK_PERIOD = 0.125f;  // ~120 BPM 16ths, until measured
+    static constexpr int32_t SLIDE_SUBSTEPS = 256;         // Slide length resolution (1/256 frame)
+
+    // Clock period measurement
+    int32_t framesSinceClock = 0;
+    int32_t clockPeriodFrames = 0;
+    bool clockMeasured = false;
+
+    // Pulses (dsp::PulseGenerator semantics: high while > 0, then count down)
+    int32_t gateFrames = 0;
+    int32_t accentFrames = 0;
+    int32_t retriggerGapFrames = 0;  // Forces the gate low briefly on a retrigger
+
+    // Slide progress in substeps
+    int32_t slidePos = 0;
+    int32_t slideSpan = 0;  // Substeps for the whole slide, 0 when not sliding
+
+    // Per sample rate constants (setSampleRate)
+    float sampleRate = 0.f;
+    int32_t minClockFrames = 0;  // Periods must be longer than this...
+    int32_t maxClockFrames = 0;  // ...and shorter than this to count
+    int32_t shortGateFrames = 0;
+    int32_t retriggerGapLength = 0;
+    int32_t slideSpanFull = 0;
+
+    StepTimer() {
+        setSampleRate(44100.f);
+    }
+
+    // Frames a pulse of `seconds` stays high (rounding absorbs float error)
+    int32_t framesFor(double seconds) const {
+        return static_cast<int32_t>(std::ceil(seconds * sampleRate - 1e-3));
+    }
+
+    void setSampleRate(float sr) {
+        // Keep the period in seconds across the change
+        if (clockMeasured) {
+            clockPeriodFrames = static_cast<int32_t>(std::lround(static_cast<double>(clockPeriodFrames) * sr / sampleRate));
+        } else {
+            clockPeriodFrames = static_cast<int32_t>(std::lround(static_cast<double>(DEFAULT_CLOCK_PERIOD) * sr));
+        }
+        sampleRate = sr;
+        minClockFrames = static_cast<int32_t>(std::floor(static_cast<double>(MIN_CLOCK_PERIOD) * sr));
+        maxClockFrames = static_cast<int32_t>(std::ceil(static_cast<double>(MAX_CLOCK_PERIOD) * sr));
+        shortGateFrames = framesFor(SHORT_GATE_TIME);
+        retriggerGapLength = framesFor(RETRIGGER_GAP_TIME);
+        slideSpanFull = static_cast<int32_t>(std::lround(static_cast<double>(SLIDE_TIME * sr) * SLIDE_SUBSTEPS));
+    }
+
+    float clockPeriod() const {
+        return clockPeriodFrames / sampleRate;
+    }
+
+    float timeSinceClock() const {
+        return framesSinceClock / sampleRate;
+    }
+
+    // Clock edge: measure the period. A positive periodOverride replaces the
+    // measurement (MIDI clock PLL).
+    void clockEdge(float periodOverride) {
+        if (periodOverride > 0.f) {
+            float period = std::fmax(MIN_CLOCK_PERIOD, std::fmin(MAX_CLOCK_PERIOD, periodOverride));
+            clockPeriodFrames = static_cast<int32_t>(std::lround(period * sampleRate));
+            clockMeasured = true;
+        } else if (framesSinceClock > minClockFrames && framesSinceClock < maxClockFrames) {
+            clockPeriodFrames = framesSinceClock;
+            clockMeasured = true;
+        }
+        framesSinceClock = 0;
+    }
+
+    // Gate of a step that slides: ties into the next step (period + 10%)
+    int32_t tiedGate() const {
+        return (clockPeriodFrames * 11 + 9) / 10;
+    }
+
+    // Retriggered note: a gap if the gate is still high, then gate and accent
+    void attack(bool slide, bool accent) {
+        if (gateFrames > 0) {
+            retriggerGapFrames = retriggerGapLength;
+        }
+        int32_t gateTime = slide ? tiedGate() : shortGateFrames;
+        trigger(gateFrames, gateTime);
+        if (accent) {
+            trigger(accentFrames, gateTime);
+        }
+    }
+
+    // Slid-into note that slides on: extend the gate, no retrigger
+    void tie() {
+        trigger(gateFrames, tiedGate());
+    }
+
+    void startSlide(bool moves) {
+        slidePos = 0;
+        slideSpan = moves ? slideSpanFull : 0;
+    }
+
+    // Restore a slide with `frames` left to run (from a saved rate)
+    void resumeSlide(double frames) {
+        slidePos = 0;
+        slideSpan = frames > 0. ? static_cast<int32_t>(std::max(1.0, std::round(frames * SLIDE_SUBSTEPS))) : 0;
+    }
+
+    // Advance a running slide one frame; false once it has reached the target
+    bool slideFrame() {
+        slidePos += SLIDE_SUBSTEPS;
+        if (slidePos >= slideSpan) {
+            slideSpan = 0;
+            return false;
+        }
+        return true;
+    }
+
+    // Advance the clock and pulses one frame
+    void process(SequencerOutputs& out) {
+        // Saturate well past the longest period a stopped clock is timed against
+        if (framesSinceClock < 4 * maxClockFrames) {
+            framesSinceClock++;
+        }
+        out.gatePulse = pulse(gateFrames);
+        out.gate = out.gatePulse;
+        if (retriggerGapFrames > 0) {
+            retriggerGapFrames--;
+            out.gate = false;
+        }
+        out.accent = pulse(accentFrames);
+    }
+
+private:
+    // Extends the pulse, never shortens it
+    static void trigger(int32_t& remaining, int32_t frames) {
+        if (frames > remaining) {
+            remaining = frames;
+        }
+    }
+
+    static bool pulse(int32_t& remaining) {
+        if (remaining > 0) {
+            remaining--;
+            return true;
+        }
+        return false;
+    }
+};
+
+struct Sequencer {
+    static constexpr float RETRIGGER_GAP_TIME = StepTimer::RETRIGGER_GAP_TIME;
+    static constexpr float SLIDE_TIME = StepTimer::SLIDE_TIME;
+    static constexpr float MIN_CLOCK_PERIOD = StepTimer::MIN_CLOCK_PERIOD;
+    static constexpr float MAX_CLOCK_PERIOD = StepTimer::MAX_CLOCK_PERIOD;
+
+    int currentStep = -1;  // -1 means not started yet
+    uint32_t loop = 0;     // Loops completed since the last reset (chance rolls)
+
+    // Slide state (volts). A slide runs from slideStart to slideTargetPitch
+    // in slideStep per substep of the timer's slide span.
+    bool currentSlideActive = false;  // Is current step sliding INTO next?
+    bool stepDropped = false;         // Current step lost its chance roll
+    float slideStart = 0.f;
+    float slideTargetPitch = 0.f;
+    float slideStep = 0.f;
+    float currentPitch = 0.f;
+
+    StepTimer timer;          // Clock period, pulses and slide progress in frames
+    AccentSweep accentSweep;  // 303 accent sweep, charged by the accent gate
+    bool slideOut = false;    // Held while no step is playing
+
+    void setSampleRate(float sampleRate) {
+        timer.setSampleRate(sampleRate);
+        accentSweep.setSampleRate(sampleRate);
+    }
+
+    // Next clock plays step 0
+    void reset() {
+        currentStep = -1;
+        loop = 0;
+        currentSlideActive = false;
+        stepDropped = false;
+        timer.retriggerGapFrames = 0;
+    }
+
+    // Shared with FixedSequencer so AcidSeq can build on either engine
+    float clockPeriod() const {
+        return timer.clockPeriod();
+    }
+
+    float timeSinceClock() const {
+        return timer.timeSinceClock();
+    }
+
+    SlideState slideState() const {
+        float rate = timer.slideSpan > 0 ? (slideTargetPitch - slideStart) * StepTimer::SLIDE_SUBSTEPS / timer.slideSpan
+                                         : 0.f;
+        return {currentSlideActive, currentPitch, slideTargetPitch, rate};
+    }
+
+    void setSlideState(const SlideState& s) {
+        currentSlideActive = s.active;
+        currentPitch = s.pitch;
+        slideStart = s.pitch;
+        slideTargetPitch = s.target;
+        timer.resumeSlide(s.rate != 0.f && s.target != s.pitch ? std::fabs((s.target - s.pitch) / s.rate) : 0.);
+        slideStep = timer.slideSpan > 0 ? (s.target - s.pitch) / timer.slideSpan : 0.f;
+    }
+
+    // Clock edge: measure the period and move to the next step.
+    // A positive periodOverride replaces the measurement (MIDI clock PLL).
+    int advance(int patternLength, float periodOverride = 0.f) {
+        timer.clockEdge(periodOverride);
+
+        currentStep++;
+        if (currentStep >= patternLength) {
+            currentStep = 0;
+            loop++;
+        }
+        return currentStep;
+    }
+
+    // Start the current step: set pitch/slide and fire the gate and accent.
+    // A step that loses its chance roll plays as a rest.
+    StepEvent playStep(const MasterPattern& pattern, const SequencerParams& p, float /*sampleRate*/,
+                       const ChanceLane* chance = nullptr) {
+        StepEvent ev;
+        int amount = chanceAmountFor(p.chanceAmount);
+
+        // Get current step data with real-time density/spread applied
+        SequenceStep step = pattern.getStep(currentStep, p.density, p.spread, p.accentDensity, p.slideDensity);
+        stepDropped = !step.isRest() && chance && !chance->plays(currentStep, loop, amount);
+
+        if (step.isRest() || stepDropped) {
+            // Rest - no gate, reset slide
+            currentSlideActive = false;
+            return ev;
+        }
+
+        // getNoteInScale returns semitone offset from root; 0V = C4, 1V/octave
+        int midiNote = getNoteInScale(step.note, p.scale, p.rootNote, step.octave + p.octaveOffset);
+        float pitchVoltage = midiNote / 12.0f;
+
+        // Check if previous step had slide active (slide INTO this note)
+        int prevStep = (currentStep - 1 + p.patternLength) % p.patternLength;
+        SequenceStep prevStepData = pattern.getStep(prevStep, p.density, p.spread, p.accentDensity, p.slideDensity);
+        bool slideFromPrev = !prevStepData.isRest() && prevStepData.slide &&
+                             !(chance && !chance->plays(prevStep, prevLoop(), amount));
+
+        if (slideFromPrev) {
+            // Sliding into this note - set up portamento, no retrigger
+            slideStart = currentPitch;
+            slideTargetPitch = pitchVoltage;
+            timer.startSlide(pitchVoltage != currentPitch);
+            slideStep = timer.slideSpan > 0 ? (slideTargetPitch - slideStart) / timer.slideSpan : 0.f;
+
+            // If this step also has slide, extend gate to tie into next step
+            if (step.slide) {
+                timer.tie();
+            }
+            // Otherwise let the previous gate naturally decay
+        } else {
+            // Normal attack - set pitch immediately and retrigger the gate
+            // (after a brief gap if it is still high); slides extend the gate
+            // to the next step, normal notes are short
+            currentPitch = pitchVoltage;
+            slideTargetPitch = pitchVoltage;
+            timer.startSlide(false);
+            timer.attack(step.slide, step.accent);
+        }
+
+        // Store slide state for next step
+        currentSlideActive = step.slide;
+
+        ev.note = true;
+        ev.midiNote = midiNote;
+        ev.accent = step.accent;
+        ev.legato = slideFromPrev;
+        return ev;
+    }
+
+    // Advance one sample and compute the outputs
+    SequencerOutputs process(float /*sampleTime*/, const MasterPattern& pattern, const SequencerParams& p) {
+        SequencerOutputs out;
+
+        // Slide (portamento), interpolated from the start so it lands on the target
+        if (timer.slideSpan > 0) {
+            currentPitch = timer.slideFrame() ? slideStart + slideStep * timer.slidePos : slideTargetPitch;
+        }
+        out.pitch = currentPitch;
+
+        // Gate is high while the pulse is active, but forced low during the retrigger gap
+        timer.process(out);
+
+        // The sweep cap keeps integrating whether or not anything reads it
+        out.accentSweep = accentSweep.process(out.accent);
+
+        // Slide flag of the playing step (useful for external portamento)
+        if (currentStep >= 0 && currentStep < p.patternLength) {
+            slideOut = !stepDropped &&
+                       pattern.getStep(currentStep, p.density, p.spread, p.accentDensity, p.slideDensity).slide;
+        }
+        out.slide = slideOut;
+
+        return out;
+    }
+
+    // Loop the previous step was rolled on (the one before at step 0)
+    uint32_t prevLoop() const {
+        return currentStep == 0 ? loop - 1 : loop;
+    }
+};
+
+// 100 bytes, 56 of them the frame timer
+static_assert(sizeof(Sequencer) <= 100, "Sequencer grew past its 100-byte budget");
+
+} // namespace AcidGenerator
@@ -0,0 +1,410 @@
+#pragma once
+
+#include "Generator.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// PatternSignature - Binary fingerprint of a resolved pattern loop
+//-----------------------------------------------------------------------------
+// One 64-bit lane per feature, bit i = step i of the loop (bits past the
+// pattern length are zero):
+//
+//   RHYTHM   step plays a note
+//   UP/DOWN  note is higher/lower than the previous note (scale degrees, so
+//            the contour is independent of SCALE and ROOT)
+//   ACCENT   accented note
+//   SLIDE    note slides into the next
+//
+// Hamming distance between signatures is the similarity measure.
+
+enum SignatureLane { SIG_RHYTHM, SIG_UP, SIG_DOWN, SIG_ACCENT, SIG_SLIDE, SIGNATURE_WORDS };
+
+struct PatternSignature {
+    uint64_t words[SIGNATURE_WORDS] = {};
+};
+
+inline int hammingDistance(const PatternSignature& a, const PatternSignature& b) {
+    int d = 0;
+    for (int w = 0; w < SIGNATURE_WORDS; w++) {
+        d += __builtin_popcountll(a.words[w] ^ b.words[w]);
+    }
+    return d;
+}
+
+// Knob settings the patterns are resolved at before fingerprinting
+struct SimilarityParams {
+    int patternLength = 16;
+    float density = 50.f;
+    float spread = 50.f;
+    float accentDensity = 25.f;
+    float slideDensity = 15.f;
+};
+
+inline PatternSignature computeSignature(const MasterPattern& pattern, const SimilarityParams& p) {
+    int length = std::max(1, std::min(MAX_STEPS, p.patternLength));
+    SequenceStep steps[MAX_STEPS];
+    int lastNote = -1;
+    for (int s = 0; s < length; s++) {
+        steps[s] = pattern.getStep(s, p.density, p.spread, p.accentDensity, p.slideDensity);
+        if (!steps[s].isRest()) {
+            lastNote = s;
+        }
+    }
+
+    // Contour of the loop; the first note compares against the last one
+    PatternSignature sig;
+    int prevPitch = lastNote >= 0 ? steps[lastNote].octave * SCALE_SIZE + steps[lastNote].note : 0;
+    for (int s = 0; s < length; s++) {
+        const SequenceStep& step = steps[s];
+        if (step.isRest()) {
+            continue;
+        }
+        uint64_t bit = 1ull << s;
+        int pitch = step.octave * SCALE_SIZE + step.note;
+        sig.words[SIG_RHYTHM] |= bit;
+        if (pitch > prevPitch) sig.words[SIG_UP] |= bit;
+        if (pitch < prevPitch) sig.words[SIG_DOWN] |= bit;
+        if (step.accent) sig.words[SIG_ACCENT] |= bit;
+        if (step.slide) sig.words[SIG_SLIDE] |= bit;
+        prevPitch = pitch;
+    }
+    return sig;
+}
+
+//-----------------------------------------------------------------------------
+// SimilarityIndex - Exact k-nearest search over a seed range
+//-----------------------------------------------------------------------------
+// Multi-index hashing: the signature's 5 x length meaningful bits, taken step
+// by step across all lanes, are cut into numTables substrings of up to 32 bits
+// and each substring has its own sorted table. Two signatures at distance d
+// agree within floor(d / numTables) bits on at least one substring, so probing
+// every table for keys up to radius r away finds every item closer than
+// numTables * (r + 1). The search widens r until the k-th best distance is
+// below that bound, so results are exact.
+//
+// Signature bits carry roughly half a bit of entropy each (downbeats nearly
+// always play, accents and slides are sparse), so substrings are kept wide:
+// at 16 bits a 16-step index degenerates into a few huge buckets. Each table
+// is (key, id) pairs sorted by key, with a directory on the top key bits to
+// narrow the binary search.
+
+struct SimilarNeighbor {
+    uint32_t seed;
+    int distance;
+};
+
+struct SimilarityIndex {
+    static constexpr int MAX_SUBSTRING_BITS = 32;
+    static constexpr int DIRECTORY_BITS = 16;
+    // Past this radius, probing costs more than a linear scan
+    static constexpr int MAX_PROBE_RADIUS = 3;
+
+    struct Table {
+        std::vector<uint32_t> keys;       // Sorted
+        std::vector<uint32_t> ids;        // ids[j] has substring keys[j]
+        std::vector<uint32_t> directory;  // First j per top-bits prefix, plus an end entry
+    };
+
+    uint32_t firstSeed = 0;
+    SimilarityParams params;
+    std::vector<PatternSignature> signatures;  // signatures[i] is seed firstSeed + i
+    std::vector<Table> tables;
+
+    size_t size() const {
+        return signatures.size();
+    }
+
+    int signatureBits() const {
+        return SIGNATURE_WORDS * std::max(1, std::min(MAX_STEPS, params.patternLength));
+    }
+
+    int numTables() const {
+        return (signatureBits() + MAX_SUBSTRING_BITS - 1) / MAX_SUBSTRING_BITS;
+    }
+
+    // Tables split the bits as evenly as possible
+    int tableBegin(int table) const {
+        return signatureBits() * table / numTables();
+    }
+
+    int tableBits(int table) const {
+        return tableBegin(table + 1) - tableBegin(table);
+    }
+
+    int directoryShift(int table) const {
+        return std::max(0, tableBits(table) - DIRECTORY_BITS);
+    }
+
+    // Bit i of the interleaved signature is step i / 5 of lane i % 5
+    uint32_t substring(const PatternSignature& sig, int table) const {
+        uint32_t key = 0;
+        int begin = tableBegin(table);
+        int bits = tableBits(table);
+        for (int j = 0; j < bits; j++) {
+            int i = begin + j;
+            key |= static_cast<uint32_t>((sig.words[i % SIGNATURE_WORDS] >> (i / SIGNATURE_WORDS)) & 1) << j;
+        }
+        return key;
+    }
+
+    // Fingerprint seeds [first, first + count) and build the tables.
+    // Work is split over `threads` workers (0 = all cores).
+    void build(uint32_t first, uint32_t count, const SimilarityParams& p, unsigned threads = 0) {
+        firstSeed = first;
+        params = p;
+        signatures.assign(count, PatternSignature());
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        parallelFor(threads, count, [&](uint32_t begin, uint32_t end) {
+            MasterPattern pattern;
+            for (uint32_t i = begin; i < end; i++) {
+                generateMaster(first + i, pattern);
+                signatures[i] = computeSignature(pattern, params);
+            }
+        });
+        buildTables(threads);
+    }
+
+    // Sorts each table's (key, id) pairs, one table per task
+    void buildTables(unsigned threads) {
+        uint32_t count = static_cast<uint32_t>(signatures.size());
+        tables.assign(numTables(), Table());
+        parallelFor(threads, numTables(), [&](uint32_t begin, uint32_t end) {
+            std::vector<uint64_t> pairs(count);
+            for (uint32_t t = begin; t < end; t++) {
+                for (uint32_t i = 0; i < count; i++) {
+                    pairs[i] = (static_cast<uint64_t>(substring(signatures[i], t)) << 32) | i;
+                }
+                std::sort(pairs.begin(), pairs.end());
+
+                Table& table = tables[t];
+                table.keys.resize(count);
+                table.ids.resize(count);
+                for (uint32_t i = 0; i < count; i++) {
+                    table.keys[i] = static_cast<uint32_t>(pairs[i] >> 32);
+                    table.ids[i] = static_cast<uint32_t>(pairs[i]);
+                }
+                buildDirectory(t);
+            }
+        });
+    }
+
+    // k nearest seeds, closest first; ties go to the lower seed
+    std::vector<SimilarNeighbor> nearest(const PatternSignature& query, int k) const {
+        std::vector<SimilarNeighbor> best;
+        if (k <= 0 || signatures.empty()) {
+            return best;
+        }
+        k = std::min<int>(k, static_cast<int>(signatures.size()));
+
+        auto closer = [](const SimilarNeighbor& a, const SimilarNeighbor& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.seed < b.seed;
+        };
+        // Max-heap on (distance, seed): best.front() is the current k-th
+        auto consider = [&](uint32_t id) {
+            SimilarNeighbor n = {firstSeed + id, hammingDistance(query, signatures[id])};
+            if (static_cast<int>(best.size()) < k) {
+                best.push_back(n);
+                std::push_heap(best.begin(), best.end(), closer);
+            } else if (closer(n, best.front())) {
+                std::pop_heap(best.begin(), best.end(), closer);
+                best.back() = n;
+                std::push_heap(best.begin(), best.end(), closer);
+            }
+        };
+
+        // One bit per indexed seed, so each candidate is scored once
+        std::vector<uint64_t> checked((signatures.size() + 63) / 64, 0);
+        auto firstVisit = [&](uint32_t id) {
+            uint64_t bit = 1ull << (id & 63);
+            bool fresh = !(checked[id >> 6] & bit);
+            checked[id >> 6] |= bit;
+            return fresh;
+        };
+
+        int numTab = numTables();
+        bool exact = false;
+        for (int r = 0; r <= MAX_PROBE_RADIUS && !exact; r++) {
+            for (int t = 0; t < numTab; t++) {
+                const Table& table = tables[t];
+                uint32_t key = substring(query, t);
+                int shift = directoryShift(t);
+                forEachMaskOfWeight(r, tableBits(t), [&](uint32_t flip) {
+                    uint32_t probe = key ^ flip;
+                    uint32_t prefix = probe >> shift;
+                    auto lo = table.keys.begin() + table.directory[prefix];
+                    auto hi = table.keys.begin() + table.directory[prefix + 1];
+                    for (auto it = std::lower_bound(lo, hi, probe); it != hi && *it == probe; ++it) {
+                        uint32_t id = table.ids[it - table.keys.begin()];
+                        if (firstVisit(id)) {
+                            consider(id);
+                        }
+                    }
+                });
+            }
+            exact = static_cast<int>(best.size()) == k && best.front().distance < numTab * (r + 1);
+        }
+
+        if (!exact) {
+            // Query far from everything: fall back to a scan
+            for (uint32_t id = 0; id < signatures.size(); id++) {
+                if (firstVisit(id)) {
+                    consider(id);
+                }
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end(), closer);
+        return best;
+    }
+
+    // Reference search: scans every signature
+    std::vector<SimilarNeighbor> nearestLinear(const PatternSignature& query, int k) const {
+        std::vector<SimilarNeighbor> all;
+        all.reserve(signatures.size());
+        for (uint32_t id = 0; id < signatures.size(); id++) {
+            all.push_back({firstSeed + id, hammingDistance(query, signatures[id])});
+        }
+        k = std::max(0, std::min<int>(k, static_cast<int>(all.size())));
+        std::partial_sort(all.begin(), all.begin() + k, all.end(), [](const SimilarNeighbor& a, const SimilarNeighbor& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.seed < b.seed;
+        });
+        all.resize(k);
+        return all;
+    }
+
+    //-------------------------------------------------------------------------
+    // Persistence: header, then the raw arrays in host byte order (an index is
+    // a local cache; the byte-order mark rejects files from other hosts).
+    // Directories are rebuilt on load.
+    //-------------------------------------------------------------------------
+
+    static constexpr char FILE_MAGIC[8] = {'A', 'C', 'I', 'D', 'S', 'I', 'M', '1'};
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    bool save(const char* path) const {
+        FILE* f = std::fopen(path, "wb");
+        if (!f) {
+            return false;
+        }
+        uint32_t count = static_cast<uint32_t>(signatures.size());
+        uint32_t header[4] = {BYTE_ORDER_MARK, firstSeed, count, static_cast<uint32_t>(params.patternLength)};
+        float knobs[4] = {params.density, params.spread, params.accentDensity, params.slideDensity};
+        bool ok = std::fwrite(FILE_MAGIC, 1, 8, f) == 8 &&
+                  std::fwrite(header, sizeof(header), 1, f) == 1 &&
+                  std::fwrite(knobs, sizeof(knobs), 1, f) == 1 &&
+                  std::fwrite(signatures.data(), sizeof(PatternSignature), count, f) == count;
+        for (const Table& table : tables) {
+            ok = ok && std::fwrite(table.keys.data(), sizeof(uint32_t), count, f) == count &&
+                 std::fwrite(table.ids.data(), sizeof(uint32_t), count, f) == count;
+        }
+        return std::fclose(f) == 0 && ok;
+    }
+
+    bool load(const char* path) {
+        FILE* f = std::fopen(path, "rb");
+        if (!f) {
+            return false;
+        }
+        char magic[8];
+        uint32_t header[4];
+        float knobs[4];
+        bool ok = std::fread(magic, 1, 8, f) == 8 && std::equal(magic, magic + 8, FILE_MAGIC) &&
+                  std::fread(header, sizeof(header), 1, f) == 1 && header[0] == BYTE_ORDER_MARK &&
+                  std::fread(knobs, sizeof(knobs), 1, f) == 1 &&
+                  header[3] >= 1 && header[3] <= static_cast<uint32_t>(MAX_STEPS);
+        uint32_t count = ok ? header[2] : 0;
+        if (ok) {
+            firstSeed = header[1];
+            params.patternLength = static_cast<int>(header[3]);
+            params.density = knobs[0];
+            params.spread = knobs[1];
+            params.accentDensity = knobs[2];
+            params.slideDensity = knobs[3];
+            signatures.resize(count);
+            ok = std::fread(signatures.data(), sizeof(PatternSignature), count, f) == count;
+            tables.assign(numTables(), Table());
+        }
+        for (int t = 0; ok && t < numTables(); t++) {
+            Table& table = tables[t];
+            table.keys.resize(count);
+            table.ids.resize(count);
+            ok = std::fread(table.keys.data(), sizeof(uint32_t), count, f) == count &&
+                 std::fread(table.ids.data(), sizeof(uint32_t), count, f) == count &&
+                 std::is_sorted(table.keys.begin(), table.keys.end());
+            if (ok) {
+                buildDirectory(t);
+            }
+        }
+        std::fclose(f);
+        if (!ok) {
+            *this = SimilarityIndex();
+        }
+        return ok;
+    }
+
+private:
+    void buildDirectory(int t) {
+        Table& table = tables[t];
+        int shift = directoryShift(t);
+        uint32_t prefixes = 1u << (tableBits(t) - shift);
+        table.directory.assign(prefixes + 1, 0);
+        uint32_t j = 0;
+        for (uint32_t prefix = 0; prefix <= prefixes; prefix++) {
+            while (j < table.keys.size() && (table.keys[j] >> shift) < prefix) {
+                j++;
+            }
+            table.directory[prefix] = j;
+        }
+    }
+
+    // Calls f(mask) for every `bits`-bit mask with `weight` bits set
+    template <typename F>
+    static void forEachMaskOfWeight(int weight, int bits, F&& f) {
+        if (weight == 0) {
+            f(0u);
+            return;
+        }
+        if (weight > bits) {
+            return;
+        }
+        uint64_t mask = (1ull << weight) - 1;
+        while (mask < (1ull << bits)) {
+            f(static_cast<uint32_t>(mask));
+            // Next mask with the same popcount (Gosper's hack)
+            uint64_t c = mask & (~mask + 1);
+            uint64_t r = mask + c;
+            mask = (((r ^ mask) >> 2) / c) | r;
+        }
+    }
+
+    // Splits [0, n) into contiguous ranges, one per thread
+    template <typename F>
+    static void parallelFor(unsigned threads, uint32_t n, F&& f) {
+        threads = std::max(1u, std::min<unsigned>(threads, n));
+        if (threads == 1) {
+            f(0u, n);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(n) * t / threads);
+            uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(n) * (t + 1) / threads);
+            workers.emplace_back([&f, begin, end] { f(begin, end); });
+        }
+        for (std::thread& w : workers) {
+            w.join();
+        }
+    }
+};
+
+} // namespace AcidGenerator
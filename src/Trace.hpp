@@ -0,0 +1,274 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Trace - Optional timing of process() sections and event counters
+//-----------------------------------------------------------------------------
+// Compiled in only with -DACIDSEQ_TRACE (make TRACE=1). Without it the
+// ACID_TRACE_* macros expand to nothing and the module carries no stats.
+//
+// The audio thread is the only writer: it records with relaxed loads and
+// stores, never read-modify-write or locks. The UI thread reads the same
+// atomics for the context menu and the dump file. A reset is requested by
+// the UI and carried out by the audio thread on its next process() call.
+//
+//   ACID_TRACE_SCOPE(traceStats, TRACE_LIGHTS);     // times to end of block
+//   ACID_TRACE_EVENT(traceStats, TRACE_GENERATE);   // counts one event
+//   ACID_TRACE_POLL(traceStats);                    // once per process()
+
+namespace AcidGenerator {
+
+// Timestamp in the cheapest monotonic unit the target has: TSC reference
+// cycles on x86, the virtual counter on arm64, nanoseconds elsewhere
+inline uint64_t traceTimestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+constexpr const char* TRACE_UNIT = "cycles";
+#elif defined(__aarch64__)
+constexpr const char* TRACE_UNIT = "ticks";
+#else
+constexpr const char* TRACE_UNIT = "ns";
+#endif
+
+//-----------------------------------------------------------------------------
+// LogHistogram - Single-writer histogram of non-negative integer samples
+//-----------------------------------------------------------------------------
+// Values below 2^SubBits have their own buckets; above that each power of two
+// is split into 2^SubBits sub-buckets, so a percentile is within 1/2^SubBits
+// of the true value (25% for LogHistogram, 6% with 4 sub-bits).
+//
+// Buckets cover values below 2^MaxBits. Anything larger is counted in the
+// last bucket (min, max and mean stay exact), so a histogram of small values
+// can drop the upper octaves it would never use.
+
+template <int SubBits, int MaxBits = 64>
+struct BasicLogHistogram {
+    static_assert(MaxBits > SubBits && MaxBits <= 64, "MaxBits must be in (SubBits, 64]");
+    static constexpr int SUB_BITS = SubBits;
+    static constexpr int MAX_BITS = MaxBits;
+    static constexpr int SUBS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUBS;
+
+    std::atomic<uint32_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+
+    static int bucketOf(uint64_t v) {
+        if (v < SUBS) {
+            return static_cast<int>(v);
+        }
+        if constexpr (MAX_BITS < 64) {
+            if (v >> MAX_BITS) {
+                return BUCKETS - 1;
+            }
+        }
+        int msb = 63 - __builtin_clzll(v);
+        int sub = static_cast<int>((v >> (msb - SUB_BITS)) & (SUBS - 1));
+        return (msb - SUB_BITS + 1) * SUBS + sub;
+    }
+
+    // Smallest value that lands in bucket b
+    static uint64_t bucketLow(int b) {
+        if (b < SUBS) {
+            return static_cast<uint64_t>(b);
+        }
+        int msb = b / SUBS + SUB_BITS - 1;
+        return static_cast<uint64_t>(SUBS + b % SUBS) << (msb - SUB_BITS);
+    }
+
+    // Audio thread only
+    void record(uint64_t v) {
+        std::atomic<uint32_t>& c = counts[bucketOf(v)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+        if (v < min.load(std::memory_order_relaxed)) {
+            min.store(v, std::memory_order_relaxed);
+        }
+        if (v > max.load(std::memory_order_relaxed)) {
+            max.store(v, std::memory_order_relaxed);
+        }
+    }
+
+    // Audio thread only (or while the writer is idle)
+    void clear() {
+        for (std::atomic<uint32_t>& c : counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(UINT64_MAX, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Lower bound of the bucket holding the p-th percentile (0-100). Readers
+    // may see a sample in one counter before another; that only shifts the
+    // estimate by the samples recorded during the read.
+    uint64_t percentile(double p) const {
+        uint64_t n = 0;
+        for (const std::atomic<uint32_t>& c : counts) {
+            n += c.load(std::memory_order_relaxed);
+        }
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(n - 1));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                return bucketLow(b);
+            }
+        }
+        return max.load(std::memory_order_relaxed);
+    }
+};
+
+using LogHistogram = BasicLogHistogram<2>;
+
+//-----------------------------------------------------------------------------
+// TraceStats - Per-instance section timings and event counts
+//-----------------------------------------------------------------------------
+
+enum TraceSection {
+    TRACE_PROCESS,      // Whole process() call
+    TRACE_CLOCK_EDGE,   // Advance, recorder, MIDI and playStep on a clock edge
+    TRACE_ENGINE,       // Sequencer::process: glide, gate/accent pulses, sweep
+    TRACE_OUTPUTS,      // Output voltages and MIDI note-off
+    TRACE_VOICE,        // Integrated voice (only while AUDIO is patched)
+    TRACE_LIGHTS,
+    TRACE_DISPLAY,      // Display pattern re-resolve (only when knobs moved)
+    TRACE_SECTIONS
+};
+
+enum TraceEvent {
+    TRACE_GENERATE,
+    TRACE_RESET,
+    TRACE_CLOCK,
+    TRACE_CLOCK_DROPPED,  // Edge the period tracker ignores: < 10ms or > 2s since the last
+                          // (includes the first edge and restarts after a stop)
+    TRACE_RECORD_COMMIT,
+    TRACE_EVENTS
+};
+
+inline const char* traceSectionName(int section) {
+    static const char* names[TRACE_SECTIONS] = {"process", "clock edge", "engine", "outputs",
+                                                "voice", "lights", "display"};
+    return names[section];
+}
+
+inline const char* traceEventName(int event) {
+    static const char* names[TRACE_EVENTS] = {"generate", "reset", "clock", "dropped clock", "record commit"};
+    return names[event];
+}
+
+struct TraceStats {
+    LogHistogram sections[TRACE_SECTIONS];
+    std::atomic<uint64_t> events[TRACE_EVENTS] = {};
+    std::atomic<bool> resetRequested{false};
+
+    // Audio thread
+    void count(TraceEvent e) {
+        events[e].store(events[e].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Audio thread: carry out a reset requested from the UI
+    void poll() {
+        if (resetRequested.load(std::memory_order_acquire)) {
+            for (LogHistogram& h : sections) {
+                h.clear();
+            }
+            for (std::atomic<uint64_t>& e : events) {
+                e.store(0, std::memory_order_relaxed);
+            }
+            resetRequested.store(false, std::memory_order_release);
+        }
+    }
+
+    std::string sectionLine(int section) const {
+        const LogHistogram& h = sections[section];
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-10s n %-9llu mean %-7.0f p50 %-6llu p99 %-6llu max %llu",
+                      traceSectionName(section), static_cast<unsigned long long>(h.count()), h.mean(),
+                      static_cast<unsigned long long>(h.percentile(50)),
+                      static_cast<unsigned long long>(h.percentile(99)),
+                      static_cast<unsigned long long>(h.max.load(std::memory_order_relaxed)));
+        return line;
+    }
+
+    std::string eventLine(int event) const {
+        return std::string(traceEventName(event)) + ": " +
+               std::to_string(events[event].load(std::memory_order_relaxed));
+    }
+
+    // Plain-text report, as written by the dump action
+    std::string report() const {
+        std::string s = std::string("section timings (") + TRACE_UNIT + ")\n";
+        for (int i = 0; i < TRACE_SECTIONS; i++) {
+            s += "  " + sectionLine(i) + "\n";
+        }
+        s += "events\n";
+        for (int i = 0; i < TRACE_EVENTS; i++) {
+            s += "  " + eventLine(i) + "\n";
+        }
+        return s;
+    }
+};
+
+// Records the time from construction to the end of the enclosing block
+struct TraceScope {
+    LogHistogram& histogram;
+    uint64_t start;
+
+    explicit TraceScope(LogHistogram& h) : histogram(h), start(traceTimestamp()) {}
+    ~TraceScope() {
+        histogram.record(traceTimestamp() - start);
+    }
+};
+
+} // namespace AcidGenerator
+
+#define ACID_TRACE_CONCAT2(a, b) a##b
+#define ACID_TRACE_CONCAT(a, b) ACID_TRACE_CONCAT2(a, b)
+
+#ifdef ACIDSEQ_TRACE
+#define ACID_TRACE_SCOPE(stats, section) \
+    ::AcidGenerator::TraceScope ACID_TRACE_CONCAT(acidTraceScope, __LINE__)((stats).sections[section])
+#define ACID_TRACE_EVENT(stats, event) (stats).count(event)
+#define ACID_TRACE_POLL(stats) (stats).poll()
+#else
+#define ACID_TRACE_SCOPE(stats, section) do {} while (0)
+#define ACID_TRACE_EVENT(stats, event) do {} while (0)
+#define ACID_TRACE_POLL(stats) do {} while (0)
+#endif
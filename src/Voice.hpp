@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+namespace AcidGenerator {
+
+//-----------------------------------------------------------------------------
+// Integrated 303-style voice
+//-----------------------------------------------------------------------------
+// Renders audio straight from the sequencer's pitch/gate/accent state so one
+// AcidSeq can replace an external VCO -> VCF -> VCA -> envelope chain:
+//
+//   - Saw/square oscillator with PolyBLEP step correction
+//   - 4-pole diode ladder filter, run at 2x the engine rate and brought
+//     back down through a polyphase allpass half-band filter
+//   - VEG (amp) follows the gate; MEG (filter) retriggers on non-slid notes
+//   - Accent raises level, shortens the MEG and adds the accent sweep to cutoff
+//
+// The ladder keeps its four stage voltages in the lanes of a 4-wide vector
+// type T (simd::float_4 in the plugin) so every stage updates in one pass.
+
+constexpr float VOICE_FREQ_C4 = 261.6256f;  // 0V pitch, VCV Rack convention
+
+constexpr float VOICE_TWO_PI = 6.2831853f;
+
+// Rational tanh approximation, exact at +/-3 where it saturates to +/-1.
+// The vector overload finds clamp() by ADL (simd::clamp for simd::float_4).
+inline float voiceTanh(float x) {
+    x = std::max(-3.f, std::min(3.f, x));
+    return x * (27.f + x * x) / (27.f + 9.f * x * x);
+}
+
+template <typename T>
+T voiceTanh(T x) {
+    x = clamp(x, T(-3.f), T(3.f));
+    return x * (27.f + x * x) / (27.f + 9.f * x * x);
+}
+
+// PolyBLEP residual for a unit step at phase 0 (t in [0, 1), dt = phase increment)
+inline float polyBlep(float t, float dt) {
+    if (t < dt) {
+        t /= dt;
+        return t + t - t * t - 1.f;
+    }
+    if (t > 1.f - dt) {
+        t = (t - 1.f) / dt;
+        return t * t + t + t + 1.f;
+    }
+    return 0.f;
+}
+
+//-----------------------------------------------------------------------------
+// DiodeLadder - 4-pole diode ladder, one stage per vector lane
+//-----------------------------------------------------------------------------
+// Each stage capacitor is fed by the diode pair above it and drained by the
+// pair below it; the last stage has nothing below. With explicit Euler steps
+// all four stages read the previous state, so the update is a single vector
+// expression:
+//
+//   above = (in - k*s3, s0, s1, s2)
+//   below = (s1, s2, s3, s3)            // last lane: tanh(0) = 0, no drain
+//   s    += g * (tanh(above - s) - tanh(s - below))
+//
+// Stable for g <= 0.5. Self-oscillation starts around k = 16.
+
+template <typename T>
+struct DiodeLadder {
+    T s = 0.f;  // Stage voltages, lane i = stage i
+
+    void reset() {
+        s = 0.f;
+    }
+
+    float process(float in, float g, float k) {
+        T above(in - k * s[3], s[0], s[1], s[2]);
+        T below(s[1], s[2], s[3], s[3]);
+        s += g * (voiceTanh(above - s) - voiceTanh(s - below));
+        return s[3];
+    }
+};
+
+//-----------------------------------------------------------------------------
+// HalfbandDecimator - 2x to 1x through a two-path polyphase allpass
+//-----------------------------------------------------------------------------
+// Each path is a chain of first-order allpasses at the base rate; one is fed
+// the later sample of each oversampled pair, the other the earlier one, and
+// their mean is the half-band lowpass:
+//
+//   out = (A0(z) x[2n+1] + A1(z) x[2n]) / 2
+//   Ai  = product over path i's coefficients of (c + z^-1) / (1 + c z^-1)
+//
+// Six coefficients (elliptic design, transition band 0.05 of the oversampled
+// rate, alternating between the paths) keep the passband flat to 0.4 fs and
+// reject 80 dB from 0.6 fs, so what the ladder and oscillator put between
+// fs/2 and fs doesn't fold back. The phase is not linear, which a 303 doesn't
+// mind. Six multiplies per output sample.
+
+struct HalfbandDecimator {
+    static constexpr int COEFS = 6;
+    static constexpr float COEF[COEFS] = {
+        0.060297391f, 0.215971445f, 0.412590720f, 0.604358626f, 0.772715654f, 0.923886139f,
+    };
+
+    float x[COEFS] = {};  // Allpass input and output history; even entries path 0
+    float y[COEFS] = {};
+
+    void reset() {
+        for (int i = 0; i < COEFS; i++) {
+            x[i] = 0.f;
+            y[i] = 0.f;
+        }
+    }
+
+    // One base-rate sample from an oversampled pair, earlier sample first
+    float process(float first, float second) {
+        float a = second;
+        float b = first;
+        for (int i = 0; i < COEFS; i += 2) {
+            float outA = (a - y[i]) * COEF[i] + x[i];
+            x[i] = a;
+            y[i] = outA;
+            a = outA;
+            float outB = (b - y[i + 1]) * COEF[i + 1] + x[i + 1];
+            x[i + 1] = b;
+            y[i + 1] = outB;
+            b = outB;
+        }
+        return 0.5f * (a + b);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// VoiceParams - Normalized voice controls (0-1)
+//-----------------------------------------------------------------------------
+
+struct VoiceParams {
+    float cutoff = 0.4f;      // Base cutoff, 60Hz..7.7kHz exponential
+    float resonance = 0.5f;   // Ladder feedback
+    float envMod = 0.5f;      // MEG depth, up to +4 octaves
+    float decay = 0.3f;       // MEG decay, 0.2s..2s (accented notes use 0.2s)
+    float accent = 0.5f;      // Accent level boost and sweep depth
+    bool square = false;      // Square instead of saw
+};
+
+//-----------------------------------------------------------------------------
+// AcidVoice - Oscillator, ladder and envelopes
+//-----------------------------------------------------------------------------
+
+template <typename T>
+struct AcidVoice {
+    static constexpr int OVERSAMPLE = 2;
+    static constexpr float MAX_RESONANCE = 15.f;   // Just below self-oscillation
+    static constexpr float AMP_ATTACK_TIME = 0.003f;
+    static constexpr float AMP_RELEASE_TIME = 0.008f;
+    static constexpr float ACCENT_DECAY_TIME = 0.2f;
+    static constexpr float OUTPUT_LEVEL = 5.f;     // +/-5V audio
+    static_assert(OVERSAMPLE == 2, "HalfbandDecimator takes oversampled pairs");
+
+    DiodeLadder<T> ladder;
+    float phase = 0.f;
+    float ampEnv = 0.f;
+    float filterEnv = 0.f;
+    bool lastGate = false;
+    bool noteAccent = false;       // Latched at note start, like the 303
+    HalfbandDecimator decimator;   // Oversampled ladder output back to the engine rate
+
+    // Per-sample coefficients, refreshed in setSampleRate()
+    float sampleRate = 44100.f;
+    float ampAttackCoef = 0.f;
+    float ampReleaseCoef = 0.f;
+    float filterDecayTime = -1.f;  // MEG coefficient cache key
+    float filterDecayCoef = 0.f;
+
+    AcidVoice() {
+        setSampleRate(44100.f);
+    }
+
+    void setSampleRate(float sr) {
+        sampleRate = sr;
+        ampAttackCoef = std::exp(-1.f / (AMP_ATTACK_TIME * sr));
+        ampReleaseCoef = std::exp(-1.f / (AMP_RELEASE_TIME * sr));
+        filterDecayTime = -1.f;
+    }
+
+    void reset() {
+        ladder.reset();
+        phase = 0.f;
+        ampEnv = 0.f;
+        filterEnv = 0.f;
+        lastGate = false;
+        decimator.reset();
+    }
+
+    // pitch: 1V/oct (0V = C4), accentSweep: 0-1 from AccentSweep
+    float process(float pitch, bool gate, bool accent, float accentSweep, const VoiceParams& p) {
+        // --- Envelopes (engine rate) ---
+        if (gate && !lastGate) {
+            // New note: the MEG retriggers; slid notes keep the gate high and don't
+            filterEnv = 1.f;
+            noteAccent = accent;
+        }
+        lastGate = gate;
+
+        ampEnv = gate ? 1.f - (1.f - ampEnv) * ampAttackCoef : ampEnv * ampReleaseCoef;
+
+        float decayTime = noteAccent ? ACCENT_DECAY_TIME : 0.2f + 1.8f * p.decay;
+        if (decayTime != filterDecayTime) {
+            filterDecayTime = decayTime;
+            filterDecayCoef = std::exp(-1.f / (decayTime * sampleRate));
+        }
+        filterEnv *= filterDecayCoef;
+
+        // --- Filter coefficients ---
+        float accentAmount = noteAccent ? p.accent : 0.f;
+        float octaves = 7.f * p.cutoff + 4.f * p.envMod * filterEnv + 2.f * p.accent * accentSweep;
+        float cutoffHz = 60.f * std::exp2(octaves);
+        float osRate = sampleRate * OVERSAMPLE;
+        float g = std::min(0.5f, 1.f - std::exp(-VOICE_TWO_PI * cutoffHz / osRate));
+        float k = MAX_RESONANCE * p.resonance;
+
+        // --- Oscillator + ladder (oversampled) ---
+        float dt = std::min(0.5f, VOICE_FREQ_C4 * std::exp2(pitch) / osRate);
+        float os[OVERSAMPLE];
+        for (int i = 0; i < OVERSAMPLE; i++) {
+            phase += dt;
+            if (phase >= 1.f) phase -= 1.f;
+
+            float osc;
+            if (p.square) {
+                osc = (phase < 0.5f ? 1.f : -1.f) + polyBlep(phase, dt);
+                float shifted = phase + 0.5f;
+                osc -= polyBlep(shifted >= 1.f ? shifted - 1.f : shifted, dt);
+            } else {
+                osc = 2.f * phase - 1.f - polyBlep(phase, dt);
+            }
+
+            // Feedback steals low end; make some of it back
+            os[i] = ladder.process(osc, g, k) * (1.f + 0.25f * k);
+        }
+        float out = decimator.process(os[0], os[1]);
+
+        return out * ampEnv * (1.f + accentAmount) * OUTPUT_LEVEL;
+    }
+};
+
+} // namespace AcidGenerator
@@ -0,0 +1,172 @@
+/*-----------------------------------------------------------------------------
+ * acidgen-test - libacidgen through its C API, compiled as C
+ *-----------------------------------------------------------------------------
+ * Checks the API contract: argument errors, event timing and carry-over
+ * between blocks, determinism per seed, step resolution against the PITCH
+ * output, and that a serialized engine restores to the same output and
+ * rejects damaged state. Parity with the module itself is in module-test.
+ */
+
+#include "../lib/acidgen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000.f
+#define STEP_FRAMES 6000  /* 16ths at 120 BPM */
+#define BLOCK 512
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+/* Clocks at every STEP_FRAMES from absolute frame `start`, in BLOCK chunks */
+static void run(acidgen_engine* e, float* out, long start, long frames) {
+    for (long done = 0; done < frames; done += BLOCK) {
+        int n = frames - done < BLOCK ? (int)(frames - done) : BLOCK;
+        for (long f = start + done; f < start + done + n; f++) {
+            if (f % STEP_FRAMES == 0) {
+                acidgen_push_event(e, ACIDGEN_EVENT_CLOCK, (int)(f - start - done), 0);
+            }
+        }
+        acidgen_process(e, out + done * ACIDGEN_OUTPUTS, n);
+    }
+}
+
+int main(void) {
+    const long frames = 32L * STEP_FRAMES;
+    float* a = malloc(sizeof(float) * ACIDGEN_OUTPUTS * frames);
+    float* b = malloc(sizeof(float) * ACIDGEN_OUTPUTS * frames);
+    acidgen_params p;
+    acidgen_step step;
+    int i;
+
+    check(acidgen_api_version() == ACIDGEN_API_VERSION, "API version");
+    check(acidgen_num_scales() == 24 && acidgen_scale_name(0) && !acidgen_scale_name(24), "scale names");
+    check(acidgen_create(0.f, 1) == NULL, "create rejects a zero sample rate");
+
+    acidgen_engine* e = acidgen_create(SAMPLE_RATE, 42);
+    acidgen_engine* f = acidgen_create(SAMPLE_RATE, 42);
+    check(acidgen_process(NULL, a, 1) == ACIDGEN_ERR_ARG && acidgen_push_event(e, ACIDGEN_EVENT_CLOCK, -1, 0) ==
+          ACIDGEN_ERR_ARG && acidgen_resolve_step(e, 64, &step) == ACIDGEN_ERR_ARG, "argument errors");
+
+    /* A struct_size the library can't honour is refused */
+    p.struct_size = ACIDGEN_PARAMS_SIZE_V1 - 1;
+    check(acidgen_default_params(&p) == ACIDGEN_ERR_ARG && acidgen_set_params(e, &p) == ACIDGEN_ERR_ARG &&
+          acidgen_get_params(e, &p) == ACIDGEN_ERR_ARG, "short struct_size refused");
+    p.struct_size = sizeof(p) + 1;
+    check(acidgen_set_params(e, &p) == ACIDGEN_ERR_ARG, "unknown struct_size refused");
+
+    /* Clamped to the knob ranges, NaN refused */
+    p.struct_size = sizeof(p);
+    acidgen_default_params(&p);
+    p.density = 150.f;
+    p.pattern_length = 0;
+    acidgen_set_params(e, &p);
+    acidgen_get_params(e, &p);
+    check(p.density == 100.f && p.pattern_length == 1, "params clamped");
+    p.spread = 0.f / 0.f;
+    check(acidgen_set_params(e, &p) == ACIDGEN_ERR_ARG, "NaN param refused");
+
+    /* A caller built before chance existed gets CHANCE off */
+    acidgen_default_params(&p);
+    p.chance = 50.f;
+    acidgen_set_params(e, &p);
+    p.struct_size = ACIDGEN_PARAMS_SIZE_V1;
+    acidgen_set_params(e, &p);
+    p.struct_size = sizeof(p);
+    acidgen_get_params(e, &p);
+    check(p.chance == 0.f, "older params leave chance off");
+
+    acidgen_default_params(&p);
+    p.density = 100.f;
+    p.slide = 40.f;
+    p.accent = 40.f;
+    acidgen_set_params(e, &p);
+    acidgen_set_params(f, &p);
+
+    /* An edge at offset 300 of the second block starts the gate right there */
+    acidgen_engine* t = acidgen_create(SAMPLE_RATE, 42);
+    acidgen_push_event(t, ACIDGEN_EVENT_CLOCK, BLOCK + 300, 0);
+    acidgen_process(t, a, BLOCK);
+    check(acidgen_current_step(t) == -1 && a[ACIDGEN_OUTPUTS * (BLOCK - 1) + ACIDGEN_OUT_GATE] == 0.f,
+          "event held for its block");
+    acidgen_process(t, a, BLOCK);
+    check(acidgen_current_step(t) == 0 && a[ACIDGEN_OUTPUTS * 299 + ACIDGEN_OUT_GATE] == 0.f &&
+          a[ACIDGEN_OUTPUTS * 300 + ACIDGEN_OUT_GATE] == 10.f, "event carried over lands on its frame");
+    acidgen_destroy(t);
+
+    /* Same seed and events, same output; the pitch is the resolved step's
+     * once any slide into it has finished */
+    run(e, a, 0, frames);
+    run(f, b, 0, frames);
+    check(memcmp(a, b, sizeof(float) * ACIDGEN_OUTPUTS * frames) == 0, "same seed, same output");
+    acidgen_resolve_step(e, 3, &step);
+    check(!step.rest && a[ACIDGEN_OUTPUTS * (4L * STEP_FRAMES - 1) + ACIDGEN_OUT_PITCH] == step.pitch &&
+          step.pitch == step.midi_note / 12.0f, "resolved step matches PITCH");
+
+    acidgen_set_mute(e, 3, 1);
+    acidgen_resolve_step(e, 3, &step);
+    check(step.rest, "muted step resolves as a rest");
+    acidgen_set_mute(e, 3, 0);
+
+    /* GEN replaces the pattern and clears mutes */
+    acidgen_set_mute(e, 5, 1);
+    acidgen_push_event(e, ACIDGEN_EVENT_GENERATE, 10, 7);
+    acidgen_process(e, a, 20);
+    acidgen_generate(f, 7);
+    acidgen_resolve_step(e, 5, &step);
+    check(acidgen_seed(e) == 7 && !step.rest, "generate event");
+
+    /* Round trip mid-slide, with steps dropping: the restored engine
+     * continues identically, chance rolls included */
+    acidgen_get_params(e, &p);
+    p.chance = 60.f;
+    acidgen_set_params(e, &p);
+    run(e, a, 0, 5L * STEP_FRAMES + 100);
+    size_t size = acidgen_serialize(e, NULL, 0);
+    unsigned char* state = malloc(size);
+    check(acidgen_serialize(e, state, size) == size, "serialize");
+    acidgen_engine* g = acidgen_create(22050.f, 1);
+    check(acidgen_deserialize(g, state, size) == ACIDGEN_OK, "deserialize");
+    acidgen_push_event(e, ACIDGEN_EVENT_CLOCK, 0, 0);
+    acidgen_push_event(g, ACIDGEN_EVENT_CLOCK, 0, 0);
+    run(e, a, 1, frames);
+    acidgen_set_sample_rate(g, SAMPLE_RATE);
+    run(g, b, 1, frames);
+    /* Pitch follows at once; pulses and the sweep in flight are not saved,
+     * so everything matches once the sweep has discharged */
+    for (i = 0; i < frames && a[i * ACIDGEN_OUTPUTS] == b[i * ACIDGEN_OUTPUTS]; i++) {
+    }
+    check(i == frames && memcmp(a + 16L * STEP_FRAMES * ACIDGEN_OUTPUTS, b + 16L * STEP_FRAMES * ACIDGEN_OUTPUTS,
+                                sizeof(float) * ACIDGEN_OUTPUTS * (frames - 16L * STEP_FRAMES)) == 0 &&
+          acidgen_seed(g) == 7, "restored engine plays the same");
+
+    /* Damaged state is refused and leaves the engine as it was */
+    check(acidgen_deserialize(g, state, size - 1) == ACIDGEN_ERR_FORMAT, "truncated state refused");
+    state[16] = 99;  /* pattern length, after magic, version, seed and step */
+    check(acidgen_deserialize(g, state, size) == ACIDGEN_ERR_FORMAT, "out-of-range state refused");
+    state[0] = 'X';
+    check(acidgen_deserialize(g, state, size) == ACIDGEN_ERR_FORMAT && acidgen_seed(g) == 7, "bad magic refused");
+
+    /* Queue capacity */
+    for (i = 0; i < ACIDGEN_MAX_EVENTS; i++) {
+        acidgen_push_event(f, ACIDGEN_EVENT_CLOCK, i, 0);
+    }
+    check(acidgen_push_event(f, ACIDGEN_EVENT_CLOCK, 0, 0) == ACIDGEN_ERR_FULL, "queue full");
+
+    acidgen_destroy(e);
+    acidgen_destroy(f);
+    acidgen_destroy(g);
+    free(state);
+    free(a);
+    free(b);
+    printf("%s\n", failures ? "FAILED" : "all tests passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,1043 @@
+//-----------------------------------------------------------------------------
+// acidseq-test - Golden-vector regression tests and differential fuzzer
+//-----------------------------------------------------------------------------
+// Golden vectors (tests/golden/) pin the generator's output so saved patches
+// keep playing the same patterns. They are self-generated: --regen writes
+// whatever this C++ generator produces, so they catch regressions but do not
+// show parity with the JavaScript/TypeScript generator it was ported from. No
+// vectors from that reference are checked in.
+//
+//   master.golden    seed -> MasterPattern (generateMaster)
+//   pattern.golden   seed + knobs -> Pattern (legacy generate)
+//   resolve.golden   seed + knobs -> 64 resolved steps (generateMaster + getStep)
+//
+// Floats are stored as C99 hex floats, so comparisons are exact.
+//
+// The differential fuzzer runs every registered case (see DIFF_CASES) for a
+// number of random trials. A case compares a fast or alternative path with
+// the reference scalar code and reports the seed/params of the first mismatch.
+// New fast paths (SIMD, bitmask, LUT, batch) get a case here when they land.
+// Index-style structures (SimilarityIndex) are checked against their linear
+// reference the same way.
+//
+//   acidseq-test                      golden vectors + 100k fuzz trials per case
+//   acidseq-test --fuzz 5000000       more trials
+//   acidseq-test --fuzz-seed N        different fuzz stream
+//   acidseq-test --regen              rewrite the golden files (generator changes only!)
+
+#include "../src/Generator.hpp"
+#include "../src/Similarity.hpp"
+#include "../src/Features.hpp"
+#include "../src/Layer.hpp"
+#include "../src/Chance.hpp"
+#include "../src/PackedPattern.hpp"
+#include "../src/FixedSequencer.hpp"
+#include "../src/Trace.hpp"
+#include "../src/ClockStats.hpp"
+#include "../src/Voice.hpp"
+
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "golden"
+#endif
+
+using namespace AcidGenerator;
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Golden vector inputs
+//-----------------------------------------------------------------------------
+
+const uint32_t GOLDEN_SEEDS[] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    42, 1234, 12345, 65535, 65536, 1664525, 1013904223, 0x12345678,
+    0x7fffffff, 0x80000000, 0xdeadbeef, 0xcafebabe, 0xfffffffe, 0xffffffff,
+};
+
+struct Knobs {
+    float density, spread, accent, slide;
+};
+
+// Includes the x.5 rounding boundaries of the density (16 positions) and
+// spread (7 notes) counts
+const Knobs GOLDEN_KNOBS[] = {
+    {50.f, 50.f, 25.f, 15.f},      // Module defaults
+    {0.f, 0.f, 0.f, 0.f},
+    {100.f, 100.f, 100.f, 100.f},
+    {3.125f, 7.142857f, 50.f, 50.f},
+    {46.875f, 50.f, 10.f, 90.f},
+    {96.875f, 92.857143f, 33.f, 66.f},
+    {75.f, 28.57143f, 62.5f, 12.5f},
+    {12.5f, 100.f, 99.9f, 0.1f},
+};
+
+constexpr int GOLDEN_KNOB_SEEDS = 16;  // First N seeds are combined with every knob set
+
+//-----------------------------------------------------------------------------
+// Serialization (one record per line, whitespace separated)
+//-----------------------------------------------------------------------------
+
+std::string hexFloat(float v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%a", v);
+    return buf;
+}
+
+std::string knobsText(const Knobs& k) {
+    return hexFloat(k.density) + " " + hexFloat(k.spread) + " " + hexFloat(k.accent) + " " + hexFloat(k.slide);
+}
+
+std::string masterLine(uint32_t seed) {
+    MasterPattern m;
+    generateMaster(seed, m);
+    std::string line = std::to_string(seed) + " |";
+    for (int i = 0; i < BAR_LEN; i++) {
+        line += " " + std::to_string(m.barActivationOrder[i]);
+    }
+    line += " |";
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        line += " " + std::to_string(m.scalePriorityOrder[i]);
+    }
+    line += " |";
+    for (int i = 0; i < MAX_STEPS; i++) {
+        const MasterStep& s = m.steps[i];
+        line += " " + std::to_string(s.notePoolIndex) + " " + std::to_string(s.octave) + " " +
+                hexFloat(s.accentProb) + " " + hexFloat(s.slideProb);
+    }
+    return line;
+}
+
+std::string stepsText(const SequenceStep* steps) {
+    std::string text;
+    for (int i = 0; i < MAX_STEPS; i++) {
+        text += " " + std::to_string(steps[i].note) + " " + std::to_string(steps[i].octave) + " " +
+                (steps[i].accent ? "1" : "0") + " " + (steps[i].slide ? "1" : "0");
+    }
+    return text;
+}
+
+std::string patternLine(uint32_t seed, const Knobs& k) {
+    GeneratorParams params = {MAX_STEPS, k.density, k.spread, k.accent, k.slide, seed};
+    Pattern p;
+    generate(params, p);
+    return std::to_string(seed) + " " + knobsText(k) + " |" + stepsText(p.steps);
+}
+
+std::string resolveLine(uint32_t seed, const Knobs& k) {
+    MasterPattern m;
+    generateMaster(seed, m);
+    SequenceStep steps[MAX_STEPS];
+    for (int i = 0; i < MAX_STEPS; i++) {
+        steps[i] = m.getStep(i, k.density, k.spread, k.accent, k.slide);
+    }
+    return std::to_string(seed) + " " + knobsText(k) + " |" + stepsText(steps);
+}
+
+struct GoldenFile {
+    const char* name;
+    std::vector<std::string> (*build)();
+};
+
+std::vector<std::string> buildMaster() {
+    std::vector<std::string> lines;
+    for (uint32_t seed : GOLDEN_SEEDS) {
+        lines.push_back(masterLine(seed));
+    }
+    return lines;
+}
+
+std::vector<std::string> buildPattern() {
+    std::vector<std::string> lines;
+    for (int s = 0; s < GOLDEN_KNOB_SEEDS; s++) {
+        for (const Knobs& k : GOLDEN_KNOBS) {
+            lines.push_back(patternLine(GOLDEN_SEEDS[s], k));
+        }
+    }
+    return lines;
+}
+
+std::vector<std::string> buildResolve() {
+    std::vector<std::string> lines;
+    for (int s = 0; s < GOLDEN_KNOB_SEEDS; s++) {
+        for (const Knobs& k : GOLDEN_KNOBS) {
+            lines.push_back(resolveLine(GOLDEN_SEEDS[s], k));
+        }
+    }
+    return lines;
+}
+
+const GoldenFile GOLDEN_FILES[] = {
+    {"master.golden", buildMaster},
+    {"pattern.golden", buildPattern},
+    {"resolve.golden", buildResolve},
+};
+
+const char* GOLDEN_HEADER =
+    "# Generated by acidseq-test --regen. Do not edit; a diff here means saved\n"
+    "# patches would play differently.\n";
+
+std::vector<std::string> readLines(const std::string& path, bool& ok) {
+    std::vector<std::string> lines;
+    FILE* f = std::fopen(path.c_str(), "r");
+    ok = f != nullptr;
+    if (!f) {
+        return lines;
+    }
+    std::string line;
+    int c;
+    while ((c = std::fgetc(f)) != EOF) {
+        if (c == '\n') {
+            if (!line.empty() && line[0] != '#') {
+                lines.push_back(line);
+            }
+            line.clear();
+        } else if (c != '\r') {
+            line += static_cast<char>(c);
+        }
+    }
+    if (!line.empty() && line[0] != '#') {
+        lines.push_back(line);
+    }
+    std::fclose(f);
+    return lines;
+}
+
+bool regenGolden(const std::string& dir) {
+    for (const GoldenFile& g : GOLDEN_FILES) {
+        std::string path = dir + "/" + g.name;
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return false;
+        }
+        std::fputs(GOLDEN_HEADER, f);
+        for (const std::string& line : g.build()) {
+            std::fprintf(f, "%s\n", line.c_str());
+        }
+        std::fclose(f);
+        std::printf("wrote %s\n", path.c_str());
+    }
+    return true;
+}
+
+int checkGolden(const std::string& dir) {
+    int failures = 0;
+    for (const GoldenFile& g : GOLDEN_FILES) {
+        std::string path = dir + "/" + g.name;
+        bool ok;
+        std::vector<std::string> expected = readLines(path, ok);
+        std::vector<std::string> actual = g.build();
+        if (!ok) {
+            std::printf("FAIL %s: cannot read\n", path.c_str());
+            failures++;
+            continue;
+        }
+        if (expected.size() != actual.size()) {
+            std::printf("FAIL %s: %zu records, expected %zu\n", g.name, actual.size(), expected.size());
+            failures++;
+            continue;
+        }
+        int mismatches = 0;
+        for (size_t i = 0; i < actual.size(); i++) {
+            if (actual[i] != expected[i]) {
+                if (mismatches == 0) {
+                    std::printf("FAIL %s record %zu\n  expected: %.160s...\n  actual:   %.160s...\n",
+                                g.name, i, expected[i].c_str(), actual[i].c_str());
+                }
+                mismatches++;
+            }
+        }
+        if (mismatches) {
+            std::printf("FAIL %s: %d of %zu records differ\n", g.name, mismatches, actual.size());
+            failures++;
+        } else {
+            std::printf("ok   %s (%zu records)\n", g.name, actual.size());
+        }
+    }
+    return failures;
+}
+
+//-----------------------------------------------------------------------------
+// Differential cases
+//-----------------------------------------------------------------------------
+// Each trial draws its inputs from the fuzz RNG and returns false with a
+// description on mismatch.
+
+// Knob value: mostly uniform, sometimes an exact rounding boundary or an end stop
+float randomKnob(SFC32& rng, int positions) {
+    float r = rng.next();
+    if (r < 0.1f) {
+        return rng.next() < 0.5f ? 0.f : 100.f;
+    }
+    if (r < 0.3f) {
+        return (rng.randomInt(0, positions - 1) + 0.5f) * 100.f / positions;
+    }
+    return rng.next() * 100.f;
+}
+
+uint32_t randomSeed(SFC32& rng) {
+    return static_cast<uint32_t>(rng.next() * 4294967296.0);
+}
+
+// At SPREAD 100 the legacy generator consumes the RNG exactly like
+// generateMaster, so both paths must resolve to the same 64 steps
+bool diffLegacyVsMaster(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    Knobs k = {randomKnob(rng, BAR_LEN), 100.f, randomKnob(rng, 100), randomKnob(rng, 100)};
+
+    GeneratorParams params = {MAX_STEPS, k.density, k.spread, k.accent, k.slide, seed};
+    Pattern legacy;
+    generate(params, legacy);
+
+    MasterPattern master;
+    generateMaster(seed, master);
+
+    for (int i = 0; i < MAX_STEPS; i++) {
+        SequenceStep a = legacy.steps[i];
+        SequenceStep b = master.getStep(i, k.density, k.spread, k.accent, k.slide);
+        if (a.note != b.note || a.octave != b.octave || a.accent != b.accent || a.slide != b.slide) {
+            failure = "seed " + std::to_string(seed) + " knobs " + knobsText(k) + " step " + std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Recording a step's own pitch must give back a step with the same pitch
+bool diffPoolRoundTrip(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    Scale scale = static_cast<Scale>(rng.randomInt(0, NUM_SCALES - 1));
+    int root = rng.randomInt(0, 11);
+    int baseOctave = rng.randomInt(-2, 2);
+
+    MasterPattern master;
+    generateMaster(seed, master);
+
+    for (int i = 0; i < MAX_STEPS; i++) {
+        const MasterStep& ms = master.steps[i];
+        int note = getNoteInScale(master.scalePriorityOrder[ms.notePoolIndex], scale, root, ms.octave + baseOctave);
+
+        int pool, octave;
+        voltageToPoolStep(note / 12.f, master, scale, root, baseOctave, pool, octave);
+        int back = getNoteInScale(master.scalePriorityOrder[pool], scale, root, octave + baseOctave);
+        if (back != note) {
+            failure = "seed " + std::to_string(seed) + " scale " + std::to_string(static_cast<int>(scale)) +
+                      " root " + std::to_string(root) + " octave " + std::to_string(baseOctave) +
+                      " step " + std::to_string(i) + ": " + std::to_string(note) + " -> " + std::to_string(back);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Scalar, step-by-step definition of every PatternFeatures field
+PatternFeatures referenceFeatures(const SequenceStep* steps, int length) {
+    PatternFeatures f;
+    f.length = static_cast<uint8_t>(length);
+    auto plays = [&](int s) { return !steps[s % length].isRest(); };
+    auto pitchOf = [&](int s) { return steps[s].octave * SCALE_SIZE + steps[s].note; };
+    auto same = [&](int a, int b) {
+        const SequenceStep& x = steps[a % length];
+        const SequenceStep& y = steps[b % length];
+        return x.isRest() ? y.isRest() : !y.isRest() && x.note == y.note && x.octave == y.octave;
+    };
+
+    std::vector<int> notes;
+    int score = 0;
+    for (int s = 0; s < length; s++) {
+        if (!plays(s)) {
+            continue;
+        }
+        notes.push_back(s);
+        const SequenceStep& st = steps[s];
+        bool beat = s % 4 == 0;
+        f.noteCount++;
+        f.accentCount += st.accent;
+        f.slideCount += st.slide;
+        f.accentsOnBeat += st.accent && beat;
+        f.slidesOnBeat += st.slide && beat;
+        f.downbeats += beat;
+        f.downbeatRoots += beat && st.note == 0;
+        int next = (s + 1) % length;
+        int gain = metricalStrength(next) - metricalStrength(s);
+        if (!plays(next) && gain > 0) {
+            score += gain;
+        }
+    }
+    f.syncopation = static_cast<uint8_t>(std::min(score, 255));
+
+    for (int s = 0; s < length; s++) {
+        f.repeatsBeat += length > 4 && same(s, s + 4);
+        f.repeatsHalf += length >= 2 && same(s, s + length / 2);
+    }
+
+    if (notes.size() >= 2) {
+        for (size_t i = 0; i < notes.size(); i++) {
+            int a = pitchOf(notes[(i + notes.size() - 1) % notes.size()]);
+            int b = pitchOf(notes[i]);
+            int interval = std::abs(b - a);
+            int bin = interval == 0 ? 0 : interval == 1 ? 1 : interval == 2 ? 2 : interval <= 4 ? 3 : interval <= 6 ? 4 : 5;
+            f.intervals[bin]++;
+            f.octaveJumps += steps[notes[i]].octave != steps[notes[(i + notes.size() - 1) % notes.size()]].octave;
+        }
+    }
+    return f;
+}
+
+bool sameFeatures(const PatternFeatures& a, const PatternFeatures& b) {
+    bool same = a.length == b.length && a.noteCount == b.noteCount && a.accentCount == b.accentCount &&
+                a.slideCount == b.slideCount && a.accentsOnBeat == b.accentsOnBeat &&
+                a.slidesOnBeat == b.slidesOnBeat && a.downbeats == b.downbeats &&
+                a.downbeatRoots == b.downbeatRoots && a.syncopation == b.syncopation &&
+                a.octaveJumps == b.octaveJumps && a.repeatsBeat == b.repeatsBeat && a.repeatsHalf == b.repeatsHalf;
+    for (int i = 0; i < INTERVAL_BINS; i++) {
+        same = same && a.intervals[i] == b.intervals[i];
+    }
+    return same;
+}
+
+// resolveBits() must resolve exactly like getStep(), and the bitwise feature
+// kernels must match the scalar definitions. Random mutes cover user rests.
+bool diffFeatureKernels(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    Knobs k = {randomKnob(rng, BAR_LEN), randomKnob(rng, SCALE_SIZE), randomKnob(rng, 100), randomKnob(rng, 100)};
+    int length = rng.next() < 0.5f ? 16 : rng.randomInt(1, MAX_STEPS);
+
+    MasterPattern master;
+    generateMaster(seed, master);
+    if (rng.next() < 0.25f) {
+        for (int i = 0; i < MAX_STEPS; i++) {
+            master.muted[i] = rng.next() < 0.2f;
+        }
+    }
+
+    SequenceStep steps[MAX_STEPS];
+    for (int i = 0; i < length; i++) {
+        steps[i] = master.getStep(i, k.density, k.spread, k.accent, k.slide);
+    }
+    PatternBits bits = resolveBits(master, length, k.density, k.spread, k.accent, k.slide);
+
+    std::string where = "seed " + std::to_string(seed) + " knobs " + knobsText(k) + " length " + std::to_string(length);
+    for (int i = 0; i < length; i++) {
+        const SequenceStep& st = steps[i];
+        bool plays = (bits.rhythm >> i) & 1;
+        if (plays == st.isRest() || (plays && (bits.pitch[i] != st.octave * SCALE_SIZE + st.note ||
+                                               ((bits.accent >> i) & 1) != st.accent ||
+                                               ((bits.slide >> i) & 1) != st.slide))) {
+            failure = where + " resolveBits step " + std::to_string(i);
+            return false;
+        }
+    }
+    if (!sameFeatures(computeFeatures(bits), referenceFeatures(steps, length))) {
+        failure = where + " features";
+        return false;
+    }
+    return true;
+}
+
+bool sameBits(const PatternBits& a, const PatternBits& b) {
+    if (a.length != b.length || a.rhythm != b.rhythm || a.accent != b.accent || a.slide != b.slide ||
+        a.root != b.root || std::memcmp(a.pitch, b.pitch, sizeof(a.pitch)) != 0) {
+        return false;
+    }
+    for (int k = 0; k < PITCH_PLANES; k++) {
+        if (a.pitchPlanes[k] != b.pitchPlanes[k]) return false;
+    }
+    return true;
+}
+
+// Every cell of the DENSITY x SPREAD sweep must rebuild exactly what
+// resolveBits() gives at that level's knob values, random knobs must land on
+// the cell they resolve to, and one random cell's counts are checked against
+// getStep()
+bool diffKnobSweep(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    float accent = randomKnob(rng, 100);
+    float slide = randomKnob(rng, 100);
+    int length = rng.next() < 0.5f ? 16 : rng.randomInt(1, MAX_STEPS);
+
+    MasterPattern master;
+    generateMaster(seed, master);
+    if (rng.next() < 0.25f) {
+        for (int i = 0; i < MAX_STEPS; i++) {
+            master.muted[i] = rng.next() < 0.2f;
+        }
+    }
+    KnobSweep sweep;
+    sweepDensitySpread(master, length, accent, slide, sweep);
+
+    std::string where = "seed " + std::to_string(seed) + " length " + std::to_string(length);
+    for (int d = 0; d < DENSITY_LEVELS; d++) {
+        for (int c = 0; c < SPREAD_LEVELS; c++) {
+            if (densityLevel(densityForLevel(d)) != d || spreadLevel(spreadForLevel(c)) != c ||
+                !sameBits(sweep.bits(d, c),
+                          resolveBits(master, length, densityForLevel(d), spreadForLevel(c), accent, slide))) {
+                failure = where + " level " + std::to_string(d) + "x" + std::to_string(c);
+                return false;
+            }
+        }
+    }
+
+    float density = randomKnob(rng, BAR_LEN);
+    float spread = randomKnob(rng, SCALE_SIZE);
+    int d = densityLevel(density);
+    int c = spreadLevel(spread);
+    if (!sameBits(sweep.bits(d, c), resolveBits(master, length, density, spread, accent, slide))) {
+        failure = where + " knobs " + std::to_string(density) + "/" + std::to_string(spread);
+        return false;
+    }
+    SweepCell ref;
+    bool degrees[SCALE_SIZE] = {};
+    for (int i = 0; i < length; i++) {
+        SequenceStep st = master.getStep(i, density, spread, accent, slide);
+        if (st.isRest()) continue;
+        int8_t pitch = static_cast<int8_t>(st.octave * SCALE_SIZE + st.note);
+        ref.low = ref.notes ? std::min(ref.low, pitch) : pitch;
+        ref.high = ref.notes ? std::max(ref.high, pitch) : pitch;
+        ref.notes++;
+        ref.accents += st.accent;
+        ref.slides += st.slide;
+        ref.roots += st.note == 0;
+        ref.degrees += !degrees[st.note];
+        degrees[st.note] = true;
+    }
+    const SweepCell& cell = sweep.cells[d][c];
+    if (cell.notes != ref.notes || cell.accents != ref.accents || cell.slides != ref.slides ||
+        cell.roots != ref.roots || cell.degrees != ref.degrees || cell.low != ref.low || cell.high != ref.high) {
+        failure = where + " cell counts at " + std::to_string(density) + "/" + std::to_string(spread);
+        return false;
+    }
+    return true;
+}
+
+bool sameStep(const SequenceStep& a, const SequenceStep& b) {
+    return a.note == b.note && a.octave == b.octave && a.accent == b.accent && a.slide == b.slide;
+}
+
+// The mixed pattern at its DENSITY must play, step for step, the op applied
+// to each layer's own isStepActive(), A's mutes, and the content layer's
+// notes as getStep() resolves them with every position active
+bool diffLayerMix(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    Knobs k = {randomKnob(rng, BAR_LEN), randomKnob(rng, SCALE_SIZE), randomKnob(rng, 100), randomKnob(rng, 100)};
+    LayerOp op = static_cast<LayerOp>(rng.randomInt(0, NUM_LAYER_OPS - 1));
+    bool pitchFromB = rng.next() < 0.5f;
+
+    MasterPattern a, b, mixed;
+    generateMaster(seed, a);
+    generateMaster(layerSeedFor(seed), b);
+    for (int i = 0; i < MAX_STEPS; i++) {
+        a.muted[i] = rng.next() < 0.1f;
+    }
+    float density = mixLayers(a, b, op, pitchFromB, densityLevel(k.density), mixed);
+    const MasterPattern& content = pitchFromB ? b : a;
+
+    for (int i = 0; i < MAX_STEPS; i++) {
+        bool inA = a.isStepActive(i, k.density);
+        bool inB = b.isStepActive(i, k.density);
+        bool plays = op == LayerOp::AND ? inA && inB
+                   : op == LayerOp::OR ? inA || inB
+                   : op == LayerOp::XOR ? inA != inB
+                   : op == LayerOp::A_MINUS_B ? inA && !inB
+                   : inA;
+        SequenceStep ref = plays && !a.muted[i] ? content.getStep(i, 100.f, k.spread, k.accent, k.slide)
+                                                : SequenceStep{-1, 0, false, false};
+        if (!sameStep(mixed.getStep(i, density, k.spread, k.accent, k.slide), ref)) {
+            failure = "seed " + std::to_string(seed) + " " + getLayerOpName(op) + " density " +
+                      std::to_string(k.density) + (pitchFromB ? " pitch B" : " pitch A") + " step " +
+                      std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Packed patterns must answer exactly like their unpacked MasterPattern, and
+// like the original wherever 8-bit probabilities are exact (densities on the
+// 20% grid). Recorded 0/1 probabilities and mutes are mixed in.
+bool diffPackedPattern(SFC32& rng, std::string& failure) {
+    uint32_t seed = randomSeed(rng);
+    Knobs k = {randomKnob(rng, BAR_LEN), randomKnob(rng, SCALE_SIZE), randomKnob(rng, 100), randomKnob(rng, 100)};
+    Knobs grid = {k.density, k.spread, 20.f * rng.randomInt(0, 5), 20.f * rng.randomInt(0, 5)};
+    bool quantize = rng.next() < 0.75f;
+
+    MasterPattern master;
+    generateMaster(seed, master);
+    for (int i = 0; i < MAX_STEPS; i++) {
+        master.muted[i] = rng.next() < 0.1f;
+        if (rng.next() < 0.1f) {
+            master.steps[i].accentProb = rng.next() < 0.5f ? 0.f : 1.f;
+            master.steps[i].slideProb = rng.next() < 0.5f ? 0.f : 1.f;
+        }
+    }
+
+    PackedMasterPattern packed;
+    pack(master, packed);
+    PackedMasterPattern edited;
+    edited.barOrder = packed.barOrder;
+    edited.scaleOrder = packed.scaleOrder;
+    for (int i = 0; i < MAX_STEPS; i++) {
+        edited.setStep(i, master.steps[i]);
+        edited.setMuted(i, master.muted[i]);
+    }
+    if (std::memcmp(&edited, &packed, sizeof(packed)) != 0) {
+        failure = "seed " + std::to_string(seed) + " setStep/setMuted != pack";
+        return false;
+    }
+    MasterPattern unpacked;
+    unpack(packed, unpacked);
+    PackedPattern resolved;
+    packed.resolve(k.density, k.spread, k.accent, k.slide, resolved, quantize);
+
+    std::string where = "seed " + std::to_string(seed) + " knobs " + knobsText(k);
+    for (int i = 0; i < BAR_LEN; i++) {
+        if (unpacked.barActivationOrder[i] != master.barActivationOrder[i]) {
+            failure = where + " bar order " + std::to_string(i);
+            return false;
+        }
+    }
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        if (unpacked.scalePriorityOrder[i] != master.scalePriorityOrder[i]) {
+            failure = where + " scale order " + std::to_string(i);
+            return false;
+        }
+    }
+
+    Pattern pattern;
+    for (int i = 0; i < MAX_STEPS; i++) {
+        const MasterStep& a = master.steps[i];
+        const MasterStep& b = unpacked.steps[i];
+        SequenceStep expected = unpacked.getStep(i, k.density, k.spread, k.accent, k.slide, quantize);
+        pattern.steps[i] = expected;
+        if (a.notePoolIndex != b.notePoolIndex || a.octave != b.octave || master.muted[i] != unpacked.muted[i] ||
+            packProb(b.accentProb) != packed.accent[i] || packProb(b.slideProb) != packed.slide[i]) {
+            failure = where + " round trip step " + std::to_string(i);
+            return false;
+        }
+        if (!sameStep(packed.getStep(i, k.density, k.spread, k.accent, k.slide, quantize), expected) ||
+            !sameStep(resolved.getStep(i), expected)) {
+            failure = where + " packed getStep/resolve step " + std::to_string(i);
+            return false;
+        }
+        if (!sameStep(packed.getStep(i, grid.density, grid.spread, grid.accent, grid.slide, quantize),
+                      master.getStep(i, grid.density, grid.spread, grid.accent, grid.slide, quantize))) {
+            failure = where + " grid knobs " + knobsText(grid) + " step " + std::to_string(i);
+            return false;
+        }
+    }
+
+    pattern.length = rng.randomInt(1, MAX_STEPS);
+    PackedPattern packedPattern;
+    pack(pattern, packedPattern);
+    Pattern back;
+    unpack(packedPattern, back);
+    for (int i = 0; i < MAX_STEPS; i++) {
+        if (!sameStep(back.steps[i], pattern.steps[i])) {
+            failure = where + " Pattern round trip step " + std::to_string(i);
+            return false;
+        }
+    }
+    if (back.length != pattern.length || packedPattern.notes != resolved.notes ||
+        packedPattern.accent != resolved.accent || packedPattern.slide != resolved.slide) {
+        failure = where + " Pattern masks";
+        return false;
+    }
+    return true;
+}
+
+// SFC32::next() must stay below 1 even where float rounding would reach it
+// (the JS original computes in double and never does)
+int checkRngRange() {
+    SFC32 rng(0xfffffffeu, 0u, 0u, 0u);  // First draw: t = 2^32 - 1
+    float v = rng.next();
+    SFC32 rngInt(0xfffffffeu, 0u, 0u, 0u);
+    int i = rngInt.randomInt(-1, 1);
+    if (v >= 1.f || i != 1) {
+        std::printf("FAIL SFC32 range: next() = %a, randomInt(-1, 1) = %d\n", v, i);
+        return 1;
+    }
+    std::printf("ok   SFC32 range\n");
+    return 0;
+}
+
+// Every value lands in the bucket whose range holds it, buckets are no wider
+// than 1/SUBS of their lower bound, and percentiles come back in bucket order
+template <typename H>
+bool checkBuckets() {
+    for (int b = 0; b < H::BUCKETS; b++) {
+        uint64_t low = H::bucketLow(b);
+        uint64_t next = b + 1 < H::BUCKETS ? H::bucketLow(b + 1) : 0;
+        if (H::bucketOf(low) != b || (next && (H::bucketOf(next - 1) != b ||
+                                               next - low > std::max<uint64_t>(1, low / H::SUBS)))) {
+            std::printf("FAIL LogHistogram<%d, %d>: bucket %d\n", H::SUB_BITS, H::MAX_BITS, b);
+            return false;
+        }
+    }
+    return true;
+}
+
+int checkLogHistogram() {
+    if (!checkBuckets<LogHistogram>() || !checkBuckets<ClockHistogram>()) {
+        return 1;
+    }
+    // Values past MaxBits count in the last bucket; max stays exact
+    static ClockHistogram clipped;
+    clipped.record(uint64_t(1) << 40);
+    if (ClockHistogram::bucketOf((uint64_t(1) << 21) - 1) != ClockHistogram::BUCKETS - 1 ||
+        clipped.counts[ClockHistogram::BUCKETS - 1].load() != 1 || clipped.max.load() != uint64_t(1) << 40) {
+        std::printf("FAIL LogHistogram: values past MaxBits\n");
+        return 1;
+    }
+    static LogHistogram h;
+    static ClockHistogram fine;
+    for (uint64_t v = 1; v <= 1000; v++) {
+        h.record(v);
+        fine.record(v);
+    }
+    if (h.count() != 1000 || h.mean() != 500.5 || h.min.load() != 1 || h.max.load() != 1000 ||
+        h.percentile(0) != 1 || h.percentile(50) != 448 || h.percentile(99) != 896 ||
+        fine.percentile(50) != 496 || fine.percentile(99) != 960) {
+        std::printf("FAIL LogHistogram: p50 %llu p99 %llu, fine p50 %llu p99 %llu\n",
+                    static_cast<unsigned long long>(h.percentile(50)),
+                    static_cast<unsigned long long>(h.percentile(99)),
+                    static_cast<unsigned long long>(fine.percentile(50)),
+                    static_cast<unsigned long long>(fine.percentile(99)));
+        return 1;
+    }
+    h.clear();
+    if (h.count() != 0 || h.percentile(50) != 0 || h.min.load() != UINT64_MAX) {
+        std::printf("FAIL LogHistogram: clear\n");
+        return 1;
+    }
+    std::printf("ok   LogHistogram buckets and percentiles\n");
+    return 0;
+}
+
+// The multi-index search must return exactly what a linear scan returns,
+// including tie order, for loop lengths that give short and long substrings
+int checkSimilarityIndex() {
+    const SimilarityParams cases[] = {
+        {16, 50.f, 50.f, 25.f, 15.f},
+        {7, 80.f, 100.f, 60.f, 40.f},
+        {64, 30.f, 20.f, 10.f, 70.f},
+    };
+    SFC32 rng(99);
+    for (const SimilarityParams& p : cases) {
+        SimilarityIndex index;
+        index.build(1000, 20000, p, 2);
+        for (int q = 0; q < 200; q++) {
+            uint32_t seed = q % 2 ? randomSeed(rng) : 1000 + rng.randomInt(0, 19999);
+            MasterPattern pattern;
+            generateMaster(seed, pattern);
+            PatternSignature sig = computeSignature(pattern, p);
+            int k = rng.randomInt(1, 40);
+
+            std::vector<SimilarNeighbor> got = index.nearest(sig, k);
+            std::vector<SimilarNeighbor> want = index.nearestLinear(sig, k);
+            bool same = got.size() == want.size();
+            for (size_t i = 0; same && i < got.size(); i++) {
+                same = got[i].seed == want[i].seed && got[i].distance == want[i].distance;
+            }
+            if (!same) {
+                std::printf("FAIL similarity index: length %d query seed %u k %d\n", p.patternLength, seed, k);
+                return 1;
+            }
+        }
+    }
+    std::printf("ok   similarity index == linear scan\n");
+    return 0;
+}
+
+// The derived scale tables must agree with the registry: pitch by the
+// original wrap-and-octave arithmetic on both sides of DEGREE_SPAN, and a
+// mask with exactly the registry's intervals
+int checkScaleTables() {
+    for (int s = 0; s < NUM_SCALES; s++) {
+        const ScaleDef& def = SCALE_REGISTRY[s];
+        const ScaleTable& table = scaleTable(static_cast<Scale>(s));
+        uint16_t mask = 0;
+        for (int i = 0; i < def.length; i++) {
+            mask = static_cast<uint16_t>(mask | (1u << def.intervals[i]));
+        }
+        bool ok = table.length == def.length && table.mask == mask && getNoteInScale(-1, static_cast<Scale>(s)) == -1;
+        for (int note = 0; ok && note < 3 * DEGREE_SPAN; note++) {
+            int expected = def.intervals[note % def.length] + 5 + 12 * (-1 + note / def.length);
+            ok = getNoteInScale(note, static_cast<Scale>(s), 5, -1) == expected;
+        }
+        if (!ok) {
+            std::printf("FAIL scale tables: %s\n", def.name);
+            return 1;
+        }
+    }
+    std::printf("ok   scale tables == registry (%d scales)\n", NUM_SCALES);
+    return 0;
+}
+
+// FixedSequencer against Sequencer over random patterns, knobs, sample rates
+// and clocks, with knob moves and MIDI-style period overrides between steps.
+// Both time everything in the same StepTimer frames, so notes, gate, accent
+// and the slide flag must match exactly, pitch to one LSB of a 16-bit +-10V
+// DAC. The sweep differs only by rounding: float's per-sample error builds up
+// through the one-pole to about an ulp times its decay time in samples.
+int checkFixedSequencer() {
+    const float RATES[] = {22050.f, 44100.f, 48000.f, 88200.f, 96000.f};
+    const float PITCH_LSB = 20.f / 65536.f;
+    SFC32 rng(93);
+    for (int run = 0; run < 120; run++) {
+        uint32_t seed = randomSeed(rng);
+        MasterPattern pattern;
+        generateMaster(seed, pattern);
+        for (int i = 0; i < MAX_STEPS; i++) {
+            pattern.muted[i] = rng.next() < 0.1f;
+        }
+        float sampleRate = RATES[rng.randomInt(0, 4)];
+        SequencerParams sp;
+        sp.patternLength = rng.randomInt(1, MAX_STEPS);
+        sp.scale = static_cast<Scale>(rng.randomInt(0, NUM_SCALES - 1));
+        sp.rootNote = rng.randomInt(0, 11);
+        sp.octaveOffset = rng.randomInt(-2, 2);
+        sp.chanceAmount = rng.next() < 0.5f ? 0.f : randomKnob(rng, 100);
+        ChanceLane chance;
+        generateChance(seed, chance);
+
+        Sequencer ref;
+        FixedSequencer fixed;
+        ref.setSampleRate(sampleRate);
+        fixed.setSampleRate(sampleRate);
+        float sweepTolerance = FLT_EPSILON * AccentSweep::DECAY_TIME * sampleRate;
+
+        std::string where = "run " + std::to_string(run) + " seed " + std::to_string(seed) +
+                            " rate " + std::to_string(static_cast<int>(sampleRate));
+        for (int s = 0; s < 16; s++) {
+            if (s == 0 || rng.next() < 0.2f) {
+                sp.density = randomKnob(rng, BAR_LEN);
+                sp.spread = randomKnob(rng, SCALE_SIZE);
+                sp.accentDensity = randomKnob(rng, 100);
+                sp.slideDensity = randomKnob(rng, 100);
+            }
+            float period = 0.011f + rng.next() * 0.14f;
+            int frames = static_cast<int>(period * sampleRate);
+            float override = rng.next() < 0.15f ? 0.005f + rng.next() * 0.3f : 0.f;
+
+            ref.advance(sp.patternLength, override);
+            fixed.advance(sp.patternLength, override);
+            StepEvent a = ref.playStep(pattern, sp, sampleRate, &chance);
+            StepEvent b = fixed.playStep(pattern, sp, sampleRate, &chance);
+            if (a.note != b.note || a.midiNote != b.midiNote || a.accent != b.accent || a.legato != b.legato) {
+                std::printf("FAIL FixedSequencer: %s step %d event\n", where.c_str(), s);
+                return 1;
+            }
+            for (int f = 0; f < frames; f++) {
+                SequencerOutputs o = ref.process(1.f / sampleRate, pattern, sp);
+                SequencerOutputs q = fixed.process(1.f / sampleRate, pattern, sp);
+                const char* what = nullptr;
+                if (std::fabs(o.pitch - q.pitch) > PITCH_LSB) what = "pitch";
+                else if (o.gate != q.gate || o.gatePulse != q.gatePulse) what = "gate";
+                else if (o.accent != q.accent) what = "accent";
+                else if (o.slide != q.slide) what = "slide";
+                else if (std::fabs(o.accentSweep - q.accentSweep) > sweepTolerance) what = "accent sweep";
+                if (what) {
+                    std::printf("FAIL FixedSequencer: %s step %d frame %d %s\n", where.c_str(), s, f, what);
+                    return 1;
+                }
+            }
+        }
+    }
+    std::printf("ok   FixedSequencer == Sequencer (gate/accent exact, pitch within 1 LSB)\n");
+    return 0;
+}
+
+// Chance rolls are a pure function of (seed, loop, step): uniform, the lane
+// is fixed per seed, the engine drops exactly the steps whose roll loses
+// (whatever order they are asked in), a reset replays the same drops, and
+// CHANCE at 0 drops nothing
+int checkChance() {
+    const int ROLLS = 1 << 20;
+    int below[4] = {};
+    for (int i = 0; i < ROLLS; i++) {
+        int roll = chanceRoll(0x5eedu + static_cast<uint32_t>(i >> 16), static_cast<uint32_t>(i >> 6) & 1023, i & 63);
+        for (int b = 0; b < 4; b++) {
+            below[b] += roll < 25 * (b + 1);
+        }
+    }
+    for (int b = 0; b < 3; b++) {
+        double fraction = below[b] / static_cast<double>(ROLLS);
+        if (std::fabs(fraction - 0.25 * (b + 1)) > 0.005 || below[3] != ROLLS) {
+            std::printf("FAIL chance: %d%% of rolls below %d\n", static_cast<int>(fraction * 100), 25 * (b + 1));
+            return 1;
+        }
+    }
+
+    SFC32 rng(71);
+    for (int run = 0; run < 200; run++) {
+        uint32_t seed = randomSeed(rng);
+        ChanceLane lane, again;
+        generateChance(seed, lane);
+        generateChance(seed, again);
+        for (int i = 0; i < MAX_STEPS; i++) {
+            int pct = lane.percent[i];
+            if (pct != again.percent[i] || (i % 4 == 0 && pct != 100) || pct % 25 != 0 || pct < 25) {
+                std::printf("FAIL chance: seed %u lane step %d = %d\n", seed, i, pct);
+                return 1;
+            }
+        }
+
+        MasterPattern pattern;
+        generateMaster(seed, pattern);
+        SequencerParams sp;
+        sp.patternLength = rng.randomInt(1, MAX_STEPS);
+        sp.density = 100.f;
+        sp.chanceAmount = run % 4 == 0 ? 0.f : randomKnob(rng, 100);
+        int amount = chanceAmountFor(sp.chanceAmount);
+
+        Sequencer seq;
+        seq.setSampleRate(48000.f);
+        int steps = sp.patternLength * 3 + rng.randomInt(0, MAX_STEPS);
+        std::vector<bool> dropped;
+        for (int pass = 0; pass < 2; pass++) {
+            seq.reset();
+            for (int s = 0; s < steps; s++) {
+                seq.advance(sp.patternLength);
+                StepEvent ev = seq.playStep(pattern, sp, 48000.f, &lane);
+                bool rest = pattern.getStep(seq.currentStep, sp.density, sp.spread, sp.accentDensity,
+                                            sp.slideDensity).isRest();
+                uint32_t loop = static_cast<uint32_t>(s / sp.patternLength);
+                // Asked out of order: a later loop first, then this one
+                lane.plays(seq.currentStep, loop + 7, amount);
+                bool expectDrop = !rest && !lane.plays(seq.currentStep, loop, amount);
+                if (seq.loop != loop || seq.stepDropped != expectDrop || (ev.note && expectDrop) ||
+                    (amount == 0 && seq.stepDropped)) {
+                    std::printf("FAIL chance: seed %u amount %d pass %d step %d\n", seed, amount, pass, s);
+                    return 1;
+                }
+                if (pass == 0) {
+                    dropped.push_back(seq.stepDropped);
+                } else if (dropped[s] != seq.stepDropped) {
+                    std::printf("FAIL chance: seed %u step %d differs after reset\n", seed, s);
+                    return 1;
+                }
+            }
+        }
+    }
+    std::printf("ok   chance rolls (uniform, per-step, replayed after reset)\n");
+    return 0;
+}
+
+// The voice's decimator passes the audio band and rejects what would fold
+// back into it: sines at fractions of the base rate, fed in at 2x
+int checkHalfband() {
+    const double PASS[] = {0.02, 0.1, 0.25, 0.4};
+    const double STOP[] = {0.6, 0.7, 0.85, 0.98};
+    auto gainDb = [](double f) {
+        HalfbandDecimator d;
+        double sum = 0.;
+        const int SETTLE = 1024, FRAMES = 8192;
+        for (int n = 0; n < SETTLE + FRAMES; n++) {
+            float first = static_cast<float>(std::cos(M_PI * f * (2 * n)));
+            float second = static_cast<float>(std::cos(M_PI * f * (2 * n + 1)));
+            float out = d.process(first, second);
+            if (n >= SETTLE) {
+                sum += static_cast<double>(out) * out;
+            }
+        }
+        return 10. * std::log10(2. * sum / FRAMES);
+    };
+    for (double f : PASS) {
+        if (std::fabs(gainDb(f)) > 0.01) {
+            std::printf("FAIL half-band decimator: %.2f fs passes at %.3f dB\n", f, gainDb(f));
+            return 1;
+        }
+    }
+    for (double f : STOP) {
+        if (gainDb(f) > -79.) {
+            std::printf("FAIL half-band decimator: %.2f fs only %.1f dB down\n", f, gainDb(f));
+            return 1;
+        }
+    }
+    std::printf("ok   half-band decimator (flat to 0.4 fs, 79 dB down from 0.6 fs)\n");
+    return 0;
+}
+
+struct DiffCase {
+    const char* name;
+    bool (*trial)(SFC32& rng, std::string& failure);
+};
+
+const DiffCase DIFF_CASES[] = {
+    {"legacy generate == generateMaster + getStep (spread 100)", diffLegacyVsMaster},
+    {"voltageToPoolStep round trip", diffPoolRoundTrip},
+    {"resolveBits + feature kernels == getStep + scalar features", diffFeatureKernels},
+    {"PackedMasterPattern / PackedPattern == MasterPattern / Pattern", diffPackedPattern},
+    {"sweepDensitySpread cells == resolveBits / getStep per level", diffKnobSweep},
+    {"mixLayers == per-step op on both layers' getStep", diffLayerMix},
+};
+
+int runFuzz(uint64_t trials, uint32_t fuzzSeed) {
+    int failures = 0;
+    for (const DiffCase& c : DIFF_CASES) {
+        SFC32 rng(fuzzSeed);
+        std::string failure;
+        uint64_t t = 0;
+        for (; t < trials; t++) {
+            if (!c.trial(rng, failure)) {
+                break;
+            }
+        }
+        if (t < trials) {
+            std::printf("FAIL %s after %llu trials: %s\n", c.name, static_cast<unsigned long long>(t), failure.c_str());
+            failures++;
+        } else {
+            std::printf("ok   %s (%llu trials)\n", c.name, static_cast<unsigned long long>(trials));
+        }
+    }
+    return failures;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string goldenDir = GOLDEN_DIR;
+    uint64_t trials = 100000;
+    uint32_t fuzzSeed = 1;
+    bool regen = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--regen")) {
+            regen = true;
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--golden")) {
+            goldenDir = argv[++i];
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--fuzz")) {
+            trials = std::strtoull(argv[++i], nullptr, 10);
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--fuzz-seed")) {
+            fuzzSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else {
+            std::fprintf(stderr, "usage: acidseq-test [--golden DIR] [--fuzz TRIALS] [--fuzz-seed N] [--regen]\n");
+            return 2;
+        }
+    }
+
+    if (regen) {
+        return regenGolden(goldenDir) ? 0 : 1;
+    }
+
+    int failures = checkGolden(goldenDir);
+    failures += checkRngRange();
+    failures += checkScaleTables();
+    failures += checkSimilarityIndex();
+    failures += checkLogHistogram();
+    failures += checkFixedSequencer();
+    failures += checkChance();
+    failures += checkHalfband();
+    failures += runFuzz(trials, fuzzSeed);
+
+    std::printf("%s\n", failures ? "FAILED" : "all tests passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,885 @@
+//-----------------------------------------------------------------------------
+// module-test - Tests of the shipping AcidSeq module, built against tests/shim
+//-----------------------------------------------------------------------------
+// Compiles the real src/AcidSeq.cpp (and plugin.cpp) against the Rack API
+// stand-in, so the exact process()/JSON/widget code that ships is exercised
+// without the SDK. Each test drives the module sample by sample.
+
+#include "../src/AcidSeq.cpp"
+#include "../src/CaptureReplay.hpp"
+#include "../lib/acidgen.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr float SAMPLE_RATE = 48000.f;
+constexpr int STEP_FRAMES = 6000;   // 16ths at 120 BPM
+constexpr int TRIGGER_FRAMES = 48;  // 1ms clock pulses
+
+// Drives one module with a square clock on CLK, counting engine frames
+struct Harness {
+    AcidSeq module;
+    Module::ProcessArgs args;
+
+    Harness() {
+        args.sampleRate = SAMPLE_RATE;
+        args.sampleTime = 1.f / SAMPLE_RATE;
+        args.frame = 0;
+        Module::SampleRateChangeEvent e;
+        e.sampleRate = SAMPLE_RATE;
+        e.sampleTime = 1.f / SAMPLE_RATE;
+        module.onSampleRateChange(e);
+        // As if already running, so tests can replace masterPattern directly
+        module.ensureInitialPattern();
+    }
+
+    void tick() {
+        module.process(args);
+        args.frame++;
+    }
+
+    // One clock period with the edge on its second frame (Schmitt triggers
+    // start high, so an input that is high from frame 0 is not an edge)
+    template <typename F>
+    void step(F&& perSample) {
+        for (int i = 0; i < STEP_FRAMES; i++) {
+            module.inputs[AcidSeq::INPUT_CLOCK].setVoltage(i >= 1 && i <= TRIGGER_FRAMES ? 10.f : 0.f);
+            tick();
+            perSample();
+        }
+    }
+
+    void step() {
+        step([] {});
+    }
+};
+
+bool sameMaster(const MasterPattern& a, const MasterPattern& b) {
+    for (int i = 0; i < BAR_LEN; i++) {
+        if (a.barActivationOrder[i] != b.barActivationOrder[i]) return false;
+    }
+    for (int i = 0; i < SCALE_SIZE; i++) {
+        if (a.scalePriorityOrder[i] != b.scalePriorityOrder[i]) return false;
+    }
+    for (int i = 0; i < MAX_STEPS; i++) {
+        const MasterStep& x = a.steps[i];
+        const MasterStep& y = b.steps[i];
+        if (x.notePoolIndex != y.notePoolIndex || x.octave != y.octave ||
+            x.accentProb != y.accentProb || x.slideProb != y.slideProb || a.muted[i] != b.muted[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameStep(const SequenceStep& a, const SequenceStep& b) {
+    return a.note == b.note && a.octave == b.octave && a.accent == b.accent && a.slide == b.slide;
+}
+
+// Whether GATE is high 100 frames into each of the next `steps` steps
+std::vector<bool> stepGates(Harness& h, int steps) {
+    std::vector<bool> gates;
+    for (int s = 0; s < steps; s++) {
+        bool high = false;
+        int frame = 0;
+        h.step([&] {
+            if (++frame == 100) high = h.module.outputs[AcidSeq::OUTPUT_GATE].getVoltage() > 5.f;
+        });
+        gates.push_back(high);
+    }
+    return gates;
+}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+bool testPluginInit(std::string& why) {
+    Plugin plugin;
+    init(&plugin);
+    if (plugin.models.size() != 1 || plugin.models[0]->slug != "AcidGenMini") {
+        why = "model not registered";
+        return false;
+    }
+    std::unique_ptr<Module> module(plugin.models[0]->createModule());
+    return module != nullptr;
+}
+
+// The module's CV outputs must be exactly what its Rack-free step engine
+// (Sequencer, as used by acidseq-render, or FixedSequencer in fixed-point
+// builds) produces for the same pattern and clock
+bool testMatchesSequencer(std::string& why) {
+    Harness h;
+    generateMaster(4242, h.module.masterPattern);
+    h.module.params[AcidSeq::PARAM_DENSITY].setValue(80.f);
+    h.module.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(50.f);
+    h.module.params[AcidSeq::PARAM_ACCENT_DENSITY].setValue(40.f);
+
+    SequencerParams sp;
+    sp.density = 80.f;
+    sp.slideDensity = 50.f;
+    sp.accentDensity = 40.f;
+    AcidSeq::StepEngine seq;
+    seq.setSampleRate(SAMPLE_RATE);
+
+    int64_t frame = 0;
+    bool ok = true;
+    for (int s = 0; s < 64 && ok; s++) {
+        int i = 0;
+        h.step([&] {
+            if (i == 1) {
+                seq.advance(sp.patternLength);
+                seq.playStep(h.module.masterPattern, sp, SAMPLE_RATE);
+            }
+            SequencerOutputs o = seq.process(1.f / SAMPLE_RATE, h.module.masterPattern, sp);
+            const auto& out = h.module.outputs;
+            if (ok && (out[AcidSeq::OUTPUT_PITCH].getVoltage() != o.pitch ||
+                       out[AcidSeq::OUTPUT_GATE].getVoltage() != (o.gate ? 10.f : 0.f) ||
+                       out[AcidSeq::OUTPUT_ACCENT].getVoltage() != (o.accent ? 10.f : 0.f) ||
+                       out[AcidSeq::OUTPUT_SLIDE].getVoltage() != (o.slide ? 10.f : 0.f) ||
+                       out[AcidSeq::OUTPUT_ACCENT_CV].getVoltage() != o.accentSweep * 10.f)) {
+                why = "outputs differ at frame " + std::to_string(frame);
+                ok = false;
+            }
+            i++;
+            frame++;
+        });
+    }
+    return ok;
+}
+
+// libacidgen, fed the same clock, GEN and RST as events, plays exactly what
+// the module outputs, chance rolls included (built here with the same flags
+// as the module)
+bool testMatchesLibrary(std::string& why) {
+    Harness h;
+    generateMaster(4242, h.module.masterPattern);
+    generateChance(4242, h.module.chanceLane);
+    h.module.params[AcidSeq::PARAM_DENSITY].setValue(80.f);
+    h.module.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(50.f);
+    h.module.params[AcidSeq::PARAM_ACCENT_DENSITY].setValue(40.f);
+    h.module.params[AcidSeq::PARAM_SCALE].setValue(3.f);
+    h.module.params[AcidSeq::PARAM_CHANCE].setValue(60.f);
+
+    std::unique_ptr<acidgen_engine, void (*)(acidgen_engine*)> lib(acidgen_create(SAMPLE_RATE, 4242), acidgen_destroy);
+    acidgen_params p;
+    p.struct_size = sizeof(p);
+    acidgen_default_params(&p);
+    p.density = 80.f;
+    p.slide = 50.f;
+    p.accent = 40.f;
+    p.scale = 3;
+    p.chance = 60.f;
+    acidgen_set_params(lib.get(), &p);
+
+    constexpr int GEN_STEP = 20, GEN_FRAME = 100, RESET_STEP = 40;
+    std::vector<float> out(STEP_FRAMES * ACIDGEN_OUTPUTS);
+    for (int s = 0; s < 64; s++) {
+        acidgen_push_event(lib.get(), ACIDGEN_EVENT_CLOCK, 1, 0);
+        if (s == GEN_STEP) {
+            h.module.replaySeed = 777;
+            acidgen_push_event(lib.get(), ACIDGEN_EVENT_GENERATE, GEN_FRAME, 777);
+        }
+        if (s == RESET_STEP) {
+            acidgen_push_event(lib.get(), ACIDGEN_EVENT_RESET, 0, 0);
+        }
+        acidgen_process(lib.get(), out.data(), STEP_FRAMES);
+
+        for (int i = 0; i < STEP_FRAMES; i++) {
+            auto& in = h.module.inputs;
+            in[AcidSeq::INPUT_CLOCK].setVoltage(i >= 1 && i <= TRIGGER_FRAMES ? 10.f : 0.f);
+            bool gen = s == GEN_STEP && i >= GEN_FRAME && i < GEN_FRAME + TRIGGER_FRAMES;
+            in[AcidSeq::INPUT_GENERATE].setVoltage(gen ? 10.f : 0.f);
+            in[AcidSeq::INPUT_RESET].setVoltage(s == RESET_STEP && i < TRIGGER_FRAMES ? 10.f : 0.f);
+            h.tick();
+
+            const auto& o = h.module.outputs;
+            const float* l = &out[i * ACIDGEN_OUTPUTS];
+            if (o[AcidSeq::OUTPUT_PITCH].getVoltage() != l[ACIDGEN_OUT_PITCH] ||
+                o[AcidSeq::OUTPUT_GATE].getVoltage() != l[ACIDGEN_OUT_GATE] ||
+                o[AcidSeq::OUTPUT_ACCENT].getVoltage() != l[ACIDGEN_OUT_ACCENT] ||
+                o[AcidSeq::OUTPUT_SLIDE].getVoltage() != l[ACIDGEN_OUT_SLIDE] ||
+                o[AcidSeq::OUTPUT_ACCENT_CV].getVoltage() != l[ACIDGEN_OUT_ACCENT_CV]) {
+                why = "outputs differ at step " + std::to_string(s) + " frame " + std::to_string(i);
+                return false;
+            }
+        }
+    }
+    if (h.module.currentSeed != 777 || acidgen_seed(lib.get()) != 777 ||
+        h.module.seq.currentStep != acidgen_current_step(lib.get())) {
+        why = "seed or position differs";
+        return false;
+    }
+    return true;
+}
+
+bool testJsonRoundTrip(std::string& why) {
+    Harness a;
+    a.module.masterPattern.muted[5] = true;
+    a.module.midiClockEnabled = true;
+    a.module.clockFromMidi = true;
+    a.module.seq.currentStep = 7;
+
+    json_t* rootJ = a.module.dataToJson();
+    Harness b;
+    b.module.dataFromJson(rootJ);
+    json_decref(rootJ);
+
+    if (!sameMaster(a.module.masterPattern, b.module.masterPattern)) {
+        why = "master pattern differs";
+        return false;
+    }
+    if (b.module.currentSeed != a.module.currentSeed || b.module.seq.currentStep != 7 ||
+        !b.module.midiClockEnabled || !b.module.clockFromMidi) {
+        why = "state differs";
+        return false;
+    }
+    return true;
+}
+
+// A module restored from a patch never generates: the loaded pattern and
+// seed survive the first process(). A new one generates exactly once, on
+// whichever of process(), save or draw comes first.
+bool testDeferredGeneration(std::string& why) {
+    Harness source;
+    source.module.masterPattern.muted[3] = true;
+    json_t* rootJ = source.module.dataToJson();
+
+    AcidSeq loaded;
+    if (loaded.patternInit.load() != AcidSeq::PATTERN_PENDING) {
+        why = "constructor generated";
+        json_decref(rootJ);
+        return false;
+    }
+    loaded.dataFromJson(rootJ);
+    json_decref(rootJ);
+    Module::ProcessArgs args;
+    loaded.process(args);
+    if (!sameMaster(loaded.masterPattern, source.module.masterPattern) ||
+        loaded.currentSeed != source.module.currentSeed || loaded.generateLightBrightness != 0.f) {
+        why = "loaded pattern replaced on first process()";
+        return false;
+    }
+
+    AcidSeq fresh;
+    fresh.process(args);
+    MasterPattern first = fresh.masterPattern;
+    uint32_t seed = fresh.currentSeed;
+    fresh.process(args);
+    if (fresh.patternInit.load() != AcidSeq::PATTERN_READY || fresh.currentSeed != seed ||
+        !sameMaster(fresh.masterPattern, first) || fresh.generateLightBrightness <= 0.f) {
+        why = "new module not generated once on first process()";
+        return false;
+    }
+
+    AcidSeq saved;
+    json_t* savedJ = saved.dataToJson();
+    json_decref(savedJ);
+    PatternDisplay display;
+    AcidSeq drawn;
+    display.module = &drawn;
+    widget::Widget::DrawArgs drawArgs;
+    display.draw(drawArgs);
+    if (saved.patternInit.load() != AcidSeq::PATTERN_READY || drawn.patternInit.load() != AcidSeq::PATTERN_READY ||
+        drawn.displayPattern.steps[0].note != drawn.masterPattern.getStep(0, 50.f, 50.f, 25.f, 15.f).note) {
+        why = "save or first draw did not generate";
+        return false;
+    }
+    return true;
+}
+
+// Gate-low on REC GATE records mutes; the shadow pattern replaces the playing
+// one only when the loop wraps
+bool testRecorder(std::string& why) {
+    Harness h;
+    h.module.params[AcidSeq::PARAM_PATTERN_LENGTH].setValue(4.f);
+    h.module.params[AcidSeq::PARAM_DENSITY].setValue(100.f);
+    h.module.recordEnabled = true;
+    h.module.inputs[AcidSeq::INPUT_REC_GATE].setChannels(1);
+
+    // Pass 1 records steps 0-3 with step 2 gated off
+    for (int s = 0; s < 4; s++) {
+        h.module.inputs[AcidSeq::INPUT_REC_GATE].setVoltage(s == 2 ? 0.f : 10.f);
+        h.step();
+    }
+    if (h.module.masterPattern.muted[2]) {
+        why = "recording committed before loop end";
+        return false;
+    }
+    h.module.inputs[AcidSeq::INPUT_REC_GATE].setVoltage(10.f);
+    h.step();
+    if (!h.module.masterPattern.muted[2] || h.module.masterPattern.muted[1]) {
+        why = "recording not committed at loop end";
+        return false;
+    }
+    return true;
+}
+
+// Every gate becomes a note-on/note-off pair stamped with the engine frame
+bool testMidiOutput(std::string& why) {
+    Harness h;
+    generateMaster(99, h.module.masterPattern);
+    h.module.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(0.f);
+    h.module.midiClockEnabled = true;
+
+    int gateRises = 0;
+    bool lastGate = false;
+    for (int s = 0; s < 32; s++) {
+        h.step([&] {
+            bool gate = h.module.outputs[AcidSeq::OUTPUT_GATE].getVoltage() > 0.f;
+            gateRises += gate && !lastGate;
+            lastGate = gate;
+        });
+    }
+
+    int noteOns = 0, noteOffs = 0, clocks = 0;
+    int64_t lastFrame = -1;
+    for (const midi::Message& msg : h.module.midiOutput.sent) {
+        if (msg.getFrame() < lastFrame) {
+            why = "messages out of frame order";
+            return false;
+        }
+        lastFrame = msg.getFrame();
+        noteOns += msg.getStatus() == 0x9;
+        noteOffs += msg.getStatus() == 0x8;
+        clocks += msg.getStatus() == 0xf && msg.getChannel() == 0x8;
+    }
+    if (noteOns != gateRises || noteOffs != noteOns || clocks != 32 * 6) {
+        why = "notes on/off/clocks " + std::to_string(noteOns) + "/" + std::to_string(noteOffs) + "/" +
+              std::to_string(clocks) + ", gates " + std::to_string(gateRises);
+        return false;
+    }
+    return true;
+}
+
+// MIDI clock input: Start plus 24 PPQN ticks advance one step per 6 ticks
+bool testMidiClockInput(std::string& why) {
+    Harness h;
+    h.module.clockFromMidi = true;
+    const int tickFrames = STEP_FRAMES / 6;
+
+    auto push = [&](uint8_t type, int64_t frame) {
+        midi::Message msg;
+        msg.setSize(1);
+        msg.setStatus(0xf);
+        msg.setChannel(type);
+        msg.setFrame(frame);
+        h.module.midiInput.onMessage(msg);
+    };
+    push(0xa, 10);
+    for (int t = 0; t < 6 * 20; t++) {
+        push(0x8, 20 + t * tickFrames);
+    }
+
+    int steps = 0;
+    int last = h.module.seq.currentStep;
+    for (int i = 0; i < 6 * 20 * tickFrames; i++) {
+        h.tick();
+        if (h.module.seq.currentStep != last) {
+            steps++;
+            last = h.module.seq.currentStep;
+        }
+    }
+    if (steps != 20) {
+        why = std::to_string(steps) + " steps for 20 steps of ticks";
+        return false;
+    }
+    return true;
+}
+
+// Clock stats see the source jitter exactly, the engine adds no latency to
+// gates that start from low, and a UI reset lands on the next process()
+bool testClockStats(std::string& why) {
+    Harness h;
+    generateMaster(5, h.module.masterPattern);
+    h.module.params[AcidSeq::PARAM_DENSITY].setValue(100.f);
+    h.module.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(0.f);
+    for (int s = 0; s < 33; s++) {
+        int frames = s % 2 ? STEP_FRAMES + 10 : STEP_FRAMES - 10;
+        for (int i = 0; i < frames; i++) {
+            h.module.inputs[AcidSeq::INPUT_CLOCK].setVoltage(i >= 1 && i <= TRIGGER_FRAMES ? 10.f : 0.f);
+            h.tick();
+        }
+    }
+
+    const ClockStats& cs = h.module.clockStats;
+    if (cs.interval.count() != 32 || cs.interval.min.load() != STEP_FRAMES - 10 ||
+        cs.interval.max.load() != STEP_FRAMES + 10 || cs.interval.mean() != STEP_FRAMES || cs.unmeasured.load() != 0) {
+        why = cs.intervalLine();
+        return false;
+    }
+    // The tracked period is the previous interval, so edges are 20 frames off,
+    // except the first, judged against the 125ms (6000 frame) default
+    if (cs.deviation.min.load() != 10 || cs.deviation.max.load() != 20 || cs.deviation.percentile(50) != 20) {
+        why = ClockStats::percentileLine("deviation", cs.deviation);
+        return false;
+    }
+    if (cs.latency.count() != 33 || cs.latency.max.load() != 0) {
+        why = ClockStats::percentileLine("latency", cs.latency) + ", n " + std::to_string(cs.latency.count());
+        return false;
+    }
+
+    h.module.clockStats.resetRequested = true;
+    h.tick();
+    if (h.module.clockStats.resetRequested || cs.interval.count() != 0 || cs.latency.count() != 0) {
+        why = "reset not applied on the next process()";
+        return false;
+    }
+    return true;
+}
+
+// A capture taken while knobs move, GEN fires and RESET lands replays into a
+// fresh module with identical outputs; a changed seed is caught by the hashes
+bool testCaptureReplay(std::string& why) {
+    Harness h;
+    for (int s = 0; s < 4; s++) {
+        h.step();
+    }
+    std::remove(CAPTURE_PATH);
+    if (!h.module.startCapture(CAPTURE_PATH) || h.module.startCapture(CAPTURE_PATH)) {
+        why = "start refused, or a second start accepted";
+        return false;
+    }
+
+    std::vector<float> recorded;
+    auto keep = [&] {
+        float out[AcidSeq::CAPTURE_OUTPUTS];
+        h.module.captureOutputs(out);
+        recorded.insert(recorded.end(), out, out + AcidSeq::CAPTURE_OUTPUTS);
+    };
+    for (int s = 0; s < 40; s++) {
+        if (s == 5) h.module.params[AcidSeq::PARAM_DENSITY].setValue(90.f);
+        if (s == 10) h.module.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(60.f);
+        if (s == 12) h.module.params[AcidSeq::PARAM_GENERATE].setValue(1.f);
+        if (s == 13) h.module.params[AcidSeq::PARAM_GENERATE].setValue(0.f);
+        if (s == 20) h.module.inputs[AcidSeq::INPUT_RESET].setVoltage(10.f);
+        if (s == 21) h.module.inputs[AcidSeq::INPUT_RESET].setVoltage(0.f);
+        if (s == 24) {
+            h.module.recordEnabled = true;
+            h.module.inputs[AcidSeq::INPUT_REC_PITCH].setChannels(1);
+            h.module.inputs[AcidSeq::INPUT_REC_PITCH].setVoltage(0.25f);
+        }
+        h.step(keep);
+    }
+    h.module.stopCapture();
+    h.tick();
+    if (h.module.capturing()) {
+        why = "still capturing after stop";
+        return false;
+    }
+    h.module.capture.reset();
+
+    CaptureFile capture;
+    if (!capture.load(CAPTURE_PATH, why)) {
+        return false;
+    }
+    if (!capture.complete || capture.dropped != 0) {
+        why = "capture incomplete";
+        return false;
+    }
+
+    const size_t frames = recorded.size() / AcidSeq::CAPTURE_OUTPUTS;
+    size_t diffs = 0;
+    AcidSeq replayed;
+    ReplayResult r = replayCapture(capture, replayed, [&](uint32_t frame, const float* out, int count) {
+        if (frame >= frames || std::memcmp(out, &recorded[frame * count], count * sizeof(float)) != 0) {
+            diffs++;
+        }
+    });
+    if (!r.error.empty() || r.frames != frames || diffs != 0 || r.firstMismatchFrame >= 0 ||
+        r.blocksChecked != frames / CAPTURE_HASH_BLOCK) {
+        why = "replay: " + r.error + " frames " + std::to_string(r.frames) + "/" + std::to_string(frames) +
+              ", " + std::to_string(diffs) + " differ";
+        return false;
+    }
+
+    // A different GEN seed changes the pattern from that frame on
+    int64_t genFrame = -1;
+    for (CaptureRecord& rec : capture.records) {
+        if (rec.kind == CAPTURE_SEED) {
+            rec.value ^= 1;
+            genFrame = rec.frame;
+        }
+    }
+    AcidSeq tampered;
+    r = replayCapture(capture, tampered, [](uint32_t, const float*, int) {});
+    if (genFrame < 0 || r.firstMismatchFrame < genFrame - static_cast<int64_t>(CAPTURE_HASH_BLOCK)) {
+        why = "seed change not detected, first mismatch " + std::to_string(r.firstMismatchFrame);
+        return false;
+    }
+    return true;
+}
+
+// The accounting covers the module object and adds heap parts on top; a
+// running capture shows up with its ring
+bool testFootprint(std::string& why) {
+    Harness h;
+    h.step();
+    Footprint f = h.module.footprint();
+    size_t inside = 0;
+    for (int i = 0; i < f.count; i++) {
+        inside += f.parts[i].heap ? 0 : f.parts[i].bytes;
+    }
+    if (f.object != sizeof(AcidSeq) || inside > f.object || f.heap() == 0 || f.total() != f.object + f.heap()) {
+        why = "parts do not add up";
+        return false;
+    }
+
+    std::remove(CAPTURE_PATH);
+    if (!h.module.startCapture(CAPTURE_PATH)) {
+        why = "cannot start capture";
+        return false;
+    }
+    size_t ring = CaptureSession::RING_SIZE * sizeof(CaptureRecord);
+    bool grew = h.module.footprint().heap() >= f.heap() + ring;
+    h.module.stopCapture();
+    h.tick();
+    h.module.capture.reset();
+    std::remove(CAPTURE_PATH);
+    if (!grew) {
+        why = "capture ring not counted";
+        return false;
+    }
+    return true;
+}
+
+// Layered playback: every step plays the op applied to both layers' own
+// rhythm, with notes from the chosen layer; the CV steps the op; GEN leaves a
+// held layer alone; and the layer survives a save
+bool testLayers(std::string& why) {
+    Harness h;
+    AcidSeq& m = h.module;
+    m.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(0.f);  // Short gates only, no ties
+    m.params[AcidSeq::PARAM_DENSITY].setValue(60.f);
+    m.params[AcidSeq::PARAM_LAYER_OP].setValue(static_cast<float>(LayerOp::XOR));
+    m.params[AcidSeq::PARAM_LAYER_PITCH].setValue(1.f);
+
+    for (int s = 0; s < 16; s++) {
+        bool gateMid = false;
+        int frame = 0;
+        h.step([&] {
+            if (++frame == 100) gateMid = m.outputs[AcidSeq::OUTPUT_GATE].getVoltage() > 5.f;
+        });
+        bool inA = m.masterPattern.isStepActive(s, 60.f);
+        bool inB = m.layerPattern.isStepActive(s, 60.f);
+        SequenceStep ref = inA != inB ? m.layerPattern.getStep(s, 100.f, 50.f, 25.f, 0.f)
+                                      : SequenceStep{-1, 0, false, false};
+        float pitch = getNoteInScale(ref.note, Scale::MAJOR, 0, ref.octave) / 12.0f;
+        if (!sameStep(m.displayPattern.steps[s], ref) || gateMid != !ref.isRest() ||
+            (!ref.isRest() && m.outputs[AcidSeq::OUTPUT_PITCH].getVoltage() != pitch)) {
+            why = "step " + std::to_string(s) + " does not play A XOR B with B's notes";
+            return false;
+        }
+    }
+
+    m.params[AcidSeq::PARAM_LAYER_OP].setValue(0.f);
+    m.inputs[AcidSeq::INPUT_LAYER_OP].setChannels(1);
+    m.inputs[AcidSeq::INPUT_LAYER_OP].setVoltage(2.2f);
+    h.tick();
+    if (m.mixOp != LayerOp::OR) {
+        why = "LAYER CV did not select A OR B";
+        return false;
+    }
+
+    MasterPattern held = m.layerPattern;
+    m.layerHold = true;
+    m.params[AcidSeq::PARAM_GENERATE].setValue(1.f);
+    h.tick();
+    m.params[AcidSeq::PARAM_GENERATE].setValue(0.f);
+    h.tick();
+    MasterPattern expected;
+    generateMaster(layerSeedFor(m.currentSeed), expected);
+    if (!sameMaster(m.layerPattern, held) || sameMaster(m.layerPattern, expected)) {
+        why = "held layer changed on GEN";
+        return false;
+    }
+    m.layerHold = false;
+    m.params[AcidSeq::PARAM_GENERATE].setValue(1.f);
+    h.tick();
+    m.params[AcidSeq::PARAM_GENERATE].setValue(0.f);
+    generateMaster(layerSeedFor(m.currentSeed), expected);
+    if (!sameMaster(m.layerPattern, expected)) {
+        why = "GEN did not regenerate the layer from the seed";
+        return false;
+    }
+
+    m.layerHold = true;
+    json_t* rootJ = m.dataToJson();
+    AcidSeq restored;
+    restored.dataFromJson(rootJ);
+    json_decref(rootJ);
+    if (!sameMaster(restored.layerPattern, m.layerPattern) || !restored.layerHold) {
+        why = "layer not restored from JSON";
+        return false;
+    }
+    return true;
+}
+
+// Dropped steps follow the seed's chance lane and the loop count: a reset
+// replays the same drops, a restored patch carries on with the same ones,
+// and CHANCE at 0 plays every step
+bool testChance(std::string& why) {
+    Harness h;
+    AcidSeq& m = h.module;
+    m.params[AcidSeq::PARAM_SLIDE_DENSITY].setValue(0.f);  // Short gates only, no ties
+    m.params[AcidSeq::PARAM_DENSITY].setValue(100.f);
+    m.params[AcidSeq::PARAM_CHANCE].setValue(100.f);
+
+    std::vector<bool> first = stepGates(h, 64);
+    int drops = 0;
+    for (int s = 0; s < 64; s++) {
+        bool plays = m.chanceLane.plays(s % 16, static_cast<uint32_t>(s / 16), 100);
+        drops += !first[s];
+        if (first[s] != plays) {
+            why = "step " + std::to_string(s) + " does not follow the lane";
+            return false;
+        }
+    }
+    if (drops == 0) {
+        why = "nothing dropped at CHANCE 100";
+        return false;
+    }
+
+    m.inputs[AcidSeq::INPUT_RESET].setVoltage(10.f);
+    h.tick();
+    m.inputs[AcidSeq::INPUT_RESET].setVoltage(0.f);
+    if (stepGates(h, 64) != first) {
+        why = "drops differ after reset";
+        return false;
+    }
+
+    stepGates(h, 24);  // Save mid-loop
+    json_t* rootJ = m.dataToJson();
+    Harness restored;
+    restored.module.dataFromJson(rootJ);
+    json_decref(rootJ);
+    for (int id : {AcidSeq::PARAM_SLIDE_DENSITY, AcidSeq::PARAM_DENSITY, AcidSeq::PARAM_CHANCE}) {
+        restored.module.params[id].setValue(m.params[id].getValue());
+    }
+    if (stepGates(restored, 40) != stepGates(h, 40)) {
+        why = "restored patch drops different steps";
+        return false;
+    }
+
+    m.params[AcidSeq::PARAM_CHANCE].setValue(0.f);
+    for (bool played : stepGates(h, 64)) {
+        if (!played) {
+            why = "step dropped at CHANCE 0";
+            return false;
+        }
+    }
+    return true;
+}
+
+// The map worker only hears from the audio thread while the map is shown,
+// each map it delivers matches a sweep of the master it was posted (of the
+// layer mix at each DENSITY level while layering), and one worker thread
+// builds them all
+bool testMacroMap(std::string& why) {
+    Harness h;
+    h.step();
+    if (h.module.macroMap.requested.load() != 0) {
+        why = "posted while hidden";
+        return false;
+    }
+
+    auto matches = [&h]() {
+        KnobSweep expected;
+        sweepDensitySpread(h.module.masterPattern, 16, 25.f, 15.f, expected);
+        const MacroMapCells& map = h.module.macroMap.map;
+        for (int d = 0; d < DENSITY_LEVELS; d++) {
+            for (int s = 0; s < SPREAD_LEVELS; s++) {
+                const SweepCell& a = map.cells[d][s];
+                const SweepCell& b = expected.cells[d][s];
+                if (a.notes != b.notes || a.accents != b.accents || a.low != b.low || a.high != b.high) {
+                    return false;
+                }
+            }
+        }
+        return map.length == 16;
+    };
+
+    h.module.showMacroMap = true;
+    h.tick();
+    h.module.macroMap.wait();
+    if (!h.module.macroMap.ready() || !matches()) {
+        why = "first map differs from the sweep";
+        return false;
+    }
+
+    // Knob turns that only move the crosshair post nothing; GEN does
+    uint32_t posted = h.module.macroMap.requested.load();
+    std::thread::id worker = h.module.macroMap.worker.get_id();
+    h.module.params[AcidSeq::PARAM_DENSITY].setValue(90.f);
+    h.tick();
+    h.module.params[AcidSeq::PARAM_GENERATE].setValue(1.f);
+    h.tick();
+    h.module.params[AcidSeq::PARAM_GENERATE].setValue(0.f);
+    h.tick();
+    h.module.macroMap.wait();
+    if (h.module.macroMap.requested.load() != posted + 1 || h.module.macroMap.mapVersion != posted + 1 ||
+        !matches()) {
+        why = "map not rebuilt for the new master";
+        return false;
+    }
+    if (h.module.macroMap.worker.get_id() != worker) {
+        why = "new worker thread for the second map";
+        return false;
+    }
+
+    // Layered, each column is the mix the engine plays at that level
+    h.module.params[AcidSeq::PARAM_LAYER_OP].setValue(static_cast<float>(LayerOp::XOR));
+    h.module.params[AcidSeq::PARAM_LAYER_PITCH].setValue(1.f);
+    h.tick();
+    h.module.macroMap.wait();
+    for (int d = 0; d < DENSITY_LEVELS; d++) {
+        MasterPattern mix;
+        float density = mixLayers(h.module.masterPattern, h.module.layerPattern, LayerOp::XOR, true, d, mix);
+        KnobSweep expected;
+        sweepDensitySpread(mix, 16, 25.f, 15.f, expected);
+        for (int s = 0; s < SPREAD_LEVELS; s++) {
+            const SweepCell& a = h.module.macroMap.map.cells[d][s];
+            const SweepCell& b = expected.cells[densityLevel(density)][s];
+            if (a.notes != b.notes || a.accents != b.accents || a.low != b.low || a.high != b.high) {
+                why = "layered map differs from the mix at level " + std::to_string(d);
+                return false;
+            }
+        }
+    }
+
+    json_t* rootJ = h.module.dataToJson();
+    AcidSeq restored;
+    restored.dataFromJson(rootJ);
+    json_decref(rootJ);
+    if (!restored.showMacroMap) {
+        why = "display mode not saved";
+        return false;
+    }
+    return true;
+}
+
+// The panel builds and draws headless, with and without a module (browser)
+bool testWidget(std::string& why) {
+    Harness h;
+    h.step();
+    for (AcidSeq* module : {&h.module, static_cast<AcidSeq*>(nullptr)}) {
+        AcidSeqWidget widget(module);
+        widget::Widget::DrawArgs args;
+        widget.step();
+        for (widget::Widget* child : widget.children) {
+            child->step();
+            child->draw(args);
+            child->drawLayer(args, 1);
+        }
+        ui::Menu menu;
+        widget.appendContextMenu(&menu);
+        if (widget.children.empty()) {
+            why = "no widgets";
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef ACIDSEQ_TRACE
+// Trace build: sections and events are counted on the audio path, a reset
+// requested from the UI lands on the next process(), and the dump is written
+bool testTraceStats(std::string& why) {
+    Harness h;
+    const TraceStats& t = h.module.traceStats;
+    for (int s = 0; s < 16; s++) {
+        h.step();
+    }
+    h.module.params[AcidSeq::PARAM_GENERATE].setValue(1.f);
+    h.module.inputs[AcidSeq::INPUT_RESET].setVoltage(10.f);
+    h.tick();
+    h.module.params[AcidSeq::PARAM_GENERATE].setValue(0.f);
+    h.module.inputs[AcidSeq::INPUT_RESET].setVoltage(0.f);
+    h.tick();
+    // The reset input started low here, unlike CLK, so that was one edge
+    const uint64_t frames = 16 * STEP_FRAMES + 2;
+
+    auto events = [&](TraceEvent e) { return t.events[e].load(); };
+    if (t.sections[TRACE_PROCESS].count() != frames || t.sections[TRACE_ENGINE].count() != frames ||
+        t.sections[TRACE_CLOCK_EDGE].count() != 16 || t.sections[TRACE_VOICE].count() != 0 ||
+        t.sections[TRACE_DISPLAY].count() < 1) {
+        why = "section counts";
+        return false;
+    }
+    if (events(TRACE_CLOCK) != 16 || events(TRACE_CLOCK_DROPPED) != 1 || events(TRACE_GENERATE) != 1 ||
+        events(TRACE_RESET) != 1) {
+        why = "events " + t.report();
+        return false;
+    }
+
+    std::remove(TRACE_DUMP_PATH);
+    if (!h.module.dumpTraceStats(TRACE_DUMP_PATH)) {
+        why = "cannot write " + std::string(TRACE_DUMP_PATH);
+        return false;
+    }
+    FILE* f = std::fopen(TRACE_DUMP_PATH, "r");
+    char text[4096] = {};
+    size_t n = f ? std::fread(text, 1, sizeof(text) - 1, f) : 0;
+    if (f) std::fclose(f);
+    if (n == 0 || !std::strstr(text, "clock edge") || !std::strstr(text, "dropped clock: 1")) {
+        why = "dump file contents";
+        return false;
+    }
+
+    h.module.traceStats.resetRequested = true;
+    h.tick();
+    if (h.module.traceStats.resetRequested || t.sections[TRACE_PROCESS].count() != 1 || events(TRACE_CLOCK) != 0) {
+        why = "reset not applied on the next process()";
+        return false;
+    }
+    return true;
+}
+#endif
+
+struct Test {
+    const char* name;
+    bool (*run)(std::string& why);
+};
+
+const Test TESTS[] = {
+    {"plugin init registers the model", testPluginInit},
+    {"module outputs match the Sequencer engine", testMatchesSequencer},
+    {"libacidgen matches the module", testMatchesLibrary},
+    {"JSON round trip", testJsonRoundTrip},
+    {"initial pattern deferred until first use", testDeferredGeneration},
+    {"recorder commits at loop end", testRecorder},
+    {"MIDI output notes and clock", testMidiOutput},
+    {"MIDI clock input", testMidiClockInput},
+    {"clock interval, deviation and latency stats", testClockStats},
+    {"input capture replays sample for sample", testCaptureReplay},
+    {"memory footprint accounting", testFootprint},
+    {"layered rhythm and pitch", testLayers},
+    {"chance lane replays after reset and reload", testChance},
+    {"DENSITY x SPREAD map follows the master", testMacroMap},
+    {"widget builds and draws", testWidget},
+#ifdef ACIDSEQ_TRACE
+    {"trace stats", testTraceStats},
+#endif
+};
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    for (const Test& t : TESTS) {
+        std::string why;
+        if (t.run(why)) {
+            std::printf("ok   %s\n", t.name);
+        } else {
+            std::printf("FAIL %s: %s\n", t.name, why.c_str());
+            failures++;
+        }
+    }
+    std::printf("%s\n", failures ? "FAILED" : "all tests passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Minimal jansson stand-in for headless builds
+//-----------------------------------------------------------------------------
+// Implements the subset of the jansson API used by the plugin's
+// dataToJson()/dataFromJson(). Values are reference counted like jansson;
+// objects keep insertion order so dumps are stable across runs.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef long long json_int_t;
+
+enum json_type {
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_INTEGER,
+    JSON_REAL,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL
+};
+
+struct json_t {
+    json_type type;
+    size_t refcount = 1;
+    json_int_t integer = 0;
+    double real = 0.0;
+    std::string string;
+    std::vector<std::pair<std::string, json_t*>> object;
+    std::vector<json_t*> array;
+
+    explicit json_t(json_type t) : type(t) {}
+};
+
+#define json_typeof(json) ((json)->type)
+#define json_is_object(json) ((json) && json_typeof(json) == JSON_OBJECT)
+#define json_is_array(json) ((json) && json_typeof(json) == JSON_ARRAY)
+#define json_is_string(json) ((json) && json_typeof(json) == JSON_STRING)
+#define json_is_integer(json) ((json) && json_typeof(json) == JSON_INTEGER)
+#define json_is_real(json) ((json) && json_typeof(json) == JSON_REAL)
+#define json_is_number(json) (json_is_integer(json) || json_is_real(json))
+#define json_is_true(json) ((json) && json_typeof(json) == JSON_TRUE)
+#define json_is_false(json) ((json) && json_typeof(json) == JSON_FALSE)
+#define json_is_boolean(json) (json_is_true(json) || json_is_false(json))
+#define json_boolean_value json_is_true
+
+inline json_t* json_incref(json_t* json) {
+    if (json) json->refcount++;
+    return json;
+}
+
+inline void json_decref(json_t* json) {
+    if (!json || --json->refcount > 0) return;
+    for (auto& kv : json->object) json_decref(kv.second);
+    for (json_t* item : json->array) json_decref(item);
+    delete json;
+}
+
+inline json_t* json_object() { return new json_t(JSON_OBJECT); }
+inline json_t* json_array() { return new json_t(JSON_ARRAY); }
+inline json_t* json_null() { return new json_t(JSON_NULL); }
+inline json_t* json_true() { return new json_t(JSON_TRUE); }
+inline json_t* json_false() { return new json_t(JSON_FALSE); }
+inline json_t* json_boolean(bool value) { return new json_t(value ? JSON_TRUE : JSON_FALSE); }
+
+inline json_t* json_integer(json_int_t value) {
+    json_t* json = new json_t(JSON_INTEGER);
+    json->integer = value;
+    return json;
+}
+
+inline json_t* json_real(double value) {
+    json_t* json = new json_t(JSON_REAL);
+    json->real = value;
+    return json;
+}
+
+inline json_t* json_string(const char* value) {
+    json_t* json = new json_t(JSON_STRING);
+    json->string = value ? value : "";
+    return json;
+}
+
+inline json_int_t json_integer_value(const json_t* json) {
+    return json_is_integer(json) ? json->integer : 0;
+}
+
+inline double json_real_value(const json_t* json) {
+    return json_is_real(json) ? json->real : 0.0;
+}
+
+inline double json_number_value(const json_t* json) {
+    if (json_is_integer(json)) return static_cast<double>(json->integer);
+    return json_real_value(json);
+}
+
+inline const char* json_string_value(const json_t* json) {
+    return json_is_string(json) ? json->string.c_str() : nullptr;
+}
+
+inline json_t* json_object_get(const json_t* object, const char* key) {
+    if (!json_is_object(object)) return nullptr;
+    for (const auto& kv : object->object) {
+        if (kv.first == key) return kv.second;
+    }
+    return nullptr;
+}
+
+inline int json_object_set_new(json_t* object, const char* key, json_t* value) {
+    if (!json_is_object(object) || !value) {
+        json_decref(value);
+        return -1;
+    }
+    for (auto& kv : object->object) {
+        if (kv.first == key) {
+            json_decref(kv.second);
+            kv.second = value;
+            return 0;
+        }
+    }
+    object->object.emplace_back(key, value);
+    return 0;
+}
+
+inline int json_object_set(json_t* object, const char* key, json_t* value) {
+    return json_object_set_new(object, key, json_incref(value));
+}
+
+inline size_t json_array_size(const json_t* array) {
+    return json_is_array(array) ? array->array.size() : 0;
+}
+
+inline json_t* json_array_get(const json_t* array, size_t index) {
+    if (!json_is_array(array) || index >= array->array.size()) return nullptr;
+    return array->array[index];
+}
+
+inline int json_array_append_new(json_t* array, json_t* value) {
+    if (!json_is_array(array) || !value) {
+        json_decref(value);
+        return -1;
+    }
+    array->array.push_back(value);
+    return 0;
+}
+
+inline int json_array_append(json_t* array, json_t* value) {
+    return json_array_append_new(array, json_incref(value));
+}
+
+namespace jansson_shim {
+
+inline void dump(const json_t* json, std::string& out) {
+    char buf[64];
+    switch (json->type) {
+        case JSON_OBJECT:
+            out += '{';
+            for (size_t i = 0; i < json->object.size(); i++) {
+                if (i > 0) out += ", ";
+                out += '"' + json->object[i].first + "\": ";
+                dump(json->object[i].second, out);
+            }
+            out += '}';
+            break;
+        case JSON_ARRAY:
+            out += '[';
+            for (size_t i = 0; i < json->array.size(); i++) {
+                if (i > 0) out += ", ";
+                dump(json->array[i], out);
+            }
+            out += ']';
+            break;
+        case JSON_STRING: out += '"' + json->string + '"'; break;
+        case JSON_INTEGER:
+            snprintf(buf, sizeof(buf), "%lld", json->integer);
+            out += buf;
+            break;
+        case JSON_REAL:
+            snprintf(buf, sizeof(buf), "%.17g", json->real);
+            out += buf;
+            break;
+        case JSON_TRUE: out += "true"; break;
+        case JSON_FALSE: out += "false"; break;
+        case JSON_NULL: out += "null"; break;
+    }
+}
+
+} // namespace jansson_shim
+
+// Caller frees the result with free(), as with jansson
+inline char* json_dumps(const json_t* json, size_t /*flags*/) {
+    if (!json) return nullptr;
+    std::string out;
+    jansson_shim::dump(json, out);
+    char* result = static_cast<char*>(std::malloc(out.size() + 1));
+    std::memcpy(result, out.c_str(), out.size() + 1);
+    return result;
+}
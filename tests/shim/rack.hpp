@@ -0,0 +1,698 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Rack SDK stand-in for headless builds (tests, benchmarks, profiling)
+//-----------------------------------------------------------------------------
+// Provides just enough of the VCV Rack 2 API for src/AcidSeq.cpp to compile
+// and run without the SDK. Engine-side types (Module, Param, Port, Light,
+// dsp::SchmittTrigger, dsp::PulseGenerator) follow Rack's semantics so the
+// shipping process() path behaves identically. Widget and NanoVG types are
+// inert: they exist so the panel code compiles, but never draw.
+
+#include <jansson.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define ENUMS(name, count) name, name##_LAST = name + (count) - 1
+
+namespace rack {
+
+//-----------------------------------------------------------------------------
+// Math
+//-----------------------------------------------------------------------------
+
+namespace math {
+
+struct Vec {
+    float x = 0.f;
+    float y = 0.f;
+
+    Vec() {}
+    Vec(float x, float y) : x(x), y(y) {}
+    Vec plus(Vec b) const { return Vec(x + b.x, y + b.y); }
+    Vec minus(Vec b) const { return Vec(x - b.x, y - b.y); }
+    Vec mult(float s) const { return Vec(x * s, y * s); }
+};
+
+struct Rect {
+    Vec pos;
+    Vec size;
+};
+
+template <typename T>
+T clamp(T x, T a, T b) {
+    return std::max(std::min(x, b), a);
+}
+
+} // namespace math
+
+using math::Vec;
+using math::clamp;
+using math::Rect;
+
+static constexpr float RACK_GRID_WIDTH = 15.f;
+static constexpr float RACK_GRID_HEIGHT = 380.f;
+
+inline Vec mm2px(Vec mm) {
+    return mm.mult(75.f / 25.4f);
+}
+
+//-----------------------------------------------------------------------------
+// SIMD
+//-----------------------------------------------------------------------------
+// Portable 4-lane float standing in for Rack's SSE-backed simd::float_4.
+
+namespace simd {
+
+struct float_4 {
+    float s[4];
+
+    float_4() : s{0.f, 0.f, 0.f, 0.f} {}
+    float_4(float x) : s{x, x, x, x} {}
+    float_4(float a, float b, float c, float d) : s{a, b, c, d} {}
+
+    float& operator[](int i) { return s[i]; }
+    const float& operator[](int i) const { return s[i]; }
+
+    static float_4 zero() { return float_4(0.f); }
+};
+
+#define RACK_SHIM_FLOAT4_OP(op) \
+    inline float_4 operator op(const float_4& a, const float_4& b) { \
+        return float_4(a.s[0] op b.s[0], a.s[1] op b.s[1], a.s[2] op b.s[2], a.s[3] op b.s[3]); \
+    } \
+    inline float_4& operator op##=(float_4& a, const float_4& b) { \
+        a = a op b; \
+        return a; \
+    }
+RACK_SHIM_FLOAT4_OP(+)
+RACK_SHIM_FLOAT4_OP(-)
+RACK_SHIM_FLOAT4_OP(*)
+RACK_SHIM_FLOAT4_OP(/)
+#undef RACK_SHIM_FLOAT4_OP
+
+inline float_4 operator-(const float_4& a) {
+    return float_4(-a.s[0], -a.s[1], -a.s[2], -a.s[3]);
+}
+
+inline float_4 fmin(float_4 a, float_4 b) {
+    return float_4(std::fmin(a[0], b[0]), std::fmin(a[1], b[1]), std::fmin(a[2], b[2]), std::fmin(a[3], b[3]));
+}
+
+inline float_4 fmax(float_4 a, float_4 b) {
+    return float_4(std::fmax(a[0], b[0]), std::fmax(a[1], b[1]), std::fmax(a[2], b[2]), std::fmax(a[3], b[3]));
+}
+
+inline float_4 clamp(float_4 x, float_4 a = 0.f, float_4 b = 1.f) {
+    return fmin(fmax(x, a), b);
+}
+
+} // namespace simd
+
+//-----------------------------------------------------------------------------
+// DSP helpers
+//-----------------------------------------------------------------------------
+
+namespace dsp {
+
+// Rising-edge detector with hysteresis, as in Rack's dsp/digital.hpp
+struct SchmittTrigger {
+    bool state = true;
+
+    void reset() { state = true; }
+
+    bool process(float in, float offThreshold = 0.f, float onThreshold = 1.f) {
+        if (state) {
+            if (in <= offThreshold) state = false;
+        } else if (in >= onThreshold) {
+            state = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool isHigh() const { return state; }
+};
+
+// Timed pulse, as in Rack's dsp/digital.hpp
+struct PulseGenerator {
+    float remaining = 0.f;
+
+    void reset() { remaining = 0.f; }
+
+    bool process(float deltaTime) {
+        if (remaining > 0.f) {
+            remaining -= deltaTime;
+            return true;
+        }
+        return false;
+    }
+
+    void trigger(float duration = 1e-3f) {
+        // Keep the previous pulse if it will be held longer than the new one
+        if (duration > remaining) remaining = duration;
+    }
+};
+
+} // namespace dsp
+
+//-----------------------------------------------------------------------------
+// Engine types
+//-----------------------------------------------------------------------------
+
+namespace engine {
+
+struct Quantity {
+    virtual ~Quantity() {}
+};
+
+struct ParamQuantity : Quantity {
+    float minValue = 0.f;
+    float maxValue = 1.f;
+    float defaultValue = 0.f;
+    std::string name;
+    std::string unit;
+    bool snapEnabled = false;
+    bool randomizeEnabled = true;
+};
+
+struct Param {
+    float value = 0.f;
+
+    float getValue() const { return value; }
+    void setValue(float v) { value = v; }
+};
+
+struct Port {
+    static constexpr int PORT_MAX_CHANNELS = 16;
+
+    float voltages[PORT_MAX_CHANNELS] = {};
+    uint8_t channels = 0;
+
+    float getVoltage(int channel = 0) const { return voltages[channel]; }
+    void setVoltage(float voltage, int channel = 0) { voltages[channel] = voltage; }
+    int getChannels() const { return channels; }
+    void setChannels(int c) { channels = static_cast<uint8_t>(c); }
+    bool isConnected() const { return channels > 0; }
+};
+
+struct Input : Port {};
+struct Output : Port {};
+
+struct Light {
+    float value = 0.f;
+
+    void setBrightness(float brightness) { value = brightness; }
+    float getBrightness() const { return value; }
+};
+
+struct PortInfo {
+    std::string name;
+};
+
+struct Module {
+    int64_t id = -1;
+    std::vector<Param> params;
+    std::vector<Input> inputs;
+    std::vector<Output> outputs;
+    std::vector<Light> lights;
+    std::vector<ParamQuantity*> paramQuantities;
+    std::vector<PortInfo*> inputInfos;
+    std::vector<PortInfo*> outputInfos;
+
+    struct ProcessArgs {
+        float sampleRate = 44100.f;
+        float sampleTime = 1.f / 44100.f;
+        int64_t frame = 0;
+    };
+
+    struct SampleRateChangeEvent {
+        float sampleRate = 44100.f;
+        float sampleTime = 1.f / 44100.f;
+    };
+
+    struct ResetEvent {};
+
+    virtual ~Module() {
+        for (ParamQuantity* pq : paramQuantities) delete pq;
+        for (PortInfo* info : inputInfos) delete info;
+        for (PortInfo* info : outputInfos) delete info;
+    }
+
+    void config(int numParams, int numInputs, int numOutputs, int numLights = 0) {
+        params.resize(numParams);
+        inputs.resize(numInputs);
+        outputs.resize(numOutputs);
+        lights.resize(numLights);
+        paramQuantities.resize(numParams, nullptr);
+        inputInfos.resize(numInputs, nullptr);
+        outputInfos.resize(numOutputs, nullptr);
+    }
+
+    template <class TParamQuantity = ParamQuantity>
+    TParamQuantity* configParam(int paramId, float minValue, float maxValue, float defaultValue,
+                                std::string name = "", std::string unit = "",
+                                float /*displayBase*/ = 0.f, float /*displayMultiplier*/ = 1.f,
+                                float /*displayOffset*/ = 0.f) {
+        delete paramQuantities[paramId];
+        TParamQuantity* q = new TParamQuantity;
+        q->minValue = minValue;
+        q->maxValue = maxValue;
+        q->defaultValue = defaultValue;
+        q->name = name;
+        q->unit = unit;
+        paramQuantities[paramId] = q;
+        params[paramId].value = defaultValue;
+        return q;
+    }
+
+    template <class TParamQuantity = ParamQuantity>
+    TParamQuantity* configButton(int paramId, std::string name = "") {
+        return configParam<TParamQuantity>(paramId, 0.f, 1.f, 0.f, name);
+    }
+
+    template <class TParamQuantity = ParamQuantity>
+    TParamQuantity* configSwitch(int paramId, float minValue, float maxValue, float defaultValue,
+                                 std::string name = "", std::vector<std::string> /*labels*/ = {}) {
+        TParamQuantity* q = configParam<TParamQuantity>(paramId, minValue, maxValue, defaultValue, name);
+        q->snapEnabled = true;
+        return q;
+    }
+
+    PortInfo* configInput(int portId, std::string name = "") {
+        delete inputInfos[portId];
+        inputInfos[portId] = new PortInfo{name};
+        return inputInfos[portId];
+    }
+
+    PortInfo* configOutput(int portId, std::string name = "") {
+        delete outputInfos[portId];
+        outputInfos[portId] = new PortInfo{name};
+        return outputInfos[portId];
+    }
+
+    virtual void process(const ProcessArgs& /*args*/) {}
+    virtual json_t* dataToJson() { return nullptr; }
+    virtual void dataFromJson(json_t* /*rootJ*/) {}
+    virtual void onSampleRateChange(const SampleRateChangeEvent& /*e*/) {}
+    virtual void onReset(const ResetEvent& /*e*/) {}
+};
+
+} // namespace engine
+
+using engine::Module;
+using engine::ParamQuantity;
+using engine::Quantity;
+
+//-----------------------------------------------------------------------------
+// MIDI
+//-----------------------------------------------------------------------------
+// No drivers: an Output records what it sends and an InputQueue is fed by the
+// test, which together stand in for Rack's loopback device.
+
+namespace midi {
+
+struct Message {
+    std::vector<uint8_t> bytes;
+    int64_t frame = -1;
+
+    Message() : bytes(3) {}
+
+    int getSize() const { return static_cast<int>(bytes.size()); }
+    void setSize(int size) { bytes.resize(size); }
+    uint8_t getChannel() const { return bytes[0] & 0xf; }
+    void setChannel(uint8_t channel) { bytes[0] = (bytes[0] & 0xf0) | (channel & 0xf); }
+    uint8_t getStatus() const { return bytes[0] >> 4; }
+    void setStatus(uint8_t status) { bytes[0] = (bytes[0] & 0xf) | (status << 4); }
+    uint8_t getNote() const { return bytes.size() > 1 ? bytes[1] : 0; }
+    void setNote(uint8_t note) { if (bytes.size() > 1) bytes[1] = note & 0x7f; }
+    uint8_t getValue() const { return bytes.size() > 2 ? bytes[2] : 0; }
+    void setValue(uint8_t value) { if (bytes.size() > 2) bytes[2] = value & 0x7f; }
+    int64_t getFrame() const { return frame; }
+    void setFrame(int64_t f) { frame = f; }
+};
+
+struct Port {
+    int driverId = -1;
+    int deviceId = -1;
+    int channel = -1;
+
+    int getChannel() const { return channel; }
+    void setChannel(int c) { channel = c; }
+
+    json_t* toJson() const {
+        json_t* rootJ = json_object();
+        json_object_set_new(rootJ, "driver", json_integer(driverId));
+        json_object_set_new(rootJ, "deviceName", json_string(""));
+        json_object_set_new(rootJ, "channel", json_integer(channel));
+        return rootJ;
+    }
+
+    void fromJson(json_t* rootJ) {
+        json_t* driverJ = json_object_get(rootJ, "driver");
+        if (driverJ) driverId = static_cast<int>(json_integer_value(driverJ));
+        json_t* channelJ = json_object_get(rootJ, "channel");
+        if (channelJ) channel = static_cast<int>(json_integer_value(channelJ));
+    }
+};
+
+struct Output : Port {
+    std::vector<Message> sent;
+
+    Output() { channel = 0; }
+    void reset() { channel = 0; }
+
+    void sendMessage(const Message& message) {
+        Message msg = message;
+        // As in Rack: the port's channel overrides channel voice messages
+        if (channel >= 0 && msg.getStatus() != 0xf) msg.setChannel(static_cast<uint8_t>(channel));
+        sent.push_back(msg);
+    }
+};
+
+struct InputQueue : Port {
+    std::vector<Message> queue;
+
+    void onMessage(const Message& message) { queue.push_back(message); }
+
+    // Pops the next message due at or before `frame`
+    bool tryPop(Message* messageOut, int64_t frame) {
+        if (queue.empty() || queue.front().frame > frame) return false;
+        *messageOut = queue.front();
+        queue.erase(queue.begin());
+        return true;
+    }
+
+    void clear() { queue.clear(); }
+};
+
+} // namespace midi
+
+//-----------------------------------------------------------------------------
+// NanoVG (inert)
+//-----------------------------------------------------------------------------
+
+} // namespace rack
+
+struct NVGcontext;
+
+struct NVGcolor {
+    float r = 0.f, g = 0.f, b = 0.f, a = 1.f;
+};
+
+enum NVGalign {
+    NVG_ALIGN_LEFT = 1 << 0,
+    NVG_ALIGN_CENTER = 1 << 1,
+    NVG_ALIGN_RIGHT = 1 << 2,
+    NVG_ALIGN_TOP = 1 << 3,
+    NVG_ALIGN_MIDDLE = 1 << 4,
+    NVG_ALIGN_BOTTOM = 1 << 5,
+    NVG_ALIGN_BASELINE = 1 << 6,
+};
+
+inline NVGcolor nvgRGBA(int r, int g, int b, int a) {
+    return NVGcolor{r / 255.f, g / 255.f, b / 255.f, a / 255.f};
+}
+inline NVGcolor nvgRGB(int r, int g, int b) { return nvgRGBA(r, g, b, 255); }
+inline NVGcolor nvgRGBf(float r, float g, float b) { return NVGcolor{r, g, b, 1.f}; }
+inline void nvgBeginPath(NVGcontext*) {}
+inline void nvgRect(NVGcontext*, float, float, float, float) {}
+inline void nvgRoundedRect(NVGcontext*, float, float, float, float, float) {}
+inline void nvgCircle(NVGcontext*, float, float, float) {}
+inline void nvgMoveTo(NVGcontext*, float, float) {}
+inline void nvgLineTo(NVGcontext*, float, float) {}
+inline void nvgClosePath(NVGcontext*) {}
+inline void nvgFillColor(NVGcontext*, NVGcolor) {}
+inline void nvgStrokeColor(NVGcontext*, NVGcolor) {}
+inline void nvgStrokeWidth(NVGcontext*, float) {}
+inline void nvgFill(NVGcontext*) {}
+inline void nvgStroke(NVGcontext*) {}
+inline void nvgFontSize(NVGcontext*, float) {}
+inline void nvgFontFaceId(NVGcontext*, int) {}
+inline void nvgTextAlign(NVGcontext*, int) {}
+inline float nvgText(NVGcontext*, float x, float, const char*, const char*) { return x; }
+inline void nvgSave(NVGcontext*) {}
+inline void nvgRestore(NVGcontext*) {}
+inline void nvgScissor(NVGcontext*, float, float, float, float) {}
+
+namespace rack {
+
+//-----------------------------------------------------------------------------
+// Widgets and UI (inert)
+//-----------------------------------------------------------------------------
+
+namespace window {
+struct Font {
+    int handle = -1;
+};
+struct Window {
+    Font* uiFont = nullptr;
+};
+} // namespace window
+
+namespace context {
+struct Context {
+    window::Window* window = nullptr;
+};
+inline Context* contextGet() {
+    static window::Font font;
+    static window::Window window{&font};
+    static Context context{&window};
+    return &context;
+}
+} // namespace context
+
+#define APP rack::context::contextGet()
+
+namespace widget {
+
+struct Widget {
+    Rect box;
+    Widget* parent = nullptr;
+    std::vector<Widget*> children;
+    bool visible = true;
+
+    struct DrawArgs {
+        NVGcontext* vg = nullptr;
+        Rect clipBox;
+    };
+
+    virtual ~Widget() {
+        for (Widget* child : children) delete child;
+    }
+    void addChild(Widget* child) {
+        child->parent = this;
+        children.push_back(child);
+    }
+    virtual void step() {}
+    virtual void draw(const DrawArgs& /*args*/) {}
+    virtual void drawLayer(const DrawArgs& /*args*/, int /*layer*/) {}
+};
+
+struct OpaqueWidget : Widget {};
+struct TransparentWidget : Widget {};
+
+struct FramebufferWidget : Widget {
+    bool dirty = true;
+    void setDirty(bool d = true) { dirty = d; }
+};
+
+} // namespace widget
+
+namespace ui {
+
+struct MenuItem : widget::OpaqueWidget {
+    std::string text;
+    std::string rightText;
+    bool disabled = false;
+};
+
+struct MenuLabel : MenuItem {};
+struct MenuSeparator : widget::OpaqueWidget {};
+struct Menu : widget::OpaqueWidget {};
+
+struct Slider : widget::OpaqueWidget {
+    Quantity* quantity = nullptr;
+};
+
+} // namespace ui
+
+using ui::Menu;
+using ui::MenuItem;
+using ui::MenuLabel;
+using ui::MenuSeparator;
+
+inline MenuLabel* createMenuLabel(std::string text) {
+    MenuLabel* label = new MenuLabel;
+    label->text = text;
+    return label;
+}
+
+inline MenuItem* createMenuItem(std::string text, std::string rightText = "",
+                                std::function<void()> /*action*/ = nullptr, bool disabled = false) {
+    MenuItem* item = new MenuItem;
+    item->text = text;
+    item->rightText = rightText;
+    item->disabled = disabled;
+    return item;
+}
+
+inline MenuItem* createCheckMenuItem(std::string text, std::string rightText,
+                                     std::function<bool()> /*checked*/, std::function<void()> /*action*/,
+                                     bool disabled = false) {
+    return createMenuItem(text, rightText, nullptr, disabled);
+}
+
+inline MenuItem* createBoolPtrMenuItem(std::string text, std::string rightText, bool* /*ptr*/) {
+    return createMenuItem(text, rightText);
+}
+
+inline MenuItem* createSubmenuItem(std::string text, std::string rightText,
+                                   std::function<void(Menu*)> /*createMenu*/, bool disabled = false) {
+    return createMenuItem(text, rightText, nullptr, disabled);
+}
+
+inline MenuItem* createIndexSubmenuItem(std::string text, std::vector<std::string> /*labels*/,
+                                        std::function<size_t()> /*getter*/,
+                                        std::function<void(size_t)> /*setter*/) {
+    return createMenuItem(text);
+}
+
+namespace app {
+
+struct ParamWidget : widget::OpaqueWidget {
+    engine::Module* module = nullptr;
+    int paramId = -1;
+};
+struct PortWidget : widget::OpaqueWidget {
+    engine::Module* module = nullptr;
+    int portId = -1;
+};
+struct LightWidget : widget::TransparentWidget {
+    engine::Module* module = nullptr;
+    int firstLightId = -1;
+};
+struct SvgPanel : widget::Widget {};
+
+struct ModuleWidget : widget::OpaqueWidget {
+    engine::Module* module = nullptr;
+
+    ModuleWidget() { box.size = Vec(RACK_GRID_WIDTH * 12, RACK_GRID_HEIGHT); }
+    void setModule(engine::Module* m) { module = m; }
+    void setPanel(widget::Widget* panel) { addChild(panel); }
+    void addParam(ParamWidget* param) { addChild(param); }
+    void addInput(PortWidget* input) { addChild(input); }
+    void addOutput(PortWidget* output) { addChild(output); }
+    virtual void appendContextMenu(Menu* /*menu*/) {}
+};
+
+} // namespace app
+
+using app::ModuleWidget;
+
+inline void appendMidiMenu(ui::Menu* /*menu*/, midi::Port* /*port*/) {}
+
+namespace componentlibrary {
+struct ScrewSilver : widget::Widget {};
+struct Rogan1PWhite : app::ParamWidget {};
+struct RoundSmallBlackKnob : app::ParamWidget {};
+struct VCVButton : app::ParamWidget {};
+struct TL1105 : app::ParamWidget {};
+struct PJ301MPort : app::PortWidget {};
+struct GreenLight : app::LightWidget {};
+struct RedLight : app::LightWidget {};
+template <typename TBase>
+struct SmallLight : TBase {};
+template <typename TBase>
+struct MediumLight : TBase {};
+} // namespace componentlibrary
+
+using namespace componentlibrary;
+
+namespace asset {
+inline std::string plugin(void* /*plugin*/, std::string path) { return path; }
+inline std::string user(std::string path) { return path; }
+} // namespace asset
+
+inline app::SvgPanel* createPanel(std::string /*svgPath*/) {
+    return new app::SvgPanel;
+}
+
+template <class TWidget>
+TWidget* createWidget(Vec pos) {
+    TWidget* w = new TWidget;
+    w->box.pos = pos;
+    return w;
+}
+
+template <class TParamWidget>
+TParamWidget* createParamCentered(Vec pos, engine::Module* module, int paramId) {
+    TParamWidget* w = createWidget<TParamWidget>(pos);
+    w->module = module;
+    w->paramId = paramId;
+    return w;
+}
+
+template <class TPortWidget>
+TPortWidget* createInputCentered(Vec pos, engine::Module* module, int inputId) {
+    TPortWidget* w = createWidget<TPortWidget>(pos);
+    w->module = module;
+    w->portId = inputId;
+    return w;
+}
+
+template <class TPortWidget>
+TPortWidget* createOutputCentered(Vec pos, engine::Module* module, int outputId) {
+    return createInputCentered<TPortWidget>(pos, module, outputId);
+}
+
+template <class TLightWidget>
+TLightWidget* createLightCentered(Vec pos, engine::Module* module, int firstLightId) {
+    TLightWidget* w = createWidget<TLightWidget>(pos);
+    w->module = module;
+    w->firstLightId = firstLightId;
+    return w;
+}
+
+//-----------------------------------------------------------------------------
+// Plugin / Model
+//-----------------------------------------------------------------------------
+
+namespace plugin {
+
+struct Model {
+    std::string slug;
+    std::function<engine::Module*()> createModule;
+    virtual ~Model() {}
+};
+
+struct Plugin {
+    std::vector<Model*> models;
+    void addModel(Model* model) { models.push_back(model); }
+};
+
+} // namespace plugin
+
+using plugin::Model;
+using plugin::Plugin;
+
+template <class TModule, class TModuleWidget>
+Model* createModel(std::string slug) {
+    Model* model = new Model;
+    model->slug = slug;
+    model->createModule = []() -> engine::Module* { return new TModule; };
+    return model;
+}
+
+} // namespace rack
+
+// Plugin entry point, defined by src/plugin.cpp (as in Rack's plugin/callbacks.hpp)
+extern "C" {
+void init(rack::plugin::Plugin* plugin);
+}
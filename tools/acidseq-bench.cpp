@@ -0,0 +1,577 @@
+//-----------------------------------------------------------------------------
+// acidseq-bench - Microbenchmarks for the generator and step engine hot paths
+//-----------------------------------------------------------------------------
+// Fixed seeds and fixed iteration counts, so runs on one machine are directly
+// comparable. Each benchmark is repeated REPEATS times and the median is
+// reported as ns/op and cycles/op (TSC reference cycles on x86, "-" elsewhere).
+//
+//   acidseq-bench                          print results
+//   acidseq-bench --out baseline.tsv       also write a baseline file
+//   acidseq-bench --compare baseline.tsv   print the change against a baseline
+//   acidseq-bench --filter getStep         run matching benchmarks only
+//   acidseq-bench --memory 256             resident memory of 256 modules
+//
+// Baseline files are tab-separated: name, ns/op, cycles/op, iterations.
+//
+// --memory builds N running modules and reports the growth in resident set
+// size per instance next to the module's own footprint() accounting (the
+// "Memory" context submenu of TRACE=1 builds), so allocator and page overhead
+// show up.
+//
+// The AcidSeq:: benchmarks run the shipping module, built against the Rack
+// API stand-in in tests/shim, so they measure exactly what Rack runs.
+
+#include "../src/AcidSeq.cpp"
+#include "../src/Features.hpp"
+#include "../src/PackedPattern.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+using namespace AcidGenerator;
+
+namespace {
+
+constexpr int REPEATS = 7;
+
+// Keep a value alive without the compiler seeing through it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline uint64_t readCycles() {
+#if BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct Result {
+    std::string name;
+    double nsPerOp = 0.0;
+    double cyclesPerOp = 0.0;
+    uint64_t iterations = 0;
+};
+
+struct Bench {
+    const char* name;
+    uint64_t iterations;
+    std::function<void(uint64_t)> body;  // Runs `iterations` operations
+};
+
+Result run(const Bench& bench, double scale) {
+    uint64_t iterations = std::max<uint64_t>(1, static_cast<uint64_t>(bench.iterations * scale));
+
+    // Warm caches and branch predictors
+    bench.body(std::max<uint64_t>(1, iterations / 10));
+
+    std::vector<double> ns, cycles;
+    for (int r = 0; r < REPEATS; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = readCycles();
+        bench.body(iterations);
+        uint64_t c1 = readCycles();
+        auto t1 = std::chrono::steady_clock::now();
+        ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations);
+        cycles.push_back(static_cast<double>(c1 - c0) / iterations);
+    }
+    std::sort(ns.begin(), ns.end());
+    std::sort(cycles.begin(), cycles.end());
+
+    Result result;
+    result.name = bench.name;
+    result.nsPerOp = ns[REPEATS / 2];
+    result.cyclesPerOp = cycles[REPEATS / 2];
+    result.iterations = iterations;
+    return result;
+}
+
+// Knob settings cycled through by the resolve benchmarks
+struct KnobSet {
+    float density, spread, accent, slide;
+};
+
+const KnobSet KNOBS[] = {
+    {50.f, 50.f, 25.f, 15.f},
+    {100.f, 100.f, 100.f, 100.f},
+    {10.f, 0.f, 0.f, 0.f},
+    {75.f, 30.f, 60.f, 40.f},
+};
+constexpr int NUM_KNOBS = sizeof(KNOBS) / sizeof(KNOBS[0]);
+
+// Step engine between clock edges (slide, pulses, sweep, slide flag)
+template <typename TEngine>
+void benchEngineIdle(uint64_t n) {
+    MasterPattern pattern;
+    generateMaster(42, pattern);
+    SequencerParams params;
+    TEngine seq;
+    seq.setSampleRate(48000.f);
+    seq.advance(params.patternLength);
+    seq.playStep(pattern, params, 48000.f);
+    float acc = 0.f;
+    for (uint64_t i = 0; i < n; i++) {
+        SequencerOutputs out = seq.process(1.f / 48000.f, pattern, params);
+        acc += out.pitch + out.gate;
+    }
+    doNotOptimize(acc);
+}
+
+// Step engine with an edge every sample (advance, step resolution, slide setup)
+template <typename TEngine>
+void benchEngineClock(uint64_t n) {
+    MasterPattern pattern;
+    generateMaster(42, pattern);
+    SequencerParams params;
+    params.patternLength = 64;
+    params.density = 100.f;
+    params.slideDensity = 50.f;
+    TEngine seq;
+    seq.setSampleRate(48000.f);
+    float acc = 0.f;
+    for (uint64_t i = 0; i < n; i++) {
+        seq.advance(params.patternLength);
+        seq.playStep(pattern, params, 48000.f);
+        SequencerOutputs out = seq.process(1.f / 48000.f, pattern, params);
+        acc += out.pitch + out.gate;
+    }
+    doNotOptimize(acc);
+}
+
+std::vector<Bench> makeBenches() {
+    std::vector<Bench> benches;
+
+    benches.push_back({"SFC32::next", 50000000, [](uint64_t n) {
+        SFC32 rng(12345);
+        float acc = 0.f;
+        for (uint64_t i = 0; i < n; i++) {
+            acc += rng.next();
+        }
+        doNotOptimize(acc);
+    }});
+
+    benches.push_back({"SFC32::randomInt", 50000000, [](uint64_t n) {
+        SFC32 rng(12345);
+        int acc = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            acc += rng.randomInt(0, 15);
+        }
+        doNotOptimize(acc);
+    }});
+
+    benches.push_back({"generateMaster", 500000, [](uint64_t n) {
+        MasterPattern pattern;
+        for (uint64_t i = 0; i < n; i++) {
+            generateMaster(static_cast<uint32_t>(i), pattern);
+            doNotOptimize(pattern);
+        }
+    }});
+
+    benches.push_back({"generate (legacy)", 500000, [](uint64_t n) {
+        Pattern pattern;
+        GeneratorParams params = {16, 50.f, 50.f, 25.f, 15.f, 0};
+        for (uint64_t i = 0; i < n; i++) {
+            params.seed = static_cast<uint32_t>(i);
+            generate(params, pattern);
+            doNotOptimize(pattern);
+        }
+    }});
+
+    benches.push_back({"MasterPattern::getStep", 20000000, [](uint64_t n) {
+        MasterPattern pattern;
+        generateMaster(42, pattern);
+        int acc = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            const KnobSet& k = KNOBS[(i >> 6) % NUM_KNOBS];
+            SequenceStep step = pattern.getStep(static_cast<int>(i & 63), k.density, k.spread, k.accent, k.slide);
+            acc += step.note + step.accent + step.slide;
+        }
+        doNotOptimize(acc);
+    }});
+
+    benches.push_back({"MasterPattern::isStepActive", 50000000, [](uint64_t n) {
+        MasterPattern pattern;
+        generateMaster(42, pattern);
+        int acc = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            acc += pattern.isStepActive(static_cast<int>(i & 63), KNOBS[(i >> 6) % NUM_KNOBS].density);
+        }
+        doNotOptimize(acc);
+    }});
+
+    // Resolving all 64 steps, the inner loop of the display refresh
+    benches.push_back({"getStep x64 (display refresh)", 500000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        Pattern display;
+        for (uint64_t i = 0; i < n; i++) {
+            const KnobSet& k = KNOBS[i % NUM_KNOBS];
+            for (int s = 0; s < MAX_STEPS; s++) {
+                display.steps[s] = master.getStep(s, k.density, k.spread, k.accent, k.slide);
+            }
+            doNotOptimize(display);
+        }
+    }});
+
+    benches.push_back({"resolveBits (64 steps)", 2000000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        for (uint64_t i = 0; i < n; i++) {
+            const KnobSet& k = KNOBS[i % NUM_KNOBS];
+            PatternBits bits = resolveBits(master, MAX_STEPS, k.density, k.spread, k.accent, k.slide);
+            doNotOptimize(bits);
+        }
+    }});
+
+    // All 17 x 7 DENSITY/SPREAD levels with cell counts, against one resolveBits
+    benches.push_back({"sweepDensitySpread (64 steps, 17x7)", 1000000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        static KnobSweep sweep;
+        for (uint64_t i = 0; i < n; i++) {
+            const KnobSet& k = KNOBS[i % NUM_KNOBS];
+            sweepDensitySpread(master, MAX_STEPS, k.accent, k.slide, sweep);
+            doNotOptimize(sweep);
+        }
+    }});
+
+    benches.push_back({"computeFeatures (64 steps)", 5000000, [](uint64_t n) {
+        static PatternBits bits[NUM_KNOBS];
+        MasterPattern master;
+        generateMaster(42, master);
+        for (int k = 0; k < NUM_KNOBS; k++) {
+            bits[k] = resolveBits(master, MAX_STEPS, KNOBS[k].density, KNOBS[k].spread, KNOBS[k].accent, KNOBS[k].slide);
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            PatternFeatures f = computeFeatures(bits[i % NUM_KNOBS]);
+            doNotOptimize(f);
+        }
+    }});
+
+    // Scoring a block of distinct patterns, as seed filtering does
+    benches.push_back({"extractFeatures (per pattern, len 16)", 2000000, [](uint64_t n) {
+        constexpr size_t BLOCK = 1024;
+        static MasterPattern patterns[BLOCK];
+        static PatternFeatures features[BLOCK];
+        for (size_t i = 0; i < BLOCK; i++) {
+            generateMaster(static_cast<uint32_t>(i), patterns[i]);
+        }
+        for (uint64_t done = 0; done < n; done += BLOCK) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(BLOCK, n - done));
+            extractFeatures(patterns, count, 16, 50.f, 50.f, 25.f, 15.f, features);
+            doNotOptimize(features);
+        }
+    }});
+
+    benches.push_back({"pack MasterPattern", 2000000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        PackedMasterPattern packed;
+        for (uint64_t i = 0; i < n; i++) {
+            master.muted[i & 63] = !master.muted[i & 63];
+            pack(master, packed);
+            doNotOptimize(packed);
+        }
+    }});
+
+    benches.push_back({"unpack PackedMasterPattern", 2000000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        PackedMasterPattern packed;
+        pack(master, packed);
+        for (uint64_t i = 0; i < n; i++) {
+            packed.muted ^= 1ull << (i & 63);
+            unpack(packed, master);
+            doNotOptimize(master);
+        }
+    }});
+
+    benches.push_back({"PackedMasterPattern::resolve (64 steps)", 2000000, [](uint64_t n) {
+        MasterPattern master;
+        generateMaster(42, master);
+        PackedMasterPattern packed;
+        pack(master, packed);
+        PackedPattern resolved;
+        for (uint64_t i = 0; i < n; i++) {
+            const KnobSet& k = KNOBS[i % NUM_KNOBS];
+            packed.resolve(k.density, k.spread, k.accent, k.slide, resolved);
+            doNotOptimize(resolved);
+        }
+    }});
+
+    benches.push_back({"getNoteInScale", 50000000, [](uint64_t n) {
+        int acc = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            Scale scale = static_cast<Scale>(i % static_cast<uint64_t>(NUM_SCALES));
+            acc += getNoteInScale(static_cast<int>(i & 15), scale, static_cast<int>(i % 12), 0);
+        }
+        doNotOptimize(acc);
+    }});
+
+    benches.push_back({"stepToVoltage", 50000000, [](uint64_t n) {
+        SequenceStep step;
+        float acc = 0.f;
+        for (uint64_t i = 0; i < n; i++) {
+            step.note = static_cast<int>(i & 15);
+            step.octave = static_cast<int>(i % 3) - 1;
+            Scale scale = static_cast<Scale>(i % static_cast<uint64_t>(NUM_SCALES));
+            acc += stepToVoltage(step, scale, 0, 0);
+        }
+        doNotOptimize(acc);
+    }});
+
+    // Per-sample engine cost, as AcidSeq::process() runs it, float and
+    // fixed-point (make FIXED=1) builds
+    benches.push_back({"Sequencer::process (no clock)", 50000000, benchEngineIdle<Sequencer>});
+    benches.push_back({"Sequencer::process (clock edge)", 10000000, benchEngineClock<Sequencer>});
+    benches.push_back({"FixedSequencer::process (no clock)", 50000000, benchEngineIdle<FixedSequencer>});
+    benches.push_back({"FixedSequencer::process (clock edge)", 10000000, benchEngineClock<FixedSequencer>});
+
+    // Full display refresh, forced every iteration
+    benches.push_back({"AcidSeq::updateDisplayPattern", 500000, [](uint64_t n) {
+        AcidSeq module;
+        module.ensureInitialPattern();
+        generateMaster(42, module.masterPattern);
+        for (uint64_t i = 0; i < n; i++) {
+            module.forceDisplayRefresh = true;
+            module.updateDisplayPattern();
+            doNotOptimize(module.displayPattern);
+        }
+    }});
+
+    // Whole-module per-sample cost, voice off (AUDIO unpatched)
+    benches.push_back({"AcidSeq::process (no clock)", 20000000, [](uint64_t n) {
+        AcidSeq module;
+        module.ensureInitialPattern();
+        generateMaster(42, module.masterPattern);
+        Module::ProcessArgs args;
+        args.sampleRate = 48000.f;
+        args.sampleTime = 1.f / 48000.f;
+        for (uint64_t i = 0; i < n; i++) {
+            args.frame = static_cast<int64_t>(i);
+            module.process(args);
+        }
+        doNotOptimize(module.outputs[AcidSeq::OUTPUT_PITCH].getVoltage());
+    }});
+
+    // Clock edge every other sample (each edge costs the step resolve)
+    benches.push_back({"AcidSeq::process (clock edge)", 10000000, [](uint64_t n) {
+        AcidSeq module;
+        module.ensureInitialPattern();
+        generateMaster(42, module.masterPattern);
+        module.params[AcidSeq::PARAM_PATTERN_LENGTH].setValue(64.f);
+        module.params[AcidSeq::PARAM_DENSITY].setValue(100.f);
+        Module::ProcessArgs args;
+        args.sampleRate = 48000.f;
+        args.sampleTime = 1.f / 48000.f;
+        for (uint64_t i = 0; i < n; i++) {
+            args.frame = static_cast<int64_t>(i);
+            module.inputs[AcidSeq::INPUT_CLOCK].setVoltage((i & 1) ? 10.f : 0.f);
+            module.process(args);
+        }
+        doNotOptimize(module.outputs[AcidSeq::OUTPUT_PITCH].getVoltage());
+    }});
+
+    return benches;
+}
+
+std::map<std::string, Result> readBaseline(const char* path) {
+    std::map<std::string, Result> baseline;
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "acidseq-bench: cannot open %s\n", path);
+        return baseline;
+    }
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        char* name = std::strtok(line, "\t");
+        char* ns = std::strtok(nullptr, "\t");
+        char* cycles = std::strtok(nullptr, "\t");
+        char* iterations = std::strtok(nullptr, "\t\n");
+        if (!name || !ns || !cycles || !iterations) {
+            continue;
+        }
+        Result r;
+        r.name = name;
+        r.nsPerOp = std::strtod(ns, nullptr);
+        r.cyclesPerOp = std::strtod(cycles, nullptr);
+        r.iterations = std::strtoull(iterations, nullptr, 10);
+        baseline[r.name] = r;
+    }
+    std::fclose(f);
+    return baseline;
+}
+
+// Resident set size in bytes (Linux /proc, else peak RSS from getrusage)
+size_t residentBytes() {
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        unsigned long size = 0, resident = 0;
+        int read = std::fscanf(f, "%lu %lu", &size, &resident);
+        std::fclose(f);
+        if (read == 2) {
+            return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);  // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+}
+
+// N modules as Rack would hold them: allocated, sample rate set, pattern
+// generated and a few frames processed so lazy state is in place
+int reportMemory(int count) {
+    if (count < 1) {
+        std::fprintf(stderr, "acidseq-bench: --memory needs a positive count\n");
+        return 2;
+    }
+    std::vector<AcidSeq*> modules;
+    modules.reserve(count);
+    size_t before = residentBytes();
+    for (int i = 0; i < count; i++) {
+        AcidSeq* module = new AcidSeq;
+        Module::SampleRateChangeEvent e;
+        e.sampleRate = 48000.f;
+        e.sampleTime = 1.f / 48000.f;
+        module->onSampleRateChange(e);
+        module->ensureInitialPattern();
+        Module::ProcessArgs args;
+        args.sampleRate = e.sampleRate;
+        args.sampleTime = e.sampleTime;
+        for (int frame = 0; frame < 64; frame++) {
+            args.frame = frame;
+            module->inputs[AcidSeq::INPUT_CLOCK].setVoltage((frame & 8) ? 10.f : 0.f);
+            module->process(args);
+        }
+        modules.push_back(module);
+    }
+    size_t after = residentBytes();
+
+    Footprint f = modules[0]->footprint();
+    std::printf("%d instances\n", count);
+    std::printf("%-40s %12zu\n", "module object (sizeof)", f.object);
+    for (int i = 0; i < f.count; i++) {
+        std::printf("  %-38s %12zu%s\n", f.parts[i].name, f.parts[i].bytes, f.parts[i].heap ? "  heap" : "");
+    }
+    std::printf("%-40s %12zu\n", "footprint() per instance", f.total());
+    size_t grown = after > before ? after - before : 0;
+    std::printf("%-40s %12zu\n", "resident growth, total", grown);
+    std::printf("%-40s %12zu\n", "resident growth per instance", grown / count);
+
+    for (AcidSeq* module : modules) {
+        delete module;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    const char* comparePath = nullptr;
+    const char* filter = nullptr;
+    double scale = 1.0;
+    int memoryCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && !std::strcmp(argv[i], "--out")) {
+            outPath = argv[++i];
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--compare")) {
+            comparePath = argv[++i];
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--filter")) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--scale")) {
+            scale = std::strtod(argv[++i], nullptr);
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--memory")) {
+            memoryCount = std::atoi(argv[++i]);
+            if (memoryCount < 1) {
+                memoryCount = -1;
+            }
+        } else {
+            std::fprintf(stderr,
+                "usage: acidseq-bench [--out FILE] [--compare FILE] [--filter TEXT] [--scale X]\n"
+                "       acidseq-bench --memory N\n"
+                "  --scale X   multiply every iteration count by X (e.g. 0.1 for a quick run)\n"
+                "  --memory N  report resident memory of N module instances instead\n");
+            return 2;
+        }
+    }
+
+    if (memoryCount != 0) {
+        return reportMemory(memoryCount);
+    }
+
+    std::map<std::string, Result> baseline;
+    if (comparePath) {
+        baseline = readBaseline(comparePath);
+    }
+
+    std::vector<Result> results;
+    std::printf("%-40s %12s %12s %12s%s\n", "benchmark", "ns/op", "cycles/op", "iterations",
+                comparePath ? "     vs base" : "");
+    for (const Bench& bench : makeBenches()) {
+        if (filter && !std::strstr(bench.name, filter)) {
+            continue;
+        }
+        Result r = run(bench, scale);
+        results.push_back(r);
+
+        char cycles[32] = "-";
+        if (BENCH_HAVE_TSC) {
+            std::snprintf(cycles, sizeof(cycles), "%.2f", r.cyclesPerOp);
+        }
+        std::printf("%-40s %12.3f %12s %12llu", r.name.c_str(), r.nsPerOp, cycles,
+                    static_cast<unsigned long long>(r.iterations));
+        if (comparePath) {
+            auto it = baseline.find(r.name);
+            if (it != baseline.end() && it->second.nsPerOp > 0.0) {
+                std::printf("  %+9.1f%%", 100.0 * (r.nsPerOp / it->second.nsPerOp - 1.0));
+            } else {
+                std::printf("  %10s", "new");
+            }
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    if (outPath) {
+        FILE* f = std::fopen(outPath, "w");
+        if (!f) {
+            std::fprintf(stderr, "acidseq-bench: cannot write %s\n", outPath);
+            return 1;
+        }
+        std::fprintf(f, "# name\tns_per_op\tcycles_per_op\titerations\n");
+        for (const Result& r : results) {
+            std::fprintf(f, "%s\t%.4f\t%.4f\t%llu\n", r.name.c_str(), r.nsPerOp,
+                         BENCH_HAVE_TSC ? r.cyclesPerOp : 0.0, static_cast<unsigned long long>(r.iterations));
+        }
+        std::fclose(f);
+    }
+    return 0;
+}
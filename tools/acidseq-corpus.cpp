@@ -0,0 +1,614 @@
+//-----------------------------------------------------------------------------
+// acidseq-corpus - Bulk master pattern generation to a columnar binary file
+//-----------------------------------------------------------------------------
+// Generates a seed range on all cores and streams it to disk in chunks, one
+// column per lane, for statistical analysis of the generator. Optionally also
+// stores every pattern resolved on a DENSITY x SPREAD grid.
+//
+//   acidseq-corpus -o corpus.bin --count 10000000
+//   acidseq-corpus -o part3.bin --count 100000000 --shard 3/8
+//   acidseq-corpus -o grid.bin --count 1000000 --density 25,50,75,100 --spread 0,50,100
+//   acidseq-corpus --info corpus.bin          validate and summarize a file
+//
+// File format (all integers and floats little-endian):
+//
+//   Header
+//     char[8]  magic "ACIDCRP1"
+//     u32      version (1)
+//     u32      firstSeed
+//     u64      count              patterns in the file
+//     u32      chunkPatterns      patterns per chunk (last chunk may be short)
+//     u32      densityCount       grid size, 0 if no resolved columns
+//     u32      spreadCount
+//     f32      accentDensity      ACCENT/SLIDE knobs used for the resolved flags
+//     f32      slideDensity
+//     f32[densityCount]  DENSITY grid values
+//     f32[spreadCount]   SPREAD grid values
+//
+//   Chunk (repeated, seeds ascending and contiguous)
+//     char[4]  magic "CHNK"
+//     u32      firstSeed
+//     u32      count
+//     u32      columnCount
+//     columnCount x { u32 id, u32 valuesPerPattern, u64 bytes }
+//     column data, in directory order, each `bytes` long
+//
+//   Columns, values stored pattern by pattern:
+//     1 BAR_ORDER        u8  x 16   barActivationOrder
+//     2 SCALE_ORDER      u8  x 7    scalePriorityOrder
+//     3 POOL_INDEX       u8  x 64   steps[].notePoolIndex
+//     4 OCTAVE           i8  x 64   steps[].octave
+//     5 ACCENT_PROB      f32 x 64   steps[].accentProb
+//     6 SLIDE_PROB       f32 x 64   steps[].slideProb
+//     7 RESOLVED_DEGREE  i8  x G*64 getStep() scale degree, -1 = rest
+//     8 RESOLVED_FLAGS   u8  x G*64 bit 0 accent, bit 1 slide
+//     9 FEATURES         u8  x G*18 PatternFeatures of the 16-step loop, in
+//                                   declaration order (--features only)
+//   G = densityCount * spreadCount, grid point = d * spreadCount + s.
+//   A reader can skip any column by its byte length.
+
+#include "../src/Features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AcidGenerator;
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'A', 'C', 'I', 'D', 'C', 'R', 'P', '1'};
+constexpr char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+constexpr uint32_t VERSION = 1;
+
+enum ColumnId : uint32_t {
+    COL_BAR_ORDER = 1,
+    COL_SCALE_ORDER,
+    COL_POOL_INDEX,
+    COL_OCTAVE,
+    COL_ACCENT_PROB,
+    COL_SLIDE_PROB,
+    COL_RESOLVED_DEGREE,
+    COL_RESOLVED_FLAGS,
+    COL_FEATURES,
+};
+
+constexpr int FEATURE_LENGTH = 16;  // LENGTH knob default
+constexpr int FEATURE_BYTES = 18;
+
+struct Options {
+    std::string outPath;
+    std::string infoPath;
+    uint32_t firstSeed = 0;
+    uint64_t count = 1000000;
+    int shardIndex = 0;
+    int shardCount = 1;
+    uint32_t chunkPatterns = 65536;
+    unsigned threads = 0;  // 0 = all cores
+    std::vector<float> densities;
+    std::vector<float> spreads;
+    float accentDensity = 25.f;
+    float slideDensity = 15.f;
+    bool features = false;
+    bool quiet = false;
+};
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: acidseq-corpus -o FILE [options]\n"
+        "       acidseq-corpus --info FILE\n"
+        "  -o FILE            output path\n"
+        "  --first-seed N     first seed (default 0)\n"
+        "  --count N          number of seeds (default 1000000)\n"
+        "  --shard K/N        write only shard K (0-based) of N equal seed ranges\n"
+        "  --chunk N          patterns per chunk (default 65536)\n"
+        "  --threads N        worker threads (default: all cores)\n"
+        "  --density LIST     DENSITY grid, e.g. 25,50,75 (enables resolved columns)\n"
+        "  --spread LIST      SPREAD grid (default 50 when --density is given)\n"
+        "  --accent P         ACCENT knob for the resolved flags (default 25)\n"
+        "  --slide P          SLIDE knob for the resolved flags (default 15)\n"
+        "  --features         add pattern features per grid point (16-step loop)\n"
+        "  -q                 no progress or summary on stderr\n");
+}
+
+bool parseList(const char* text, std::vector<float>& out) {
+    out.clear();
+    const char* p = text;
+    while (*p) {
+        char* end;
+        float v = std::strtof(p, &end);
+        if (end == p || v < 0.f || v > 100.f) {
+            return false;
+        }
+        out.push_back(v);
+        p = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') {
+            return false;
+        }
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-q") {
+            opt.quiet = true;
+            continue;
+        }
+        if (arg == "--features") {
+            opt.features = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "acidseq-corpus: missing value for %s\n", arg.c_str());
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "-o") {
+            opt.outPath = value;
+        } else if (arg == "--info") {
+            opt.infoPath = value;
+        } else if (arg == "--first-seed") {
+            opt.firstSeed = static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        } else if (arg == "--count") {
+            opt.count = std::strtoull(value, nullptr, 0);
+        } else if (arg == "--shard") {
+            if (std::sscanf(value, "%d/%d", &opt.shardIndex, &opt.shardCount) != 2) {
+                std::fprintf(stderr, "acidseq-corpus: --shard expects K/N\n");
+                return false;
+            }
+        } else if (arg == "--chunk") {
+            opt.chunkPatterns = static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        } else if (arg == "--threads") {
+            opt.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 0));
+        } else if (arg == "--density") {
+            if (!parseList(value, opt.densities)) {
+                std::fprintf(stderr, "acidseq-corpus: bad --density list\n");
+                return false;
+            }
+        } else if (arg == "--spread") {
+            if (!parseList(value, opt.spreads)) {
+                std::fprintf(stderr, "acidseq-corpus: bad --spread list\n");
+                return false;
+            }
+        } else if (arg == "--accent") {
+            opt.accentDensity = std::strtof(value, nullptr);
+        } else if (arg == "--slide") {
+            opt.slideDensity = std::strtof(value, nullptr);
+        } else {
+            std::fprintf(stderr, "acidseq-corpus: unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (!opt.infoPath.empty()) {
+        return true;
+    }
+    if (opt.outPath.empty()) {
+        std::fprintf(stderr, "acidseq-corpus: no output file (-o)\n");
+        return false;
+    }
+    if (opt.shardCount < 1 || opt.shardIndex < 0 || opt.shardIndex >= opt.shardCount ||
+        opt.chunkPatterns < 1 || opt.count == 0 || opt.count > (1ull << 32) - opt.firstSeed) {
+        std::fprintf(stderr, "acidseq-corpus: option out of range\n");
+        return false;
+    }
+    if (!opt.spreads.empty() && opt.densities.empty()) {
+        opt.densities = {50.f};
+    }
+    if (!opt.densities.empty() && opt.spreads.empty()) {
+        opt.spreads = {50.f};
+    }
+    if (opt.features && opt.densities.empty()) {
+        opt.densities = {50.f};
+        opt.spreads = {50.f};
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Little-endian encoding
+//-----------------------------------------------------------------------------
+
+void putLE32(std::vector<uint8_t>& b, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        b.push_back((v >> (8 * i)) & 0xff);
+    }
+}
+
+void putLE64(std::vector<uint8_t>& b, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        b.push_back((v >> (8 * i)) & 0xff);
+    }
+}
+
+void putF32(std::vector<uint8_t>& b, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    putLE32(b, v);
+}
+
+uint32_t getLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t getLE64(const uint8_t* p) {
+    return getLE32(p) | (static_cast<uint64_t>(getLE32(p + 4)) << 32);
+}
+
+float getF32(const uint8_t* p) {
+    uint32_t v = getLE32(p);
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+//-----------------------------------------------------------------------------
+// Chunk encoding
+//-----------------------------------------------------------------------------
+
+struct Column {
+    uint32_t id;
+    uint32_t valuesPerPattern;
+    std::vector<uint8_t> data;
+};
+
+void putFeatures(std::vector<uint8_t>& b, const PatternFeatures& f) {
+    const uint8_t fields[FEATURE_BYTES] = {
+        f.length, f.noteCount, f.accentCount, f.slideCount, f.accentsOnBeat, f.slidesOnBeat,
+        f.downbeats, f.downbeatRoots, f.syncopation, f.octaveJumps,
+        f.intervals[0], f.intervals[1], f.intervals[2], f.intervals[3], f.intervals[4], f.intervals[5],
+        f.repeatsBeat, f.repeatsHalf,
+    };
+    b.insert(b.end(), fields, fields + FEATURE_BYTES);
+}
+
+// Generates seeds [firstSeed, firstSeed + count) into one encoded chunk
+std::vector<uint8_t> encodeChunk(const Options& opt, uint32_t firstSeed, uint32_t count) {
+    const int gridPoints = static_cast<int>(opt.densities.size() * opt.spreads.size());
+    std::vector<Column> cols = {
+        {COL_BAR_ORDER, BAR_LEN, {}},
+        {COL_SCALE_ORDER, SCALE_SIZE, {}},
+        {COL_POOL_INDEX, MAX_STEPS, {}},
+        {COL_OCTAVE, MAX_STEPS, {}},
+        {COL_ACCENT_PROB, MAX_STEPS, {}},
+        {COL_SLIDE_PROB, MAX_STEPS, {}},
+    };
+    if (gridPoints > 0) {
+        cols.push_back({COL_RESOLVED_DEGREE, static_cast<uint32_t>(gridPoints * MAX_STEPS), {}});
+        cols.push_back({COL_RESOLVED_FLAGS, static_cast<uint32_t>(gridPoints * MAX_STEPS), {}});
+    }
+    if (gridPoints > 0 && opt.features) {
+        cols.push_back({COL_FEATURES, static_cast<uint32_t>(gridPoints * FEATURE_BYTES), {}});
+    }
+    const size_t floatBytes = sizeof(float);
+    for (Column& c : cols) {
+        bool isFloat = c.id == COL_ACCENT_PROB || c.id == COL_SLIDE_PROB;
+        c.data.reserve(static_cast<size_t>(count) * c.valuesPerPattern * (isFloat ? floatBytes : 1));
+    }
+
+    MasterPattern pattern;
+    for (uint32_t i = 0; i < count; i++) {
+        generateMaster(firstSeed + i, pattern);
+
+        for (int b = 0; b < BAR_LEN; b++) {
+            cols[0].data.push_back(static_cast<uint8_t>(pattern.barActivationOrder[b]));
+        }
+        for (int s = 0; s < SCALE_SIZE; s++) {
+            cols[1].data.push_back(static_cast<uint8_t>(pattern.scalePriorityOrder[s]));
+        }
+        for (int s = 0; s < MAX_STEPS; s++) {
+            const MasterStep& ms = pattern.steps[s];
+            cols[2].data.push_back(static_cast<uint8_t>(ms.notePoolIndex));
+            cols[3].data.push_back(static_cast<uint8_t>(static_cast<int8_t>(ms.octave)));
+            putF32(cols[4].data, ms.accentProb);
+            putF32(cols[5].data, ms.slideProb);
+        }
+
+        for (float density : opt.densities) {
+            for (float spread : opt.spreads) {
+                for (int s = 0; s < MAX_STEPS; s++) {
+                    SequenceStep step = pattern.getStep(s, density, spread, opt.accentDensity, opt.slideDensity);
+                    cols[6].data.push_back(static_cast<uint8_t>(static_cast<int8_t>(step.isRest() ? -1 : step.note)));
+                    cols[7].data.push_back(static_cast<uint8_t>((step.accent ? 1 : 0) | (step.slide ? 2 : 0)));
+                }
+                if (opt.features) {
+                    putFeatures(cols[8].data, computeFeatures(resolveBits(pattern, FEATURE_LENGTH, density, spread,
+                                                                          opt.accentDensity, opt.slideDensity)));
+                }
+            }
+        }
+    }
+
+    size_t total = 16 + cols.size() * 16;
+    for (const Column& c : cols) {
+        total += c.data.size();
+    }
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    out.insert(out.end(), CHUNK_MAGIC, CHUNK_MAGIC + 4);
+    putLE32(out, firstSeed);
+    putLE32(out, count);
+    putLE32(out, static_cast<uint32_t>(cols.size()));
+    for (const Column& c : cols) {
+        putLE32(out, c.id);
+        putLE32(out, c.valuesPerPattern);
+        putLE64(out, c.data.size());
+    }
+    for (const Column& c : cols) {
+        out.insert(out.end(), c.data.begin(), c.data.end());
+    }
+    return out;
+}
+
+std::vector<uint8_t> encodeHeader(const Options& opt, uint32_t firstSeed, uint64_t count) {
+    std::vector<uint8_t> h(FILE_MAGIC, FILE_MAGIC + 8);
+    putLE32(h, VERSION);
+    putLE32(h, firstSeed);
+    putLE64(h, count);
+    putLE32(h, opt.chunkPatterns);
+    putLE32(h, static_cast<uint32_t>(opt.densities.size()));
+    putLE32(h, static_cast<uint32_t>(opt.spreads.size()));
+    putF32(h, opt.accentDensity);
+    putF32(h, opt.slideDensity);
+    for (float d : opt.densities) putF32(h, d);
+    for (float s : opt.spreads) putF32(h, s);
+    return h;
+}
+
+//-----------------------------------------------------------------------------
+// Generation: workers encode chunks, the main thread writes them in order
+//-----------------------------------------------------------------------------
+
+int generateCorpus(const Options& opt) {
+    // Shard K of N covers an equal slice of the requested seed range
+    uint64_t shardBegin = opt.count * opt.shardIndex / opt.shardCount;
+    uint64_t shardEnd = opt.count * (opt.shardIndex + 1) / opt.shardCount;
+    uint32_t firstSeed = static_cast<uint32_t>(opt.firstSeed + shardBegin);
+    uint64_t count = shardEnd - shardBegin;
+    uint64_t numChunks = (count + opt.chunkPatterns - 1) / opt.chunkPatterns;
+
+    FILE* out = std::fopen(opt.outPath.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "acidseq-corpus: cannot open %s\n", opt.outPath.c_str());
+        return 1;
+    }
+    std::vector<uint8_t> header = encodeHeader(opt, firstSeed, count);
+    bool ok = std::fwrite(header.data(), 1, header.size(), out) == header.size();
+
+    unsigned numThreads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned>(std::min<uint64_t>(numThreads, std::max<uint64_t>(1, numChunks)));
+    // Bounded reorder window so a slow writer can't let memory grow unchecked
+    const uint64_t maxInFlight = 2 * numThreads;
+
+    std::mutex mutex;
+    std::condition_variable chunkReady;   // Worker -> writer
+    std::condition_variable windowOpen;   // Writer -> workers
+    std::map<uint64_t, std::vector<uint8_t>> done;
+    uint64_t nextToWrite = 0;
+    std::atomic<uint64_t> nextChunk{0};
+    std::atomic<bool> abort{false};
+
+    auto worker = [&]() {
+        for (;;) {
+            uint64_t index = nextChunk.fetch_add(1);
+            if (index >= numChunks) {
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                windowOpen.wait(lock, [&] { return abort || index < nextToWrite + maxInFlight; });
+                if (abort) {
+                    return;
+                }
+            }
+            uint64_t begin = index * opt.chunkPatterns;
+            uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(opt.chunkPatterns, count - begin));
+            std::vector<uint8_t> chunk = encodeChunk(opt, static_cast<uint32_t>(firstSeed + begin), n);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.emplace(index, std::move(chunk));
+            }
+            chunkReady.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t bytes = header.size();
+    for (uint64_t index = 0; index < numChunks && ok; index++) {
+        std::vector<uint8_t> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkReady.wait(lock, [&] { return done.count(index) != 0; });
+            chunk = std::move(done[index]);
+            done.erase(index);
+            nextToWrite = index + 1;
+        }
+        windowOpen.notify_all();
+
+        ok = std::fwrite(chunk.data(), 1, chunk.size(), out) == chunk.size();
+        bytes += chunk.size();
+        if (!opt.quiet) {
+            std::fprintf(stderr, "\r%llu / %llu chunks", static_cast<unsigned long long>(index + 1),
+                         static_cast<unsigned long long>(numChunks));
+        }
+    }
+
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(mutex);
+        abort = true;
+    }
+    windowOpen.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    if (std::fclose(out) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        std::fprintf(stderr, "\nacidseq-corpus: write failed\n");
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!opt.quiet) {
+        std::fprintf(stderr, "\nseeds %u-%llu: %llu patterns, %.1f MB, %u threads, %.2f s, %.0f patterns/s\n",
+                     firstSeed, static_cast<unsigned long long>(firstSeed + count - 1),
+                     static_cast<unsigned long long>(count), bytes / 1e6, numThreads, elapsed,
+                     elapsed > 0.0 ? count / elapsed : 0.0);
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// --info: validate the structure and spot-check each chunk against the generator
+//-----------------------------------------------------------------------------
+
+bool readExact(FILE* f, std::vector<uint8_t>& buf, size_t n) {
+    buf.resize(n);
+    return std::fread(buf.data(), 1, n, f) == n;
+}
+
+int infoCorpus(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::fprintf(stderr, "acidseq-corpus: cannot open %s\n", path.c_str());
+        return 1;
+    }
+    auto fail = [&](const char* why) {
+        std::fprintf(stderr, "acidseq-corpus: %s: %s\n", path.c_str(), why);
+        std::fclose(f);
+        return 1;
+    };
+
+    std::vector<uint8_t> buf;
+    if (!readExact(f, buf, 44) || std::memcmp(buf.data(), FILE_MAGIC, 8) != 0) {
+        return fail("not a corpus file");
+    }
+    if (getLE32(&buf[8]) != VERSION) {
+        return fail("unsupported version");
+    }
+    uint32_t firstSeed = getLE32(&buf[12]);
+    uint64_t count = getLE64(&buf[16]);
+    uint32_t chunkPatterns = getLE32(&buf[24]);
+    uint32_t densityCount = getLE32(&buf[28]);
+    uint32_t spreadCount = getLE32(&buf[32]);
+    Options grid;
+    grid.accentDensity = getF32(&buf[36]);
+    grid.slideDensity = getF32(&buf[40]);
+    if (densityCount > 1024 || spreadCount > 1024 || !readExact(f, buf, 4 * (densityCount + spreadCount))) {
+        return fail("truncated header");
+    }
+    for (uint32_t i = 0; i < densityCount; i++) grid.densities.push_back(getF32(&buf[4 * i]));
+    for (uint32_t i = 0; i < spreadCount; i++) grid.spreads.push_back(getF32(&buf[4 * (densityCount + i)]));
+
+    std::printf("%s: seeds %u-%llu (%llu patterns), %u per chunk\n", path.c_str(), firstSeed,
+                static_cast<unsigned long long>(firstSeed + count - 1), static_cast<unsigned long long>(count),
+                chunkPatterns);
+    if (densityCount) {
+        std::printf("resolved grid: %u DENSITY x %u SPREAD, ACCENT %g, SLIDE %g\n", densityCount, spreadCount,
+                    grid.accentDensity, grid.slideDensity);
+    }
+
+    uint64_t seen = 0;
+    uint64_t chunks = 0;
+    uint64_t featureSums[FEATURE_BYTES] = {};
+    uint64_t featureRecords = 0;
+    while (seen < count) {
+        if (!readExact(f, buf, 16) || std::memcmp(buf.data(), CHUNK_MAGIC, 4) != 0) {
+            return fail("bad or missing chunk");
+        }
+        uint32_t chunkSeed = getLE32(&buf[4]);
+        uint32_t n = getLE32(&buf[8]);
+        uint32_t columnCount = getLE32(&buf[12]);
+        if (chunkSeed != firstSeed + seen || n == 0 || n > count - seen || columnCount > 64) {
+            return fail("chunk seeds out of sequence");
+        }
+        std::vector<uint8_t> dir;
+        if (!readExact(f, dir, 16 * columnCount)) {
+            return fail("truncated chunk directory");
+        }
+
+        // Re-encode the chunk's first pattern and compare column prefixes
+        grid.features = false;
+        for (uint32_t c = 0; c < columnCount; c++) {
+            grid.features |= getLE32(&dir[16 * c]) == COL_FEATURES;
+        }
+        std::vector<uint8_t> expect = encodeChunk(grid, chunkSeed, 1);
+        const uint8_t* expectDir = &expect[16];
+        size_t expectOffset = 16 + 16 * getLE32(&expect[12]);
+        if (getLE32(&expect[12]) != columnCount) {
+            return fail("unexpected column set");
+        }
+        for (uint32_t c = 0; c < columnCount; c++) {
+            uint32_t id = getLE32(&dir[16 * c]);
+            uint64_t bytes = getLE64(&dir[16 * c + 8]);
+            uint64_t expectBytes = getLE64(expectDir + 16 * c + 8);
+            if (id != getLE32(expectDir + 16 * c) || bytes != expectBytes * n) {
+                return fail("column size mismatch");
+            }
+            if (!readExact(f, buf, bytes)) {
+                return fail("truncated column");
+            }
+            if (std::memcmp(buf.data(), &expect[expectOffset], expectBytes) != 0) {
+                return fail("column data does not match the generator");
+            }
+            if (id == COL_FEATURES) {
+                for (uint64_t r = 0; r + FEATURE_BYTES <= bytes; r += FEATURE_BYTES) {
+                    for (int k = 0; k < FEATURE_BYTES; k++) {
+                        featureSums[k] += buf[r + k];
+                    }
+                }
+                featureRecords += bytes / FEATURE_BYTES;
+            }
+            expectOffset += expectBytes;
+        }
+        seen += n;
+        chunks++;
+    }
+    if (std::fgetc(f) != EOF) {
+        return fail("trailing data");
+    }
+    std::fclose(f);
+    std::printf("ok: %llu chunks\n", static_cast<unsigned long long>(chunks));
+    if (featureRecords) {
+        // Means over every pattern and grid point (field order as in putFeatures)
+        auto mean = [&](int k) { return static_cast<double>(featureSums[k]) / featureRecords; };
+        std::printf("features, mean per 16-step loop: notes %.2f, accents %.2f, slides %.2f, syncopation %.2f, "
+                    "downbeat roots %.2f/%.2f, octave jumps %.2f, half-loop repeats %.2f\n",
+                    mean(1), mean(2), mean(3), mean(8), mean(7), mean(6), mean(9), mean(17));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (argc < 2 || !parseArgs(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+    if (!opt.infoPath.empty()) {
+        return infoCorpus(opt.infoPath);
+    }
+    return generateCorpus(opt);
+}
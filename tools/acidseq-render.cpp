@@ -0,0 +1,283 @@
+//-----------------------------------------------------------------------------
+// acidseq-render - Offline renderer for the Acid Generator Mini step engine
+//-----------------------------------------------------------------------------
+// Runs the same Sequencer the module runs per sample, driven by a synthetic
+// 16th-note clock, and writes V/OCT, GATE, ACC and SLIDE as fast as the CPU
+// allows. No Rack runtime is involved.
+//
+//   acidseq-render -o out.wav --seed 42 --bpm 130 --seconds 3600
+//   acidseq-render -o out.csv --density 80 --slide 40
+//   acidseq-render -o out.wav --seed 42 --chance 100  (seed's chance lane)
+//   acidseq-render --format null --seconds 36000     (throughput only)
+
+#include "../src/Sequencer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace AcidGenerator;
+
+namespace {
+
+enum class Format { WAV, CSV, NONE };
+
+struct Options {
+    std::string outPath;
+    Format format = Format::WAV;
+    bool formatGiven = false;
+    float sampleRate = 48000.f;
+    double seconds = 10.0;
+    double bpm = 120.0;
+    uint32_t seed = 1;
+    SequencerParams params;
+    bool quiet = false;
+};
+
+constexpr int CHANNELS = 4;   // V/OCT, GATE, ACC, SLIDE
+constexpr int BLOCK = 4096;   // Frames per write
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: acidseq-render -o FILE [options]\n"
+        "  -o FILE              output path (.wav or .csv)\n"
+        "  --format wav|csv|null  output format (default: from extension)\n"
+        "  --sample-rate HZ     engine sample rate (default 48000)\n"
+        "  --seconds S          duration (default 10)\n"
+        "  --bpm BPM            clock tempo, one step per 16th note (default 120)\n"
+        "  --seed N             master pattern seed (default 1)\n"
+        "  --length N           pattern length 1-64 (default 16)\n"
+        "  --density P          DENSITY 0-100 (default 50)\n"
+        "  --spread P           SPREAD 0-100 (default 50)\n"
+        "  --accent P           ACCENT 0-100 (default 25)\n"
+        "  --slide P            SLIDE 0-100 (default 15)\n"
+        "  --chance P           CHANCE lane amount 0-100 (default 0)\n"
+        "  --scale N            scale index 0-%d (default 0, Major)\n"
+        "  --root N             root note 0-11 (default 0, C)\n"
+        "  --octave N           octave offset -2..2 (default 0)\n"
+        "  -q                   no summary on stderr\n",
+        NUM_SCALES - 1);
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-q") {
+            opt.quiet = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "acidseq-render: missing value for %s\n", arg.c_str());
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "-o") {
+            opt.outPath = value;
+        } else if (arg == "--format") {
+            opt.formatGiven = true;
+            if (!std::strcmp(value, "wav")) opt.format = Format::WAV;
+            else if (!std::strcmp(value, "csv")) opt.format = Format::CSV;
+            else if (!std::strcmp(value, "null")) opt.format = Format::NONE;
+            else {
+                std::fprintf(stderr, "acidseq-render: unknown format %s\n", value);
+                return false;
+            }
+        } else if (arg == "--sample-rate") {
+            opt.sampleRate = std::strtof(value, nullptr);
+        } else if (arg == "--seconds") {
+            opt.seconds = std::strtod(value, nullptr);
+        } else if (arg == "--bpm") {
+            opt.bpm = std::strtod(value, nullptr);
+        } else if (arg == "--seed") {
+            opt.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        } else if (arg == "--length") {
+            opt.params.patternLength = std::atoi(value);
+        } else if (arg == "--density") {
+            opt.params.density = std::strtof(value, nullptr);
+        } else if (arg == "--spread") {
+            opt.params.spread = std::strtof(value, nullptr);
+        } else if (arg == "--accent") {
+            opt.params.accentDensity = std::strtof(value, nullptr);
+        } else if (arg == "--slide") {
+            opt.params.slideDensity = std::strtof(value, nullptr);
+        } else if (arg == "--chance") {
+            opt.params.chanceAmount = std::strtof(value, nullptr);
+        } else if (arg == "--scale") {
+            opt.params.scale = static_cast<Scale>(std::atoi(value));
+        } else if (arg == "--root") {
+            opt.params.rootNote = std::atoi(value);
+        } else if (arg == "--octave") {
+            opt.params.octaveOffset = std::atoi(value);
+        } else {
+            std::fprintf(stderr, "acidseq-render: unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    if (!opt.formatGiven) {
+        opt.format = endsWith(opt.outPath, ".csv") ? Format::CSV : Format::WAV;
+    }
+    if (opt.format != Format::NONE && opt.outPath.empty()) {
+        std::fprintf(stderr, "acidseq-render: no output file (-o)\n");
+        return false;
+    }
+
+    // Same ranges as the module's knobs
+    SequencerParams& p = opt.params;
+    if (opt.sampleRate < 1000.f || opt.seconds <= 0.0 || opt.bpm <= 0.0 ||
+        p.patternLength < 1 || p.patternLength > MAX_STEPS ||
+        static_cast<int>(p.scale) < 0 || static_cast<int>(p.scale) >= NUM_SCALES ||
+        p.rootNote < 0 || p.rootNote > 11 || p.octaveOffset < -2 || p.octaveOffset > 2) {
+        std::fprintf(stderr, "acidseq-render: option out of range\n");
+        return false;
+    }
+    return true;
+}
+
+void putLE16(std::vector<uint8_t>& b, uint16_t v) {
+    b.push_back(v & 0xff);
+    b.push_back(v >> 8);
+}
+
+void putLE32(std::vector<uint8_t>& b, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        b.push_back((v >> (8 * i)) & 0xff);
+    }
+}
+
+// 32-bit float WAV header, one channel per output, samples in volts
+bool writeWavHeader(FILE* f, uint32_t sampleRate, uint64_t frames) {
+    uint64_t dataBytes = frames * CHANNELS * sizeof(float);
+    if (dataBytes > 0xffffffffull - 36) {
+        std::fprintf(stderr, "acidseq-render: output exceeds the 4 GB WAV limit, use --format csv or fewer --seconds\n");
+        return false;
+    }
+    std::vector<uint8_t> h;
+    h.insert(h.end(), {'R', 'I', 'F', 'F'});
+    putLE32(h, static_cast<uint32_t>(36 + dataBytes));
+    h.insert(h.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    putLE32(h, 16);
+    putLE16(h, 3);  // WAVE_FORMAT_IEEE_FLOAT
+    putLE16(h, CHANNELS);
+    putLE32(h, sampleRate);
+    putLE32(h, sampleRate * CHANNELS * sizeof(float));
+    putLE16(h, CHANNELS * sizeof(float));
+    putLE16(h, 32);
+    h.insert(h.end(), {'d', 'a', 't', 'a'});
+    putLE32(h, static_cast<uint32_t>(dataBytes));
+    return std::fwrite(h.data(), 1, h.size(), f) == h.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (argc < 2 || !parseArgs(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    MasterPattern pattern;
+    generateMaster(opt.seed, pattern);
+    ChanceLane chance;
+    generateChance(opt.seed, chance);
+
+    Sequencer seq;
+    seq.setSampleRate(opt.sampleRate);
+
+    uint64_t frames = static_cast<uint64_t>(opt.seconds * opt.sampleRate);
+    // One clock edge per 16th note, the first on frame 0
+    double clockIncrement = opt.bpm * 4.0 / (60.0 * opt.sampleRate);
+    double clockPhase = 1.0;
+    float sampleTime = 1.f / opt.sampleRate;
+
+    FILE* out = nullptr;
+    if (opt.format != Format::NONE) {
+        out = std::fopen(opt.outPath.c_str(), opt.format == Format::WAV ? "wb" : "w");
+        if (!out) {
+            std::fprintf(stderr, "acidseq-render: cannot open %s\n", opt.outPath.c_str());
+            return 1;
+        }
+        if (opt.format == Format::WAV) {
+            if (!writeWavHeader(out, static_cast<uint32_t>(opt.sampleRate), frames)) {
+                std::fclose(out);
+                return 1;
+            }
+        } else {
+            std::fputs("frame,voct,gate,acc,slide\n", out);
+        }
+    }
+
+    std::vector<float> block(BLOCK * CHANNELS);
+    uint64_t checksum = 0;  // Keeps the null format from optimizing the engine away
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t base = 0; base < frames; base += BLOCK) {
+        int n = static_cast<int>(std::min<uint64_t>(BLOCK, frames - base));
+
+        for (int i = 0; i < n; i++) {
+            if (clockPhase >= 1.0) {
+                clockPhase -= 1.0;
+                seq.advance(opt.params.patternLength);
+                seq.playStep(pattern, opt.params, opt.sampleRate, &chance);
+            }
+            clockPhase += clockIncrement;
+
+            SequencerOutputs o = seq.process(sampleTime, pattern, opt.params);
+            float* frame = &block[i * CHANNELS];
+            frame[0] = o.pitch;
+            frame[1] = o.gate ? 10.f : 0.f;
+            frame[2] = o.accent ? 10.f : 0.f;
+            frame[3] = o.slide ? 10.f : 0.f;
+        }
+
+        if (opt.format == Format::WAV) {
+            if (std::fwrite(block.data(), sizeof(float) * CHANNELS, n, out) != static_cast<size_t>(n)) {
+                std::fprintf(stderr, "acidseq-render: write failed\n");
+                std::fclose(out);
+                return 1;
+            }
+        } else if (opt.format == Format::CSV) {
+            for (int i = 0; i < n; i++) {
+                const float* frame = &block[i * CHANNELS];
+                std::fprintf(out, "%llu,%.6f,%g,%g,%g\n", static_cast<unsigned long long>(base + i),
+                             frame[0], frame[1], frame[2], frame[3]);
+            }
+        } else {
+            for (int i = 0; i < n * CHANNELS; i++) {
+                uint32_t bits;
+                std::memcpy(&bits, &block[i], sizeof(bits));
+                checksum = (checksum ^ bits) * 1099511628211ull;
+            }
+        }
+    }
+
+    if (out && std::fclose(out) != 0) {
+        std::fprintf(stderr, "acidseq-render: write failed\n");
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!opt.quiet) {
+        double rendered = frames / static_cast<double>(opt.sampleRate);
+        std::fprintf(stderr, "rendered %.1f s (%llu frames) in %.3f s, %.0fx real time, %.1f ns/frame\n",
+                     rendered, static_cast<unsigned long long>(frames), elapsed,
+                     elapsed > 0.0 ? rendered / elapsed : 0.0,
+                     frames ? elapsed * 1e9 / frames : 0.0);
+        if (opt.format == Format::NONE) {
+            std::fprintf(stderr, "checksum %016llx\n", static_cast<unsigned long long>(checksum));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// acidseq-replay - Replay an input capture through the shipping module
+//-----------------------------------------------------------------------------
+// Feeds a capture made from the context menu ("Input capture") back through
+// src/AcidSeq.cpp, built against tests/shim like acidseq-bench, and checks
+// the outputs against the hashes taken live. A mismatch means this build
+// behaves differently from the one that made the capture.
+//
+//   acidseq-replay take.acidcap                   verify, report the first differing block
+//   acidseq-replay take.acidcap --csv out.csv     also write every frame's outputs
+//   acidseq-replay take.acidcap --repeat 20       time the replay (median ns/frame)
+//
+// Exit status: 0 outputs match, 1 mismatch, 2 unreadable capture.
+
+#include "../src/AcidSeq.cpp"
+#include "../src/CaptureReplay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace AcidGenerator;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: acidseq-replay FILE [options]\n"
+        "  --csv FILE       write frame, pitch, gate, accent, slide, accent CV per frame\n"
+        "  --repeat N       replay N times and report the median time per frame\n");
+}
+
+float captureSampleRate(const CaptureFile& capture) {
+    for (const CaptureRecord& r : capture.records) {
+        if (r.kind == CAPTURE_SAMPLE_RATE) {
+            return bitsFloat(r.value);
+        }
+    }
+    return 44100.f;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+        return 2;
+    }
+    std::string path = argv[1];
+    std::string csvPath;
+    int repeat = 1;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "acidseq-replay: missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (arg == "--csv") csvPath = value;
+        else if (arg == "--repeat") repeat = std::max(1, std::atoi(value));
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    CaptureFile capture;
+    std::string error;
+    if (!capture.load(path, error)) {
+        std::fprintf(stderr, "acidseq-replay: %s\n", error.c_str());
+        return 2;
+    }
+    float sampleRate = captureSampleRate(capture);
+    std::printf("%s: %zu records, %s", path.c_str(), capture.records.size(),
+                capture.complete ? "complete" : "truncated (no END record)");
+    if (capture.dropped) {
+        std::printf(", %u records dropped (ring full)", capture.dropped);
+    }
+    std::printf("\n");
+
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = std::fopen(csvPath.c_str(), "w");
+        if (!csv) {
+            std::fprintf(stderr, "acidseq-replay: cannot write %s\n", csvPath.c_str());
+            return 2;
+        }
+        std::fprintf(csv, "frame,pitch,gate,accent,slide,accent_cv\n");
+    }
+
+    ReplayResult result;
+    std::vector<double> nsPerFrame;
+    for (int run = 0; run < repeat; run++) {
+        // A fresh module each run: the capture carries the starting state
+        std::unique_ptr<AcidSeq> module(new AcidSeq);
+        Clock::time_point start = Clock::now();
+        result = replayCapture(capture, *module, [&](uint32_t frame, const float* out, int count) {
+            if (csv) {
+                std::fprintf(csv, "%u", frame);
+                for (int i = 0; i < count; i++) {
+                    std::fprintf(csv, ",%.6g", out[i]);
+                }
+                std::fprintf(csv, "\n");
+            }
+        });
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (csv) {
+            std::fclose(csv);
+            csv = nullptr;
+        }
+        if (!result.error.empty()) {
+            std::fprintf(stderr, "acidseq-replay: %s\n", result.error.c_str());
+            return 2;
+        }
+        nsPerFrame.push_back(result.frames ? ns / result.frames : 0.0);
+    }
+
+    std::printf("%llu frames (%.2f s at %.0f Hz), %llu blocks checked\n",
+                static_cast<unsigned long long>(result.frames), result.frames / sampleRate, sampleRate,
+                static_cast<unsigned long long>(result.blocksChecked));
+    if (repeat > 1) {
+        std::sort(nsPerFrame.begin(), nsPerFrame.end());
+        std::printf("replay: %.1f ns/frame (median of %d)\n", nsPerFrame[nsPerFrame.size() / 2], repeat);
+    }
+    if (result.firstMismatchFrame >= 0) {
+        std::printf("MISMATCH from block at frame %lld (%.3f s)\n",
+                    static_cast<long long>(result.firstMismatchFrame), result.firstMismatchFrame / sampleRate);
+        return 1;
+    }
+    std::printf("outputs match\n");
+    return 0;
+}
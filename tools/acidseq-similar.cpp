@@ -0,0 +1,194 @@
+//-----------------------------------------------------------------------------
+// acidseq-similar - Build and query a pattern similarity index
+//-----------------------------------------------------------------------------
+// Fingerprints a seed range at fixed knob settings (see Similarity.hpp) and
+// answers "which seeds sound like this one" from a persisted index.
+//
+//   acidseq-similar build -o index.bin --count 1000000 --density 60
+//   acidseq-similar query index.bin --seed 12345 -k 10
+//   acidseq-similar query index.bin --seed 12345 --check    (verify vs linear scan)
+
+#include "../src/Similarity.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace AcidGenerator;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: acidseq-similar build -o FILE [options]\n"
+        "       acidseq-similar query FILE --seed N [-k K] [--check]\n"
+        "build options:\n"
+        "  --first-seed N   first seed (default 0)\n"
+        "  --count N        number of seeds (default 1000000)\n"
+        "  --threads N      worker threads (default: all cores)\n"
+        "  --length N       pattern length the loop is fingerprinted at (default 16)\n"
+        "  --density P      DENSITY (default 50)\n"
+        "  --spread P       SPREAD (default 50)\n"
+        "  --accent P       ACCENT (default 25)\n"
+        "  --slide P        SLIDE (default 15)\n"
+        "query options:\n"
+        "  --seed N         query pattern (any seed, inside the index or not)\n"
+        "  -k K             neighbours to return (default 10)\n"
+        "  --check          compare against a linear scan\n");
+}
+
+// Per-lane distances, for reading why two patterns matched
+std::string laneText(const PatternSignature& a, const PatternSignature& b) {
+    static const char* names[SIGNATURE_WORDS] = {"rhythm", "up", "down", "acc", "slide"};
+    std::string s;
+    for (int w = 0; w < SIGNATURE_WORDS; w++) {
+        s += std::string(w ? " " : "") + names[w] + " " + std::to_string(__builtin_popcountll(a.words[w] ^ b.words[w]));
+    }
+    return s;
+}
+
+int build(int argc, char** argv) {
+    std::string outPath;
+    uint32_t firstSeed = 0;
+    uint64_t count = 1000000;
+    unsigned threads = 0;
+    SimilarityParams params;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "acidseq-similar: missing value for %s\n", arg.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+        if (arg == "-o") outPath = value;
+        else if (arg == "--first-seed") firstSeed = static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        else if (arg == "--count") count = std::strtoull(value, nullptr, 0);
+        else if (arg == "--threads") threads = static_cast<unsigned>(std::strtoul(value, nullptr, 0));
+        else if (arg == "--length") params.patternLength = std::atoi(value);
+        else if (arg == "--density") params.density = std::strtof(value, nullptr);
+        else if (arg == "--spread") params.spread = std::strtof(value, nullptr);
+        else if (arg == "--accent") params.accentDensity = std::strtof(value, nullptr);
+        else if (arg == "--slide") params.slideDensity = std::strtof(value, nullptr);
+        else {
+            std::fprintf(stderr, "acidseq-similar: unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+    }
+    if (outPath.empty() || count == 0 || count > (1ull << 32) - firstSeed ||
+        params.patternLength < 1 || params.patternLength > MAX_STEPS) {
+        usage();
+        return 2;
+    }
+
+    auto start = Clock::now();
+    SimilarityIndex index;
+    index.build(firstSeed, static_cast<uint32_t>(count), params, threads);
+    double buildMs = msSince(start);
+    if (!index.save(outPath.c_str())) {
+        std::fprintf(stderr, "acidseq-similar: cannot write %s\n", outPath.c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "indexed seeds %u-%llu in %.0f ms\n", firstSeed,
+                 static_cast<unsigned long long>(firstSeed + count - 1), buildMs);
+    return 0;
+}
+
+int query(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    const char* indexPath = argv[2];
+    int64_t seed = -1;
+    int k = 10;
+    bool check = false;
+
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--check") {
+            check = true;
+        } else if (i + 1 < argc && arg == "--seed") {
+            seed = static_cast<int64_t>(std::strtoul(argv[++i], nullptr, 0));
+        } else if (i + 1 < argc && arg == "-k") {
+            k = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "acidseq-similar: unknown option %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+    }
+    if (seed < 0 || k < 1) {
+        usage();
+        return 2;
+    }
+
+    auto start = Clock::now();
+    SimilarityIndex index;
+    if (!index.load(indexPath)) {
+        std::fprintf(stderr, "acidseq-similar: cannot load %s\n", indexPath);
+        return 1;
+    }
+    double loadMs = msSince(start);
+
+    MasterPattern pattern;
+    generateMaster(static_cast<uint32_t>(seed), pattern);
+    PatternSignature sig = computeSignature(pattern, index.params);
+
+    // One extra so the query seed itself can be dropped
+    start = Clock::now();
+    std::vector<SimilarNeighbor> found = index.nearest(sig, k + 1);
+    double queryMs = msSince(start);
+
+    const SimilarityParams& p = index.params;
+    std::printf("seed %lld at length %d, DENSITY %g, SPREAD %g, ACCENT %g, SLIDE %g (%zu seeds indexed)\n",
+                static_cast<long long>(seed), p.patternLength, p.density, p.spread, p.accentDensity,
+                p.slideDensity, index.size());
+    int shown = 0;
+    for (const SimilarNeighbor& n : found) {
+        if (n.seed == static_cast<uint32_t>(seed) || shown == k) {
+            continue;
+        }
+        MasterPattern other;
+        generateMaster(n.seed, other);
+        std::printf("%3d  seed %-10u distance %3d  (%s)\n", ++shown, n.seed, n.distance,
+                    laneText(sig, computeSignature(other, p)).c_str());
+    }
+    std::fprintf(stderr, "load %.1f ms, query %.3f ms\n", loadMs, queryMs);
+
+    if (check) {
+        start = Clock::now();
+        std::vector<SimilarNeighbor> expect = index.nearestLinear(sig, k + 1);
+        double scanMs = msSince(start);
+        bool same = expect.size() == found.size();
+        for (size_t i = 0; same && i < expect.size(); i++) {
+            same = expect[i].seed == found[i].seed && expect[i].distance == found[i].distance;
+        }
+        std::fprintf(stderr, "linear scan %.3f ms: %s\n", scanMs, same ? "identical" : "MISMATCH");
+        return same ? 0 : 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !std::strcmp(argv[1], "build")) {
+        return build(argc, argv);
+    }
+    if (argc >= 2 && !std::strcmp(argv[1], "query")) {
+        return query(argc, argv);
+    }
+    usage();
+    return 2;
+}